@@ -3,6 +3,8 @@ C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/triangle.frag -o C
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/gradient.comp -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/gradient-comp.spv
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/sky.comp -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/sky-comp.spv
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/colored_triangle.vert -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/colored_triangle-vert.spv
-C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/colored_triangle_mesh.vert -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/colored_triangle_mesh-vert.spv
 C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/colored_triangle.frag -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/colored_triangle-frag.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/cull.comp -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/cull-comp.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/mesh_indirect.vert -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/mesh_indirect-vert.spv
+C:/VulkanSDK/1.4.309.0/Bin/glslc.exe Engine/Resources/Shaders/mesh_indirect.frag -o C:/Development/QuestEngine/Engine/Resources/ShaderCache/mesh_indirect-frag.spv
 pause
\ No newline at end of file
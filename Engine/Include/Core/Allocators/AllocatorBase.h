@@ -21,16 +21,20 @@ namespace QE
         virtual void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) = 0;
         virtual void Free(void* const ptr) = 0;
 
+        // The stats can be read from any thread, also while a thread safe allocator is in use
         [[nodiscard]] std::size_t GetTotalSize() const noexcept;
         [[nodiscard]] std::size_t GetUsedSize() const noexcept;
         [[nodiscard]] std::size_t GetFreeSize() const noexcept;
         [[nodiscard]] std::size_t GetNumberOfAllocations() const noexcept;
+        // Allocations made over the allocator's lifetime, frees and resets don't lower it
+        [[nodiscard]] std::size_t GetTotalAllocations() const noexcept;
 
         [[nodiscard]] const void* GetStartPtr() const noexcept;
     protected:
         std::size_t m_TotalBytes;
         std::size_t m_UsedBytes;
         std::size_t m_NumAllocations;
+        std::size_t m_TotalAllocations;
         void* m_StartPtr;
     };
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Pointer math shared by the allocators, alignments are expected to be a power of 2
+
+namespace QE
+{
+    inline bool is_power_of_two(const std::size_t value) noexcept
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    inline std::size_t align_forward_adjustment(const void* const ptr, const std::size_t& alignment) noexcept
+    {
+        const auto iptr = reinterpret_cast<std::uintptr_t>(ptr);
+        const auto aligned = (iptr - 1u + alignment) & -alignment;
+        return aligned - iptr;
+    }
+
+    // Adjustment that also leaves at least headerSize bytes in front of the aligned address
+    inline std::size_t align_forward_adjustment_with_header(const void* const ptr, const std::size_t& alignment, const std::size_t& headerSize) noexcept
+    {
+        std::size_t adjustment = align_forward_adjustment(ptr, alignment);
+        if (adjustment < headerSize)
+        {
+            const std::size_t neededSpace = headerSize - adjustment;
+            adjustment += alignment * ((neededSpace + alignment - 1) / alignment);
+        }
+        return adjustment;
+    }
+
+    inline void* align_backward(const void* const ptr, const std::size_t& alignment) noexcept
+    {
+        return reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(ptr) & -alignment);
+    }
+
+    inline void* ptr_add(const void* const p, const std::uintptr_t& amount) noexcept
+    {
+        return reinterpret_cast<void*>
+            (reinterpret_cast<std::uintptr_t>(p) + amount);
+    }
+
+    inline void* ptr_sub(const void* const p, const std::uintptr_t& amount) noexcept
+    {
+        return reinterpret_cast<void*>
+            (reinterpret_cast<std::uintptr_t>(p) - amount);
+    }
+
+    inline std::size_t ptr_diff(const void* const from, const void* const to) noexcept
+    {
+        return reinterpret_cast<std::uintptr_t>(to) - reinterpret_cast<std::uintptr_t>(from);
+    }
+}
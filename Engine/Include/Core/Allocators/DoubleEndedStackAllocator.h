@@ -0,0 +1,49 @@
+#pragma once
+#include "AllocatorBase.h"
+#include "StackAllocator.h"
+
+namespace QE
+{
+    // Two stacks sharing one block, the bottom grows up and the top grows down.
+    // Intended for long lived data on the bottom (level data) and temporary scratch on the top (load staging).
+    class QUEST_API DoubleEndedStackAllocator : public AllocatorBase
+    {
+    public:
+        DoubleEndedStackAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept;
+        DoubleEndedStackAllocator(const DoubleEndedStackAllocator&) = delete;
+        DoubleEndedStackAllocator& operator=(const DoubleEndedStackAllocator&) = delete;
+        DoubleEndedStackAllocator(DoubleEndedStackAllocator&&) noexcept;
+        DoubleEndedStackAllocator& operator=(DoubleEndedStackAllocator&&) noexcept;
+        ~DoubleEndedStackAllocator() noexcept override;
+
+        // Allocate goes to the bottom, Free works out which end the pointer belongs to
+        void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        void Free(void* const ptr) noexcept override;
+
+        void* AllocateBottom(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t));
+        void* AllocateTop(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t));
+        // Same as above without logging when the memory runs out, for callers that have somewhere else to go
+        [[nodiscard]] void* TryAllocateBottom(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) noexcept;
+        [[nodiscard]] void* TryAllocateTop(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) noexcept;
+        void FreeBottom(void* const ptr) noexcept;
+        void FreeTop(void* const ptr) noexcept;
+
+        // Bottom markers are offsets from the start, top markers are offsets from the end
+        [[nodiscard]] StackMarker GetBottomMarker() const noexcept;
+        [[nodiscard]] StackMarker GetTopMarker() const noexcept;
+        void FreeBottomToMarker(const StackMarker marker) noexcept;
+        void FreeTopToMarker(const StackMarker marker) noexcept;
+        void ClearBottom() noexcept;
+        void ClearTop() noexcept;
+    private:
+        void UpdateStats() noexcept;
+        [[nodiscard]] void* GetEndPtr() const noexcept;
+
+        void* m_BottomPtr;
+        void* m_TopPtr;
+        void* m_LastBottomAllocation = nullptr;
+        void* m_LastTopAllocation = nullptr;
+        std::size_t m_BottomAllocations = 0;
+        std::size_t m_TopAllocations = 0;
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "AllocatorBase.h"
+#include "LinearAllocator.h"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace QE
+{
+    // Double buffered linear allocator for transient per-frame memory.
+    // BeginFrame swaps buffers and clears the new one, so anything allocated last frame
+    // stays valid for one more frame. Destructors are never run, only use it for trivially destructible data.
+    class QUEST_API FrameAllocator : public AllocatorBase
+    {
+    public:
+        FrameAllocator(const std::size_t sizeInBytesPerFrame) noexcept;
+        FrameAllocator(const FrameAllocator&) = delete;
+        FrameAllocator& operator=(const FrameAllocator&) = delete;
+        FrameAllocator(FrameAllocator&&) = delete;
+        FrameAllocator& operator=(FrameAllocator&&) = delete;
+        ~FrameAllocator() noexcept override;
+
+        void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        // Individual frees are a no-op, the whole buffer is reset two frames later
+        void Free(void* const ptr) noexcept override;
+
+        void BeginFrame() noexcept;
+
+        template<typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "FrameAllocator never runs destructors");
+            void* memory = Allocate(sizeof(T), alignof(T));
+            return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        template<typename T>
+        T* AllocateArray(const std::size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "FrameAllocator never runs destructors");
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // Use for scoped scratch memory with GetCurrentPointer/Rewind
+        [[nodiscard]] LinearAllocator& GetCurrentFrameAllocator() noexcept;
+        [[nodiscard]] std::uint32_t GetCurrentBufferIndex() const noexcept;
+    private:
+        void UpdateStats() noexcept;
+
+        LinearAllocator m_FrameBuffers[2];
+        std::uint32_t m_CurrentBuffer = 0;
+    };
+}
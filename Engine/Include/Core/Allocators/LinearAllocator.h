@@ -13,11 +13,14 @@ namespace QE
         LinearAllocator& operator=(LinearAllocator&&) noexcept;
         ~LinearAllocator() noexcept override;
 
-        void* Allocate(const size_t sizeInBytes, const std::uintptr_t alignment) override;
+        void* Allocate(const size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        // Individual frees are a no-op, memory is only given back through Rewind or Clear
         void Free(void* const ptr) noexcept override;
 
+        // The current pointer doubles as a marker that can be passed to Rewind later
         [[nodiscard]] void* GetCurrentPointer() const noexcept;
 
+        // Release everything allocated after the mark (from GetCurrentPointer)
         virtual void Rewind(void* const mark) noexcept;
         virtual void Clear() noexcept;
     protected:
@@ -0,0 +1,85 @@
+#pragma once
+#include "AllocatorBase.h"
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace QE
+{
+    // Subsystem an allocator's memory is accounted to
+    enum class MemoryTag : std::uint8_t
+    {
+        Core,
+        Renderer,
+        Assets,
+        Events,
+        Game,
+        Count
+    };
+
+    QUEST_API std::string_view MemoryTagToString(MemoryTag tag) noexcept;
+
+    struct AllocatorStats
+    {
+        std::string Name;
+        MemoryTag Tag;
+        std::size_t UsedBytes = 0;
+        std::size_t TotalBytes = 0;
+        std::size_t PeakBytes = 0;
+        std::size_t LiveAllocations = 0;
+        std::size_t AllocationsPerFrame = 0;
+    };
+
+    struct MemoryTagStats
+    {
+        std::size_t UsedBytes = 0;
+        std::size_t TotalBytes = 0;
+        std::size_t PeakBytes = 0;
+        std::size_t AllocationsPerFrame = 0;
+        std::size_t BudgetBytes = 0; // 0 means no budget
+        bool OverBudget = false;
+    };
+
+    // Keeps track of the engine's named allocators and rolls their stats up per tag.
+    // Allocators are sampled once per frame in Update, so peaks are frame granular.
+    class QUEST_API MemoryRegistry
+    {
+    public:
+        MemoryRegistry() = default;
+        MemoryRegistry(const MemoryRegistry&) = delete;
+        MemoryRegistry& operator=(const MemoryRegistry&) = delete;
+
+        // The allocator has to be unregistered before it is destroyed
+        void RegisterAllocator(const AllocatorBase* allocator, std::string_view name, MemoryTag tag);
+        void UnregisterAllocator(const AllocatorBase* allocator);
+
+        // Warns once every time the tag goes over the budget, 0 removes the budget
+        void SetBudget(MemoryTag tag, std::size_t budgetInBytes);
+
+        // Samples every registered allocator, call once per frame
+        void Update();
+
+        [[nodiscard]] std::vector<AllocatorStats> GetAllocatorStats() const;
+        [[nodiscard]] MemoryTagStats GetTagStats(MemoryTag tag) const;
+
+        // Write the current allocator stats out so memory use can be compared between builds
+        bool DumpToJson(const std::string& path) const;
+        bool DumpToCsv(const std::string& path) const;
+
+        void DrawDebugInfo();
+    private:
+        struct Entry
+        {
+            const AllocatorBase* Allocator;
+            AllocatorStats Stats;
+            std::size_t LastTotalAllocations;
+        };
+
+        mutable std::mutex m_Mutex;
+        std::vector<Entry> m_Entries;
+        std::array<MemoryTagStats, static_cast<std::size_t>(MemoryTag::Count)> m_TagStats{};
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace QE
+{
+    // Hands out ranges of an externally owned resource, typically a GPU buffer, so nothing is stored in
+    // the managed memory itself. Offsets and sizes are in whatever unit the caller picks (bytes, vertices, indices).
+    // Free ranges are indexed by offset and by size: Allocate takes the best fit in O(log n) and Free merges
+    // the range with its free neighbours right away, so the free list never holds two adjacent ranges.
+    // Merging can't help once live allocations sit between the holes, Compact packs the allocations instead
+    // and the caller moves the data to match.
+    class QUEST_API OffsetAllocator
+    {
+    public:
+        static constexpr std::uint32_t INVALID_OFFSET = UINT32_MAX;
+
+        struct Allocation
+        {
+            std::uint32_t Offset = INVALID_OFFSET;
+            std::uint32_t Size = 0;
+
+            [[nodiscard]] bool IsValid() const { return Offset != INVALID_OFFSET; }
+        };
+
+        struct Move
+        {
+            std::uint32_t SourceOffset;
+            std::uint32_t DestinationOffset;
+            std::uint32_t Size;
+        };
+
+        explicit OffsetAllocator(const std::uint32_t size = 0);
+
+        // Returns an invalid allocation when no free range is big enough or size is 0
+        [[nodiscard]] Allocation Allocate(const std::uint32_t size);
+        void Free(const Allocation& allocation);
+        // Adds [GetTotalSize(), newSize) to the free ranges, used after the backing resource was reallocated
+        void Grow(const std::uint32_t newSize);
+        // Frees every allocation at once
+        void Reset();
+        // Packs the given allocations to the start of the range in offset order and updates them in place, leaving
+        // a single free range at the end. Allocations that aren't passed in are dropped as if freed. Returns one move
+        // per allocation in offset order, the ones that keep their offset included
+        std::vector<Move> Compact(std::span<Allocation* const> allocations);
+
+        [[nodiscard]] std::uint32_t GetTotalSize() const noexcept { return m_TotalSize; }
+        [[nodiscard]] std::uint32_t GetUsedSize() const noexcept { return m_UsedSize; }
+        [[nodiscard]] std::uint32_t GetFreeSize() const noexcept { return m_TotalSize - m_UsedSize; }
+        [[nodiscard]] std::uint32_t GetNumberOfAllocations() const noexcept { return m_NumAllocations; }
+        // Largest single allocation that would currently succeed, compare with GetFreeSize to gauge fragmentation
+        [[nodiscard]] std::uint32_t GetLargestFreeRange() const noexcept;
+        [[nodiscard]] std::size_t GetFreeRangeCount() const noexcept { return m_FreeByOffset.size(); }
+    private:
+        void InsertFreeRange(const std::uint32_t offset, const std::uint32_t size);
+        void RemoveFreeRange(std::map<std::uint32_t, std::uint32_t>::iterator range);
+
+        std::map<std::uint32_t, std::uint32_t> m_FreeByOffset; // offset -> size
+        std::multimap<std::uint32_t, std::uint32_t> m_FreeBySize; // size -> offset
+
+        std::uint32_t m_TotalSize = 0;
+        std::uint32_t m_UsedSize = 0;
+        std::uint32_t m_NumAllocations = 0;
+    };
+}
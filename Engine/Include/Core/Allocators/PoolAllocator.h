@@ -0,0 +1,81 @@
+#pragma once
+#include "AllocatorBase.h"
+
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace QE
+{
+    // Fixed-size block allocator, free blocks are kept in an intrusive singly linked list so
+    // Allocate and Free are both O(1). When growth is enabled, extra pages are heap allocated
+    // and chained once the initial memory runs out, they are released in the destructor.
+    class QUEST_API PoolAllocator : public AllocatorBase
+    {
+    public:
+        PoolAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory, const std::size_t blockSize,
+            const std::size_t blockAlignment = sizeof(std::intptr_t), const bool allowGrowth = false) noexcept;
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+        PoolAllocator(PoolAllocator&&) noexcept;
+        PoolAllocator& operator=(PoolAllocator&&) noexcept;
+        ~PoolAllocator() noexcept override;
+
+        // sizeInBytes and alignment only have to fit within the block, every allocation uses a full block
+        void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        void Free(void* const ptr) noexcept override;
+
+        template<typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            void* memory = Allocate(sizeof(T), alignof(T));
+            return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        template<typename T>
+        void Delete(T* object)
+        {
+            if (object)
+            {
+                object->~T();
+                Free(object);
+            }
+        }
+
+        [[nodiscard]] std::size_t GetBlockSize() const noexcept;
+        [[nodiscard]] std::size_t GetBlockAlignment() const noexcept;
+        [[nodiscard]] std::size_t GetPageCount() const noexcept;
+    private:
+        void PushBlocks(void* const firstBlock, const std::size_t blockCount) noexcept;
+        bool AddPage();
+        void ReleaseGrownPages() noexcept;
+
+        std::size_t m_BlockSize;
+        std::size_t m_BlockAlignment;
+        std::size_t m_BlockStride; // block size rounded up to fit the free list pointer and alignment
+        std::size_t m_BlocksPerPage;
+        std::size_t m_PageCount = 1;
+        bool m_AllowGrowth;
+
+        void* m_FreeList = nullptr;
+        void* m_GrownPages = nullptr; // chain of heap allocated pages, the first block of each stores the next page
+    };
+
+    // Lets std::pmr containers sit on top of a pool, requests that don't fit in a block go to the upstream resource
+    class QUEST_API PoolMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        PoolMemoryResource(PoolAllocator& pool, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept;
+
+        [[nodiscard]] PoolAllocator& GetPool() const noexcept { return *m_Pool; }
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    private:
+        bool FitsInPool(std::size_t bytes, std::size_t alignment) const noexcept;
+
+        PoolAllocator* m_Pool;
+        std::pmr::memory_resource* m_Upstream;
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "AllocatorBase.h"
+
+namespace QE
+{
+    // Byte offset from the start of a stack, get one before a batch of allocations and free back to it
+    using StackMarker = std::size_t;
+
+    // Stored right in front of every stack allocation so Free can unwind it
+    struct StackAllocationHeader
+    {
+        void* PreviousTop;
+        void* PreviousAllocation; // used to catch out of order frees
+    };
+
+    // Linear allocator that also supports freeing in LIFO order through per-allocation headers
+    class QUEST_API StackAllocator : public AllocatorBase
+    {
+    public:
+        StackAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept;
+        StackAllocator(const StackAllocator&) = delete;
+        StackAllocator& operator=(const StackAllocator&) = delete;
+        StackAllocator(StackAllocator&&) noexcept;
+        StackAllocator& operator=(StackAllocator&&) noexcept;
+        ~StackAllocator() noexcept override;
+
+        void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        // Only the most recent allocation can be freed
+        void Free(void* const ptr) noexcept override;
+
+        [[nodiscard]] StackMarker GetMarker() const noexcept;
+        void FreeToMarker(const StackMarker marker) noexcept;
+        void Clear() noexcept;
+    private:
+        void* m_CurrentPtr;
+        void* m_LastAllocation = nullptr;
+    };
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "AllocatorBase.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// http://www.gii.upv.es/tlsf/files/papers/ecrts04_tlsf.pdf
+// https://github.com/mattconte/tlsf
+
+namespace QE
+{
+    struct TLSFThreadCache;
+
+    // General purpose Two-Level Segregated Fit allocator over a fixed block of memory.
+    // Free blocks are binned by a first level (power of 2) and second level (linear subdivision) index,
+    // two bitmaps make finding a fitting bin O(1) so Allocate and Free never walk a list.
+    // The core is guarded by a mutex, small blocks are recycled through thread_local caches first,
+    // each thread gets its own for every allocator it uses so the cached path takes no lock at all.
+    // Blocks parked in a thread cache still count as used in the stats until they are flushed,
+    // which happens when the thread exits or calls FlushThreadCaches.
+    class QUEST_API TLSFAllocator : public AllocatorBase
+    {
+    public:
+        TLSFAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept;
+        TLSFAllocator(const TLSFAllocator&) = delete;
+        TLSFAllocator& operator=(const TLSFAllocator&) = delete;
+        TLSFAllocator(TLSFAllocator&&) = delete;
+        TLSFAllocator& operator=(TLSFAllocator&&) = delete;
+        ~TLSFAllocator() noexcept override;
+
+        void* Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t)) override;
+        void Free(void* const ptr) noexcept override;
+        // Grows or shrinks in place when the neighbouring block allows it, otherwise moves the data.
+        // The alignment has to match the one the block was allocated with
+        void* Reallocate(void* const ptr, const std::size_t sizeInBytes, const std::uintptr_t alignment = sizeof(std::intptr_t));
+
+        template<typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            void* memory = Allocate(sizeof(T), alignof(T));
+            return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        template<typename T>
+        void Delete(T* object)
+        {
+            if (object)
+            {
+                object->~T();
+                Free(object);
+            }
+        }
+
+        // Whether ptr points into the memory this allocator manages
+        [[nodiscard]] bool Owns(const void* const ptr) const noexcept;
+        // Usable size of an allocation, can be larger than what was requested
+        [[nodiscard]] std::size_t GetAllocationSize(const void* const ptr) const noexcept;
+        // Largest single allocation that would currently succeed, compare with GetFreeSize to gauge fragmentation
+        [[nodiscard]] std::size_t GetLargestFreeBlock() noexcept;
+        // Hands the blocks parked in the calling thread's cache back to the core, other threads flush theirs on exit
+        void FlushThreadCaches() noexcept;
+
+        static constexpr std::size_t ALIGNMENT = 16;
+    private:
+        friend struct TLSFThreadCache;
+
+        struct BlockHeader
+        {
+            BlockHeader* PreviousPhysical;
+            std::size_t Size; // payload size, the lowest bit flags the block as free
+            // Only valid while the block is free, they overlap the payload
+            BlockHeader* NextFree;
+            BlockHeader* PreviousFree;
+        };
+
+        static constexpr std::size_t BLOCK_HEADER_SIZE = offsetof(BlockHeader, NextFree);
+        static constexpr std::size_t MIN_BLOCK_SIZE = sizeof(BlockHeader) - BLOCK_HEADER_SIZE;
+
+        static constexpr std::uint32_t SL_INDEX_COUNT_LOG2 = 5;
+        static constexpr std::uint32_t SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+        static constexpr std::uint32_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + 4; // log2(ALIGNMENT)
+        static constexpr std::uint32_t FL_INDEX_MAX = 38;
+        static constexpr std::uint32_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+        static constexpr std::size_t SMALL_BLOCK_SIZE = std::size_t(1) << FL_INDEX_SHIFT;
+        static constexpr std::size_t MAX_BLOCK_SIZE = std::size_t(1) << FL_INDEX_MAX;
+
+        static constexpr std::size_t THREAD_CACHE_BIN_COUNT = 16; // exact size bins of ALIGNMENT up to 256 bytes
+        static constexpr std::size_t THREAD_CACHE_BIN_CAPACITY = 32;
+        static constexpr std::size_t THREAD_CACHE_MAX_SIZE = THREAD_CACHE_BIN_COUNT * ALIGNMENT;
+
+        // The calling thread's cache for this allocator, created on first use. Null when the thread already
+        // caches for too many allocators, it then goes straight to the core
+        TLSFThreadCache* GetThreadCache();
+        TLSFThreadCache* CreateThreadCache();
+        // Empties the bins into the core, only ever called by the thread that owns the cache
+        void FlushThreadCache(TLSFThreadCache& cache) noexcept;
+
+        static void MapSize(const std::size_t size, std::uint32_t& firstLevel, std::uint32_t& secondLevel) noexcept;
+
+        void* AllocateFromCore(const std::size_t size, const std::size_t alignment);
+        void FreeToCore(BlockHeader* block) noexcept;
+
+        void InsertFreeBlock(BlockHeader* block) noexcept;
+        void RemoveFreeBlock(BlockHeader* block) noexcept;
+        BlockHeader* FindFreeBlock(std::size_t size) noexcept;
+        // Splits off everything past size as a new free block when it is big enough to stand on its own
+        void TrimUsedBlock(BlockHeader* block, const std::size_t size) noexcept;
+        BlockHeader* MergeWithNeighbours(BlockHeader* block) noexcept;
+
+        void* m_EndPtr;
+        std::mutex m_Mutex;
+        std::uint32_t m_FLBitmap = 0;
+        std::array<std::uint32_t, FL_INDEX_COUNT> m_SLBitmaps{};
+        std::array<std::array<BlockHeader*, SL_INDEX_COUNT>, FL_INDEX_COUNT> m_FreeBlocks{};
+
+        // Every live thread cache of this allocator, guarded by m_Mutex. Threads remove theirs when they exit
+        std::vector<std::shared_ptr<TLSFThreadCache>> m_ThreadCaches;
+    };
+
+    // Lets std::pmr containers allocate from a TLSFAllocator, allocations it can't fit go to the upstream resource
+    class QUEST_API TLSFMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        TLSFMemoryResource(TLSFAllocator& allocator, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept;
+
+        [[nodiscard]] TLSFAllocator& GetAllocator() const noexcept { return *m_Allocator; }
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    private:
+        TLSFAllocator* m_Allocator;
+        std::pmr::memory_resource* m_Upstream;
+    };
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "Core/Core.h"
+#include "Core/Allocators/AllocatorBase.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace QE
+{
+    // Non-owning view over a block of bytes, the memory has to outlive the view
+    class QUEST_API ByteView
+    {
+    public:
+        constexpr ByteView() noexcept = default;
+        constexpr ByteView(const void* data, std::size_t size) noexcept
+            : m_Data(static_cast<const std::uint8_t*>(data)), m_Size(size)
+        {
+        }
+
+        template<typename T, std::size_t Extent>
+        ByteView(std::span<T, Extent> elements) noexcept
+            : m_Data(reinterpret_cast<const std::uint8_t*>(elements.data())), m_Size(elements.size_bytes())
+        {
+        }
+
+        [[nodiscard]] constexpr const std::uint8_t* Data() const noexcept { return m_Data; }
+        [[nodiscard]] constexpr std::size_t Size() const noexcept { return m_Size; }
+        [[nodiscard]] constexpr bool Empty() const noexcept { return m_Size == 0; }
+
+        [[nodiscard]] constexpr ByteView Subview(std::size_t offset, std::size_t size) const noexcept
+        {
+            return { m_Data + offset, size };
+        }
+
+        template<typename T>
+        [[nodiscard]] const T* As() const noexcept
+        {
+            return reinterpret_cast<const T*>(m_Data);
+        }
+    private:
+        const std::uint8_t* m_Data = nullptr;
+        std::size_t m_Size = 0;
+    };
+
+    // Owning, move-only block of bytes. Memory comes from an AllocatorBase or a pmr resource when one is
+    // given and from the heap otherwise, it is handed back to the same place when the buffer is released.
+    class QUEST_API ByteBuffer
+    {
+    public:
+        static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+        ByteBuffer() noexcept = default;
+
+        explicit ByteBuffer(std::size_t size, AllocatorBase* allocator = nullptr)
+            : m_Allocator(allocator)
+        {
+            Allocate(size);
+        }
+
+        ByteBuffer(std::size_t size, std::pmr::memory_resource* resource)
+            : m_Resource(resource)
+        {
+            Allocate(size);
+        }
+
+        ~ByteBuffer()
+        {
+            Release();
+        }
+
+        ByteBuffer(const ByteBuffer&) = delete;
+        ByteBuffer& operator=(const ByteBuffer&) = delete;
+
+        ByteBuffer(ByteBuffer&& other) noexcept
+            : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)),
+            m_Allocator(other.m_Allocator), m_Resource(other.m_Resource)
+        {
+        }
+
+        ByteBuffer& operator=(ByteBuffer&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                Release();
+                m_Data = std::exchange(rhs.m_Data, nullptr);
+                m_Size = std::exchange(rhs.m_Size, 0);
+                m_Allocator = rhs.m_Allocator;
+                m_Resource = rhs.m_Resource;
+            }
+            return *this;
+        }
+
+        // Copying has to be asked for explicitly
+        static ByteBuffer Copy(ByteView source, AllocatorBase* allocator = nullptr)
+        {
+            ByteBuffer buffer(source.Size(), allocator);
+            if (!source.Empty())
+                std::memcpy(buffer.m_Data, source.Data(), source.Size());
+            return buffer;
+        }
+
+        void Release() noexcept
+        {
+            if (!m_Data)
+                return;
+
+            if (m_Allocator)
+                m_Allocator->Free(m_Data);
+            else if (m_Resource)
+                m_Resource->deallocate(m_Data, m_Size, ALIGNMENT);
+            else
+                std::free(m_Data);
+
+            m_Data = nullptr;
+            m_Size = 0;
+        }
+
+        [[nodiscard]] std::uint8_t* Data() noexcept { return m_Data; }
+        [[nodiscard]] const std::uint8_t* Data() const noexcept { return m_Data; }
+        [[nodiscard]] std::size_t Size() const noexcept { return m_Size; }
+        [[nodiscard]] bool Empty() const noexcept { return m_Size == 0; }
+        [[nodiscard]] ByteView View() const noexcept { return { m_Data, m_Size }; }
+
+        template<typename T>
+        [[nodiscard]] T* As() noexcept
+        {
+            return reinterpret_cast<T*>(m_Data);
+        }
+
+        operator ByteView() const noexcept
+        {
+            return View();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_Data != nullptr;
+        }
+    private:
+        void Allocate(std::size_t size)
+        {
+            if (size == 0)
+                return;
+
+            if (m_Allocator)
+                m_Data = static_cast<std::uint8_t*>(m_Allocator->Allocate(size, ALIGNMENT));
+            else if (m_Resource)
+                m_Data = static_cast<std::uint8_t*>(m_Resource->allocate(size, ALIGNMENT));
+            else
+                m_Data = static_cast<std::uint8_t*>(std::malloc(size));
+
+            if (!m_Data)
+                throw std::bad_alloc();
+            m_Size = size;
+        }
+
+        std::uint8_t* m_Data = nullptr;
+        std::size_t m_Size = 0;
+        AllocatorBase* m_Allocator = nullptr;
+        std::pmr::memory_resource* m_Resource = nullptr;
+    };
+}
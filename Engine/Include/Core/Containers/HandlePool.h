@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace QE
+{
+    // Stores objects addressed by index + generation handles. Objects are kept packed in one array so
+    // lookups are two array reads and iterating the live objects touches no holes. Freed slots go on a
+    // free list and are reused with a bumped generation, so handles to freed objects are detected as stale
+    // instead of silently aliasing whatever took their slot.
+    // THandle has to be an aggregate of { std::uint32_t Index; std::uint32_t Generation; }
+    template<typename T, typename THandle>
+    class HandlePool
+    {
+    public:
+        static constexpr std::uint32_t INVALID_INDEX = UINT32_MAX;
+
+        HandlePool() = default;
+
+        explicit HandlePool(std::size_t initialCapacity)
+        {
+            Reserve(initialCapacity);
+        }
+
+        void Reserve(std::size_t capacity)
+        {
+            m_Slots.reserve(capacity);
+            m_Objects.reserve(capacity);
+            m_ObjectSlots.reserve(capacity);
+        }
+
+        template<typename... Args>
+        THandle Emplace(Args&&... args)
+        {
+            std::uint32_t slotIndex;
+            if (m_FreeHead != INVALID_INDEX)
+            {
+                slotIndex = m_FreeHead;
+                m_FreeHead = m_Slots[slotIndex].ObjectIndex;
+            }
+            else
+            {
+                slotIndex = static_cast<std::uint32_t>(m_Slots.size());
+                m_Slots.push_back({ INVALID_INDEX, 1 });
+            }
+
+            Slot& slot = m_Slots[slotIndex];
+            slot.ObjectIndex = static_cast<std::uint32_t>(m_Objects.size());
+            m_Objects.emplace_back(std::forward<Args>(args)...);
+            m_ObjectSlots.push_back(slotIndex);
+
+            return { slotIndex, slot.Generation };
+        }
+
+        THandle Insert(const T& object)
+        {
+            return Emplace(object);
+        }
+
+        THandle Insert(T&& object)
+        {
+            return Emplace(std::move(object));
+        }
+
+        // Returns false if the handle is stale or was never valid
+        bool Remove(THandle handle)
+        {
+            if (!Contains(handle))
+                return false;
+
+            Slot& slot = m_Slots[handle.Index];
+            const std::uint32_t objectIndex = slot.ObjectIndex;
+            const std::uint32_t lastIndex = static_cast<std::uint32_t>(m_Objects.size() - 1);
+
+            // Keep the objects packed by moving the last one into the hole
+            if (objectIndex != lastIndex)
+            {
+                m_Objects[objectIndex] = std::move(m_Objects[lastIndex]);
+                m_ObjectSlots[objectIndex] = m_ObjectSlots[lastIndex];
+                m_Slots[m_ObjectSlots[objectIndex]].ObjectIndex = objectIndex;
+            }
+            m_Objects.pop_back();
+            m_ObjectSlots.pop_back();
+
+            // Skip generation 0 on wrap around so a zeroed handle never becomes valid
+            slot.Generation = slot.Generation == UINT32_MAX ? 1 : slot.Generation + 1;
+            slot.ObjectIndex = m_FreeHead;
+            m_FreeHead = handle.Index;
+
+            return true;
+        }
+
+        // Returns nullptr if the handle is stale, the pointer is invalidated by the next Insert or Remove
+        [[nodiscard]] T* Get(THandle handle)
+        {
+            return Contains(handle) ? &m_Objects[m_Slots[handle.Index].ObjectIndex] : nullptr;
+        }
+
+        [[nodiscard]] const T* Get(THandle handle) const
+        {
+            return Contains(handle) ? &m_Objects[m_Slots[handle.Index].ObjectIndex] : nullptr;
+        }
+
+        [[nodiscard]] bool Contains(THandle handle) const
+        {
+            return handle.Index < m_Slots.size() && m_Slots[handle.Index].Generation == handle.Generation
+                && m_Slots[handle.Index].ObjectIndex < m_Objects.size()
+                && m_ObjectSlots[m_Slots[handle.Index].ObjectIndex] == handle.Index;
+        }
+
+        void Clear()
+        {
+            for (std::uint32_t objectSlot : m_ObjectSlots)
+            {
+                Slot& slot = m_Slots[objectSlot];
+                slot.Generation = slot.Generation == UINT32_MAX ? 1 : slot.Generation + 1;
+                slot.ObjectIndex = m_FreeHead;
+                m_FreeHead = objectSlot;
+            }
+
+            m_Objects.clear();
+            m_ObjectSlots.clear();
+        }
+
+        // Live objects in no particular order
+        [[nodiscard]] std::span<T> GetObjects() { return m_Objects; }
+        [[nodiscard]] std::span<const T> GetObjects() const { return m_Objects; }
+
+        [[nodiscard]] std::size_t GetSize() const { return m_Objects.size(); }
+        [[nodiscard]] bool IsEmpty() const { return m_Objects.empty(); }
+    private:
+        struct Slot
+        {
+            std::uint32_t ObjectIndex; // index into m_Objects while live, next free slot while free
+            std::uint32_t Generation;
+        };
+
+        std::vector<Slot> m_Slots;
+        std::vector<T> m_Objects;
+        std::vector<std::uint32_t> m_ObjectSlots; // slot that owns each object, used to fix up moves
+        std::uint32_t m_FreeHead = INVALID_INDEX;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Core/Core.h"
 #include "Core/QuestExport.h"
+#include "Core/Allocators/PoolAllocator.h"
 
 #include <functional>
 #include <unordered_map>
@@ -24,16 +25,27 @@ namespace QE
 
         void FireEvent(EventBase& e);
 
+        // Queued events take a block each from the event pool, which grows by another page when a frame queues
+        // more than fit, so an event is never dropped or fired out of order
         template<typename EventType>
         void QueueEvent(EventType e)
         {
-            m_EventQueue.emplace_back(std::make_unique<EventType>(e));
+            static_assert(sizeof(EventType) <= EVENT_BLOCK_SIZE && alignof(EventType) <= EVENT_BLOCK_ALIGNMENT, "Event does not fit in an event pool block");
+            m_EventQueue.push_back(m_EventAllocator.New<EventType>(e));
         }
 
         void Flush();
+
+        [[nodiscard]] const PoolAllocator& GetEventAllocator() const { return m_EventAllocator; }
+
+        static constexpr std::size_t EVENT_QUEUE_SIZE = 64 * 1024;
+        static constexpr std::size_t EVENT_BLOCK_SIZE = 32;
+        static constexpr std::size_t EVENT_BLOCK_ALIGNMENT = 16;
     private:
         std::unordered_map<EventType, std::vector<EventCallbackFn>> m_Subscribers;
-        std::vector<std::unique_ptr<EventBase>> m_EventQueue;
+        std::unique_ptr<std::byte[]> m_EventMemory;
+        PoolAllocator m_EventAllocator;
+        std::vector<EventBase*> m_EventQueue;
     };
 
     QUEST_API EventManager* GetGlobalEventManager();
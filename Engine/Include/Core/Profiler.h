@@ -0,0 +1,133 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace QE
+{
+    using ProfilerClock = std::chrono::steady_clock;
+
+    // Work the GPU did inside a zone
+    struct GpuPipelineStatistics
+    {
+        std::uint64_t InputPrimitives = 0;
+        std::uint64_t VertexInvocations = 0;
+        std::uint64_t ClippingPrimitives = 0; // primitives that came out of clipping
+        std::uint64_t FragmentInvocations = 0;
+        std::uint64_t ComputeInvocations = 0;
+    };
+
+    struct ProfileZone
+    {
+        std::string Name;
+        std::uint32_t Depth = 0; // 0 for zones that are not inside another one
+        double StartMs = 0.0; // from the start of the frame
+        double DurationMs = 0.0;
+        bool HasStatistics = false; // only outermost GPU zones collect pipeline statistics
+        GpuPipelineStatistics Statistics;
+    };
+
+    struct CpuFrameProfile
+    {
+        std::uint32_t Frame = 0; // the graphics device's count, matches GpuFrameProfile::Frame
+        double StartMs = 0.0; // since the profiler was created
+        double DurationMs = 0.0;
+        std::vector<ProfileZone> Zones; // in the order they started
+    };
+
+    // What the GPU spent on one frame, read back a few frames later once it has finished
+    struct GpuFrameProfile
+    {
+        std::uint32_t Frame = UINT32_MAX; // the graphics device's count, UINT32_MAX until a frame has been read back
+        ProfilerClock::time_point SubmitTime; // the GPU did not start before this
+        double StartMs = 0.0; // GPU clock, only comparable with other GPU frames
+        double DurationMs = 0.0;
+        std::vector<ProfileZone> Zones; // in the order they started
+    };
+
+    // Collects the CPU zones of the main thread and the GPU frames the graphics device reads back, keeps the
+    // last HISTORY_FRAMES of each for a rolling timeline and writes them out as a Chrome trace that opens in
+    // chrome://tracing or Perfetto. The GPU clock is not calibrated against the CPU one, GPU frames are placed
+    // on the CPU timeline by the earliest offset at which none of them starts before it was submitted.
+    class QUEST_API Profiler
+    {
+    public:
+        static constexpr std::size_t HISTORY_FRAMES = 300;
+
+        Profiler();
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        // The thread that begins frames is the one whose zones are recorded. frame is the graphics device's frame
+        // number, so CPU and GPU lanes of the same frame carry the same label
+        void BeginFrame(std::uint32_t frame);
+        void EndFrame();
+
+        // Zones nest and end in reverse order. Returns false, and records nothing, outside a frame or on
+        // another thread, the matching EndCpuZone is then skipped
+        bool BeginCpuZone(std::string_view name);
+        void EndCpuZone();
+
+        // The device keeps returning its latest frame, frames that were already added are ignored
+        void AddGpuFrame(const GpuFrameProfile& frame);
+
+        // Paused profilers keep their history so it can be inspected and exported
+        void SetPaused(bool paused) { m_Paused = paused; }
+        [[nodiscard]] bool IsPaused() const { return m_Paused; }
+
+        [[nodiscard]] const std::deque<CpuFrameProfile>& GetCpuFrames() const { return m_CpuFrames; }
+        [[nodiscard]] const std::deque<GpuFrameProfile>& GetGpuFrames() const { return m_GpuFrames; }
+
+        bool ExportChromeTrace(const std::string& path) const;
+
+        void DrawDebugInfo();
+    private:
+        [[nodiscard]] double GetTimeMs() const;
+        // Start of a GPU frame on the CPU timeline
+        [[nodiscard]] double GetGpuFrameStartMs(const GpuFrameProfile& frame) const { return frame.StartMs + m_GpuClockOffsetMs; }
+
+        ProfilerClock::time_point m_Epoch;
+        std::thread::id m_FrameThread;
+        bool m_InFrame = false;
+        bool m_Paused = false;
+
+        CpuFrameProfile m_CurrentFrame;
+        std::vector<std::uint32_t> m_OpenZones; // indices into the current frame's zones
+
+        std::deque<CpuFrameProfile> m_CpuFrames; // oldest first
+        std::deque<GpuFrameProfile> m_GpuFrames;
+        double m_GpuClockOffsetMs = 0.0;
+        bool m_HasGpuClockOffset = false;
+
+        float m_TimelineRangeMs = 50.0f;
+    };
+
+    QUEST_API Profiler* GetGlobalProfiler();
+
+    // Zone on the global profiler for the rest of the scope
+    class ScopedCpuZone
+    {
+    public:
+        explicit ScopedCpuZone(std::string_view name) : m_Active(GetGlobalProfiler()->BeginCpuZone(name)) {}
+        ~ScopedCpuZone()
+        {
+            if (m_Active)
+                GetGlobalProfiler()->EndCpuZone();
+        }
+
+        ScopedCpuZone(const ScopedCpuZone&) = delete;
+        ScopedCpuZone& operator=(const ScopedCpuZone&) = delete;
+    private:
+        bool m_Active;
+    };
+}
+
+#define QE_PROFILE_CONCAT_INNER(a, b) a##b
+#define QE_PROFILE_CONCAT(a, b) QE_PROFILE_CONCAT_INNER(a, b)
+#define QE_PROFILE_SCOPE(name) ::QE::ScopedCpuZone QE_PROFILE_CONCAT(profileZone, __LINE__)(name)
@@ -18,6 +18,8 @@ namespace QE
 		int GetScreenHeight() const { return m_ScreenHeight; }
 		bool GetIsMinimized() const { return m_IsMinimized; }
 		bool GetIsQuit() const { return m_IsQuit; }
+		// No native window, the graphics device renders offscreen
+		bool IsHeadless() const { return m_IsHeadless; }
 
 		virtual void* GetNativeWindow() = 0;
 		virtual void ProcessEvents() = 0;
@@ -39,7 +41,12 @@ namespace QE
 		bool m_IsMinimized = false;
 		bool m_IsQuit = false;
 		bool m_IsProcessingMouseInput = true;
+		bool m_IsHeadless = false;
 	};
 
 	QUEST_API std::unique_ptr<Window> CreateWindowFactory(std::string_view windowName, int width, int height);
+	// Stands in for a window on machines without a display, it never produces input or resize events
+	QUEST_API std::unique_ptr<Window> CreateHeadlessWindowFactory(std::string_view windowName, int width, int height);
+	// Time step of headless runs, fixed so every run simulates and renders the same frames
+	inline constexpr float HEADLESS_DELTA_TIME = 1.0f / 60.0f;
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Core/Core.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace QE
+{
+    // Runs the jobs of one pass on a fixed set of threads. The calling thread is worker 0, the others sleep between
+    // passes, so handing out a pass costs one wake up per worker instead of a thread per job
+    class QUEST_API WorkerThreads
+    {
+    public:
+        static constexpr std::uint32_t MAX_WORKERS = 8;
+
+        using JobFunction = std::function<void(std::uint32_t worker, std::uint32_t job)>;
+
+        WorkerThreads() = default;
+        ~WorkerThreads();
+
+        WorkerThreads(const WorkerThreads&) = delete;
+        WorkerThreads& operator=(const WorkerThreads&) = delete;
+
+        // Creates workerCount - 1 threads, clamped to 1..MAX_WORKERS
+        void Start(std::uint32_t workerCount);
+        void Stop();
+
+        // Job j runs on worker j % worker count of the pass. Blocks until every job is done
+        void Run(std::uint32_t jobCount, const JobFunction& job);
+
+        [[nodiscard]] std::uint32_t GetWorkerCount() const { return m_ActiveWorkers; }
+        // Limits the workers later passes use, clamped to the threads created at Start. The idle threads keep sleeping
+        void SetActiveWorkers(std::uint32_t count);
+        [[nodiscard]] std::uint32_t GetMaxWorkerCount() const { return m_WorkerCount; }
+    private:
+        void WorkerLoop(std::uint32_t worker);
+        void RunJobs(std::uint32_t worker);
+
+        std::uint32_t m_WorkerCount = 1;
+        std::uint32_t m_ActiveWorkers = 1;
+
+        // Current pass, written under the mutex before the generation is bumped
+        std::uint32_t m_JobCount = 0;
+        std::uint32_t m_PassWorkers = 1; // workers taking jobs in the current pass
+        const JobFunction* m_Job = nullptr;
+
+        std::vector<std::thread> m_Threads;
+        std::mutex m_Mutex;
+        std::condition_variable m_StartCondition;
+        std::condition_variable m_DoneCondition;
+        std::uint64_t m_Generation = 0;
+        std::uint32_t m_BusyWorkers = 0;
+        bool m_Stopping = false;
+    };
+}
@@ -3,6 +3,10 @@
 #include "Core/Core.h"
 #include "Core/Log.h"
 #include "Core/Window.h"
+#include "Core/Allocators/FrameAllocator.h"
+#include "Core/Allocators/DoubleEndedStackAllocator.h"
+#include "Core/Allocators/MemoryRegistry.h"
+#include "Core/Allocators/TLSFAllocator.h"
 #include "RHI/GraphicsDevice.h"
 #include "RHI/GraphicsContext.h"
 #include "GameApplication.h"
@@ -10,8 +14,30 @@
 #include "Renderer/TestCamera.h"
 #include "Renderer/VkGuideCamera.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace QE
 {
+	struct QUEST_API EngineConfig
+	{
+		// No window or swapchain, frames are rendered offscreen with a fixed time step so runs are repeatable.
+		// Works on a software Vulkan driver such as lavapipe on machines without a GPU or display
+		bool Headless = false;
+		std::uint32_t Width = 2560;
+		std::uint32_t Height = 1440;
+		std::uint32_t FrameCount = 0; // stop after this many frames, 0 runs until the window is closed
+		// Frames are read back and written here as PPM files, empty captures nothing
+		std::string CaptureFolder;
+		std::uint32_t CaptureInterval = 0; // capture every Nth frame, 0 only captures the last one of FrameCount
+		// Everything after --, left for the game to parse
+		std::vector<std::string> GameArguments;
+
+		// --headless --frames N --width N --height N --capture <folder> --capture-interval N [-- game arguments]
+		static EngineConfig FromCommandLine(int argc, char** argv);
+	};
+
 	class QUEST_API Engine final
 	{
 	public:
@@ -23,7 +49,7 @@ namespace QE
 		//static Engine& Get();
 		//static Engine* GetPtr();
 
-		void Initialize();
+		void Initialize(const EngineConfig& config = {});
 		void Shutdown();
 
 		void Run();
@@ -36,16 +62,46 @@ namespace QE
 		Window* GetWindowPtr();
 		InputManager& GetInput();
 		InputManager* GetInputPtr();
+		FrameAllocator& GetFrameAllocator();
+		FrameAllocator* GetFrameAllocatorPtr();
+		DoubleEndedStackAllocator& GetLevelAllocator();
+		DoubleEndedStackAllocator* GetLevelAllocatorPtr();
+		TLSFAllocator& GetGameAllocator();
+		TLSFAllocator* GetGameAllocatorPtr();
+		// The game allocator for std::pmr containers, it stays valid until the engine is destroyed
+		std::pmr::memory_resource* GetGameMemoryResource();
+		MemoryRegistry& GetMemoryRegistry();
+		MemoryRegistry* GetMemoryRegistryPtr();
 		GraphicsDevice& GetGraphicsDevice();
 		GraphicsDevice* GetGraphicsDevicePtr();
 		GameApplication* GetGameApplication();
 		TestCamera* GetCamera();
+		const EngineConfig& GetConfig() const { return m_Config; }
 	private:
+		// Whether frame is written out, only called in runs with a capture folder
+		bool ShouldCaptureFrame(std::uint32_t frame) const;
+
 		bool m_Running = false;
+		EngineConfig m_Config;
 
 		std::unique_ptr<Window> m_Window;
 		InputManager* m_InputManager = nullptr; // active input manager from the active window, updated here for convenience
 
+		// Stats and budgets for the allocators below and any registered by subsystems
+		std::unique_ptr<MemoryRegistry> m_MemoryRegistry;
+
+		// Transient per-frame memory, reset at the top of every frame
+		std::unique_ptr<FrameAllocator> m_FrameAllocator;
+
+		// Long lived level data on the bottom, asset load scratch on the top
+		void* m_LevelMemory = nullptr;
+		std::unique_ptr<DoubleEndedStackAllocator> m_LevelAllocator;
+
+		// General purpose heap of the game, it outlives Shutdown since the game application is destroyed after it
+		void* m_GameMemory = nullptr;
+		std::unique_ptr<TLSFAllocator> m_GameAllocator;
+		std::unique_ptr<TLSFMemoryResource> m_GameMemoryResource;
+
 		std::unique_ptr<GraphicsDevice> m_GraphicsDevice;
 		std::unique_ptr<GraphicsContext> m_GraphicsContext;
 
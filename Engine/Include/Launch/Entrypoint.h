@@ -6,6 +6,7 @@
 #include "Core/Log.h"
 #include "Engine/Engine.h"
 
-extern "C" QUEST_API void InitializeEngineEntrypoint();
+// The command line is parsed into the EngineConfig
+extern "C" QUEST_API void InitializeEngineEntrypoint(int argc, char** argv);
 extern "C" QUEST_API void RunEngine();
 extern "C" QUEST_API void ShutdownEngineEntrypoint();
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Core/Core.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace QE
+{
+    // Chunks smaller than this cost more to hand out to a worker than they save
+    inline constexpr std::uint32_t MIN_INSTANCES_PER_CHUNK = 2048;
+
+    // Sort key of a submitted draw. The instance count is kept next to the key so the split never reads the records
+    struct DrawKey
+    {
+        std::uint64_t Key;
+        std::uint32_t RecordIndex;
+        std::uint32_t InstanceCount;
+    };
+
+    // Contiguous range of the sorted keys, written and recorded by one worker. Its draws start at FirstKey in the
+    // draw buffers since a range never has more draws than keys, so no worker needs to know the others' counts
+    struct DrawChunk
+    {
+        std::uint32_t FirstKey;
+        std::uint32_t KeyCount;
+        std::uint32_t FirstVisible; // start of the chunk's part of the visible list
+        std::uint32_t DrawCount; // written by the worker
+        std::uint32_t DrawnInstances; // written by the worker
+    };
+
+    // Splits the sorted keys into one chunk of about the same instance count per worker, none smaller than
+    // MIN_INSTANCES_PER_CHUNK. A chunk always starts a new draw, so a mesh spanning two chunks costs one extra draw
+    QUEST_API void SplitDrawChunks(std::span<const DrawKey> keys, std::uint32_t instanceCount, std::uint32_t workerCount, std::pmr::vector<DrawChunk>& chunks);
+}
@@ -1,14 +1,17 @@
 #pragma once
 #include "Core/Core.h"
 #include "Core/Window.h"
+#include "Core/Profiler.h"
 //#include "GraphicsContext.h"
 #include "RHI/ResourceTypes.h"
 #include <memory>
 #include <span>
+#include <string>
 
 namespace QE
 {
 	class GraphicsContext;
+	class MemoryRegistry;
 	class TestCamera;
 
 	class QUEST_API GraphicsDevice
@@ -21,18 +24,67 @@ namespace QE
 		virtual void EndFrame() = 0;
 		virtual void PresentFrame() = 0;
 
+		static constexpr float MIN_RENDER_SCALE = 0.25f;
+
+		// Only records the new size, the swapchain is rebuilt at the start of the next frame
 		virtual void UpdateWindowSize(uint32_t width, uint32_t height) = 0;
+		// Fraction of the window resolution the scene is rendered at before it is scaled up to the window,
+		// clamped to [MIN_RENDER_SCALE, 1]
+		virtual void SetRenderScale(float scale) = 0;
+		virtual float GetRenderScale() const = 0;
+		// More frames in flight keep the GPU busier at the cost of input latency, the count is clamped to [1, 4]
+		// and applied at the start of the next frame
+		virtual void SetFramesInFlight(uint32_t count) = 0;
+		virtual uint32_t GetFramesInFlight() const = 0;
+		// Filled in when a frame is submitted
+		virtual const FramePacingStats& GetFramePacingStats() const = 0;
+		// Filled in when a frame is recorded
+		virtual const RenderGraphStats& GetRenderGraphStats() const = 0;
+		// Records every barrier on its own with full pipeline masks, as before they were batched. Only for
+		// comparing GPU times, applies from the next barrier recorded
+		virtual void SetConservativeBarriers(bool conservative) = 0;
+		virtual bool GetConservativeBarriers() const = 0;
+		// Number of the frame being recorded, counts presented frames from 0. The GPU profile of a frame carries the same number
+		virtual uint32_t GetFrameNumber() const = 0;
+		// Last frame the GPU finished, read back without waiting, a few frames behind the one being recorded
+		virtual const GpuFrameProfile& GetGpuFrameProfile() const = 0;
+		// Reads back the scene of the frame being recorded, without ImGui, and writes it to path as a PPM
+		// once the GPU has finished it. Call between BeginFrame and EndFrame
+		virtual void CaptureFrame(const std::string& path) = 0;
 		virtual std::unique_ptr<GraphicsContext> CreateGraphicsContext() = 0;
 
-		virtual BufferHandle CreateBuffer(BufferDescription desc) = 0;
-		virtual TextureHandle CreateTexture(TextureDescription desc) = 0;
+		virtual BufferHandle CreateBuffer(const BufferDescription& desc) = 0;
+		virtual TextureHandle CreateTexture(const TextureDescription& desc) = 0;
 		virtual MeshHandle CreateMesh(std::span<Vertex> vertices, std::span<uint32_t> indices) = 0;
 
-		// Temporary probably
+		// The GPU resource is released once the frames that may still use it have finished,
+		// the handle is invalid as soon as the call returns
+		virtual void DestroyBuffer(BufferHandle buffer) = 0;
+		virtual void DestroyTexture(TextureHandle texture) = 0;
+		// Also releases the mesh's vertex and index data
+		virtual void DestroyMesh(MeshHandle mesh) = 0;
+
+		// Draws are recorded during the frame, EndFrame sorts them by pipeline and mesh,
+		// frustum culls every instance on the GPU and emits them all in one render pass
+		virtual void SubmitDraw(const DrawPacket& packet) = 0;
+		// Draws the mesh once per transform, the transforms are copied before returning
+		virtual void DrawMeshInstanced(MeshHandle mesh, TextureHandle texture, std::span<const glm::mat4> transforms) = 0;
+		virtual const DrawStats& GetDrawStats() const = 0;
+		// Threads the draw list is recorded on, clamped to [1, GetMaxRecordThreads()]. All of them are used by
+		// default, fewer are for measuring how recording scales with the core count
+		virtual void SetRecordThreads(uint32_t count) = 0;
+		virtual uint32_t GetRecordThreads() const = 0;
+		virtual uint32_t GetMaxRecordThreads() const = 0;
+
+		// Temporary probably, same as SubmitDraw with an identity transform
 		virtual void DrawMesh(MeshHandle mesh, TextureHandle* texture = nullptr) = 0;
 		virtual void WaitForDeviceIdle() = 0;
 		virtual void SetCamera(TestCamera* camera) = 0;
 
+		// Adds the device's CPU side allocators to the registry, they have to be unregistered before the device is destroyed
+		virtual void RegisterAllocators(MemoryRegistry& registry) = 0;
+		virtual void UnregisterAllocators(MemoryRegistry& registry) = 0;
+
 		friend class GraphicsContext;
 	};
 
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Core/Core.h"
-#include "Core/Containers/RawBuffer.h"
+#include "Core/Containers/ByteBuffer.h"
 #include "RHISettings.h"
 #include <vector>
 #include <glm/glm.hpp>
@@ -27,48 +27,106 @@ namespace QE
     };
 
     // Handles
+    // Index + generation into the RHI's resource pools, a default constructed handle is never valid
     struct QUEST_API BufferHandle
     {
-        std::uint32_t Value;
+        std::uint32_t Index = UINT32_MAX;
+        std::uint32_t Generation = 0;
+
+        bool IsValid() const { return Index != UINT32_MAX; }
 
         bool operator==(const BufferHandle& other) const
         {
-            return other.Value == Value;
+            return other.Index == Index && other.Generation == Generation;
         }
     };
 
     struct QUEST_API TextureHandle
     {
-        std::uint32_t Value;
+        std::uint32_t Index = UINT32_MAX;
+        std::uint32_t Generation = 0;
+
+        bool IsValid() const { return Index != UINT32_MAX; }
 
         bool operator==(const TextureHandle& other) const
         {
-            return other.Value == Value;
+            return other.Index == Index && other.Generation == Generation;
         }
     };
 
     struct QUEST_API MeshHandle
     {
-        std::uint32_t Value;
+        std::uint32_t Index = UINT32_MAX;
+        std::uint32_t Generation = 0;
+
+        bool IsValid() const { return Index != UINT32_MAX; }
+
         bool operator==(const MeshHandle& other) const
         {
-            return other.Value == Value;
+            return other.Index == Index && other.Generation == Generation;
         }
     };
 
+    // Drawing
+    // One mesh draw, recorded into the frame's draw list and emitted when the frame ends
+    struct QUEST_API DrawPacket
+    {
+        MeshHandle Mesh;
+        TextureHandle Texture; // invalid uses the fallback texture
+        glm::mat4 Transform = glm::mat4(1.0f);
+    };
+
+    // What the last flushed draw list cost, binds that were skipped because the state was already set are not counted
+    struct QUEST_API DrawStats
+    {
+        std::uint32_t Instances = 0; // submitted, before culling
+        std::uint32_t Draws = 0; // multi-draw indirect calls, textures are bindless so one per recorded chunk
+        std::uint32_t PipelineBinds = 0;
+        std::uint32_t TextureBinds = 0; // bindless table binds
+        std::uint32_t IndexBufferBinds = 0;
+        std::uint32_t SecondaryCommandBuffers = 0; // one per chunk of the draw list
+        std::uint32_t RecordWorkers = 0; // threads that recorded the chunks
+        float RecordTimeMs = 0.0f; // CPU time to sort, write and record the draw list
+    };
+
+    // How the last frame overlapped with the GPU. A frame waits for the GPU when it first needs resources that an
+    // earlier frame may still be using, a long wait means the GPU is the bottleneck and fewer frames in flight only
+    // cost throughput, no wait with several queued frames means the CPU is ahead and latency can be traded away
+    struct QUEST_API FramePacingStats
+    {
+        std::uint32_t FramesInFlight = 0;
+        std::uint32_t QueuedFrames = 0; // submitted frames the GPU had not finished when the frame started waiting
+        float CpuTimeMs = 0.0f; // BeginFrame to submit, without the wait
+        float WaitTimeMs = 0.0f; // blocked on the GPU
+        float FrameTimeMs = 0.0f; // submit to submit
+    };
+
+    // What the render graph made of the last frame
+    struct QUEST_API RenderGraphStats
+    {
+        std::uint32_t Passes = 0; // declared, culled ones included
+        std::uint32_t CulledPasses = 0; // nothing read what they wrote
+        std::uint32_t ImageBarriers = 0;
+        std::uint32_t BarrierBatches = 0; // vkCmdPipelineBarrier2 calls, at most one per pass
+        std::uint32_t SkippedBarriers = 0; // reads after reads that needed none
+        std::uint32_t TransientImages = 0;
+        std::uint64_t TransientMemory = 0; // bytes backing the transient images
+        std::uint64_t AliasedMemory = 0; // bytes saved by transient images sharing memory
+    };
+
     // Descriptions
+    // Data is only borrowed, it has to stay alive until the Create call returns
     struct QUEST_API BufferDescription
     {
         BufferType Type;
         BufferUsage Usage = BufferUsage::Default;
-        std::vector<std::uint8_t> Data;
-        std::size_t DataSize = 0;
+        ByteView Data;
         std::size_t Count = 0;
     };
 
     struct QUEST_API TextureDescription
     {
-        std::vector<std::uint8_t> Data;
+        ByteView Data;
         std::uint32_t ImageWidth;
         std::uint32_t ImageHeight;
         std::uint32_t ImageDepth = 1;
@@ -81,7 +139,7 @@ struct std::hash<QE::BufferHandle>
 {
     std::size_t operator()(const QE::BufferHandle& handle) const noexcept
     {
-        return std::hash<std::uint32_t>()(handle.Value);
+        return std::hash<std::uint64_t>()((static_cast<std::uint64_t>(handle.Generation) << 32) | handle.Index);
     }
 };
 
@@ -90,7 +148,7 @@ struct std::hash<QE::TextureHandle>
 {
     std::size_t operator()(const QE::TextureHandle& handle) const noexcept
     {
-        return std::hash<std::uint32_t>()(handle.Value);
+        return std::hash<std::uint64_t>()((static_cast<std::uint64_t>(handle.Generation) << 32) | handle.Index);
     }
 };
 
@@ -99,6 +157,6 @@ struct std::hash<QE::MeshHandle>
 {
     std::size_t operator()(const QE::MeshHandle& handle) const noexcept
     {
-        return std::hash<std::uint32_t>()(handle.Value);
+        return std::hash<std::uint64_t>()((static_cast<std::uint64_t>(handle.Generation) << 32) | handle.Index);
     }
 };
\ No newline at end of file
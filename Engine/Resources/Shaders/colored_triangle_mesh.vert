@@ -1,39 +0,0 @@
-#version 450
-#extension GL_EXT_buffer_reference : require
-
-layout (location = 0) out vec3 outColor;
-layout (location = 1) out vec2 outUV;
-
-struct Vertex {
-
-	vec3 position;
-	float uv_x;
-	vec3 normal;
-	float uv_y;
-	vec4 color;
-}; 
-
-layout(buffer_reference, std430) readonly buffer VertexBuffer{ 
-	Vertex vertices[];
-};
-
-//push constants block
-layout( push_constant ) uniform constants
-{
-	mat4 Model;
-	mat4 View;
-	mat4 Projection;
-	VertexBuffer vertexBuffer;
-} PushConstants;
-
-void main() 
-{	
-	//load vertex data from device adress
-	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
-
-	//output data
-	gl_Position = PushConstants.Projection * PushConstants.View * PushConstants.Model * vec4(v.position, 1.0f);
-	outColor = v.color.xyz;
-	outUV.x = v.uv_x;
-	outUV.y = v.uv_y;
-}
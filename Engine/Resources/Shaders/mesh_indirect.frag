@@ -0,0 +1,19 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+//shader input
+layout (location = 0) in vec3 inColor;
+layout (location = 1) in vec2 inUV;
+layout (location = 2) flat in uint inTextureIndex;
+
+//output write
+layout (location = 0) out vec4 outFragColor;
+
+// Every texture, indexed by the slot it was registered in
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+
+void main()
+{
+	// One indirect call covers every draw, so the index is not uniform
+	outFragColor = texture(textures[nonuniformEXT(inTextureIndex)], inUV);
+}
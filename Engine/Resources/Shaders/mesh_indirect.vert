@@ -0,0 +1,60 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+
+layout (location = 0) out vec3 outColor;
+layout (location = 1) out vec2 outUV;
+layout (location = 2) flat out uint outTextureIndex;
+
+struct Vertex {
+
+	vec3 position;
+	float uv_x;
+	vec3 normal;
+	float uv_y;
+	vec4 color;
+};
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer{
+	Vertex vertices[];
+};
+
+struct InstanceData {
+	mat4 transform;
+	uint drawIndex;
+	uint textureIndex; // slot in the bindless texture table
+};
+
+layout(buffer_reference, std430) readonly buffer InstanceBuffer{
+	InstanceData instances[];
+};
+
+layout(buffer_reference, std430) readonly buffer VisibleInstanceBuffer{
+	uint instances[];
+};
+
+// Per frame data, set 0 is the bindless texture table
+layout(set = 1, binding = 0) uniform SceneData {
+	mat4 viewProjection;
+	vec4 frustumPlanes[6];
+	InstanceBuffer instanceBuffer;
+	uvec2 drawBuffer;
+	uvec2 drawCommandBuffer;
+	VisibleInstanceBuffer visibleInstanceBuffer;
+	VertexBuffer vertexBuffer; // every mesh lives in the same buffer
+} sceneData;
+
+void main()
+{
+	// firstInstance points gl_InstanceIndex at the draw's range of the visible list
+	uint instanceIndex = sceneData.visibleInstanceBuffer.instances[gl_InstanceIndex];
+	InstanceData instance = sceneData.instanceBuffer.instances[instanceIndex];
+	// gl_VertexIndex already includes the mesh's vertexOffset
+	Vertex v = sceneData.vertexBuffer.vertices[gl_VertexIndex];
+
+	//output data
+	gl_Position = sceneData.viewProjection * instance.transform * vec4(v.position, 1.0f);
+	outColor = v.color.xyz;
+	outUV.x = v.uv_x;
+	outUV.y = v.uv_y;
+	outTextureIndex = instance.textureIndex;
+}
@@ -11,6 +11,9 @@
 #include "Engine/Engine.h"
 #include "gtx/quaternion.hpp"
 
+#include <algorithm>
+#include <memory>
+
 namespace QE
 {
 	void ProcessNode(aiNode* node, const aiScene* scene, Model* model, bool rotate90);
@@ -71,8 +74,31 @@ namespace QE
 
 	MeshHandle ProcessMesh(aiMesh* mesh, const aiScene* scene, bool rotate90)
     {
-    	std::vector<uint32_t> indices;
-    	std::vector<Vertex> vertices;
+    	std::size_t indexCount = 0;
+    	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    		indexCount += mesh->mFaces[i].mNumIndices;
+
+    	// Stage the vertex and index data on the scratch end of the level allocator, it is popped once the mesh is uploaded
+    	DoubleEndedStackAllocator& levelAllocator = g_Engine.GetLevelAllocator();
+    	const StackMarker scratchMarker = levelAllocator.GetTopMarker();
+    	auto* vertexMemory = static_cast<Vertex*>(levelAllocator.TryAllocateTop(sizeof(Vertex) * std::max(mesh->mNumVertices, 1u), alignof(Vertex)));
+    	auto* indexMemory = static_cast<uint32_t*>(levelAllocator.TryAllocateTop(sizeof(uint32_t) * std::max<std::size_t>(indexCount, 1), alignof(uint32_t)));
+
+    	// Fall back to one heap buffer for meshes that don't fit in the scratch space, the indices follow the vertices
+    	ByteBuffer fallback;
+    	if (!vertexMemory || !indexMemory)
+    	{
+    		LOG_TRACE("Mesh with {} vertices does not fit in the scratch space, staging it on the heap", mesh->mNumVertices);
+    		levelAllocator.FreeTopToMarker(scratchMarker);
+    		const std::size_t vertexBytes = sizeof(Vertex) * mesh->mNumVertices;
+    		fallback = ByteBuffer(vertexBytes + sizeof(uint32_t) * indexCount);
+    		vertexMemory = fallback.As<Vertex>();
+    		indexMemory = reinterpret_cast<uint32_t*>(fallback.Data() + vertexBytes);
+    	}
+    	std::uninitialized_default_construct_n(vertexMemory, mesh->mNumVertices);
+
+    	std::span<Vertex> vertices(vertexMemory, mesh->mNumVertices);
+    	std::span<uint32_t> indices(indexMemory, indexCount);
     	// Textures here once it exists
 
     	aiMatrix4x4 rotationMatrix;
@@ -80,7 +106,7 @@ namespace QE
     	// Go through each mesh's vertices
     	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     	{
-    		Vertex newVtx;
+    		Vertex& newVtx = vertices[i];
     		aiVector3D pos = mesh->mVertices[i];
     		if (rotate90)
     			pos = rotationMatrix * pos;
@@ -105,16 +131,15 @@ namespace QE
 
     		// Placeholder
     		newVtx.Color = glm::vec4{ 1.0f };
-
-    		vertices.push_back(newVtx);
     	}
 
     	// Go through each face and get the indices
+    	std::size_t index = 0;
     	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
     	{
-    		aiFace face = mesh->mFaces[i];
+    		const aiFace& face = mesh->mFaces[i];
     		for (unsigned int j = 0; j < face.mNumIndices; j++)
-    			indices.push_back(face.mIndices[j]);
+    			indices[index++] = face.mIndices[j];
     	}
 
     	// Material processing
@@ -123,6 +148,8 @@ namespace QE
     	// Move the mesh uploading stuff elsewhere later
 		MeshHandle newMesh = g_Engine.GetGraphicsDevice().CreateMesh(vertices, indices);
 
+    	levelAllocator.FreeTopToMarker(scratchMarker);
+
     	return newMesh;
     }
 
@@ -144,18 +171,16 @@ namespace QE
     		return std::nullopt;
     	}
 
+    	// Upload straight from stb's memory, it is only freed once the texture has been created
     	TextureDescription desc{};
-    	std::vector<std::uint8_t> pixelsbuff;
-    	pixelsbuff.resize(imageSize);
-    	memcpy(pixelsbuff.data(), pixels, imageSize);
-    	desc.Data = pixelsbuff;
+    	desc.Data = ByteView(pixels, imageSize);
     	desc.ImageWidth = texWidth;
     	desc.ImageHeight = texHeight;
 
-    	stbi_image_free(pixels);
-
     	TextureHandle texture =  g_Engine.GetGraphicsDevice().CreateTexture(desc);
 
+    	stbi_image_free(pixels);
+
     	return texture;
 	}
 
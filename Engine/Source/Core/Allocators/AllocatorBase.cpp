@@ -1,10 +1,21 @@
 #include "Core/Allocators/AllocatorBase.h"
 #include "Core/Log.h"
 
+#include <atomic>
+
 namespace QE
 {
+    namespace
+    {
+        // Thread safe allocators update their stats through atomic_ref from several threads, read them the same way
+        std::size_t LoadStat(const std::size_t& stat) noexcept
+        {
+            return std::atomic_ref(const_cast<std::size_t&>(stat)).load(std::memory_order_relaxed);
+        }
+    }
+
     AllocatorBase::AllocatorBase(const std::size_t sizeInBytes, void *const addressOfAllocatedMemory) noexcept
-        : m_TotalBytes(sizeInBytes), m_UsedBytes(0), m_NumAllocations(0), m_StartPtr(addressOfAllocatedMemory)
+        : m_TotalBytes(sizeInBytes), m_UsedBytes(0), m_NumAllocations(0), m_TotalAllocations(0), m_StartPtr(addressOfAllocatedMemory)
     {
         // TODO: make an assert macro later and test it that sizeInBytes > 0
         if (!sizeInBytes > 0)
@@ -15,11 +26,12 @@ namespace QE
     }
 
     AllocatorBase::AllocatorBase(AllocatorBase&& other) noexcept
-        : m_TotalBytes(other.m_TotalBytes), m_UsedBytes(other.m_UsedBytes), m_NumAllocations(other.m_NumAllocations), m_StartPtr(other.m_StartPtr)
+        : m_TotalBytes(other.m_TotalBytes), m_UsedBytes(other.m_UsedBytes), m_NumAllocations(other.m_NumAllocations), m_TotalAllocations(other.m_TotalAllocations), m_StartPtr(other.m_StartPtr)
     {
         other.m_TotalBytes = 0;
         other.m_UsedBytes = 0;
         other.m_NumAllocations = 0;
+        other.m_TotalAllocations = 0;
         other.m_StartPtr = nullptr;
     }
 
@@ -28,11 +40,13 @@ namespace QE
         m_TotalBytes = rhs.m_TotalBytes;
         m_UsedBytes = rhs.m_UsedBytes;
         m_NumAllocations = rhs.m_NumAllocations;
+        m_TotalAllocations = rhs.m_TotalAllocations;
         m_StartPtr = rhs.m_StartPtr;
 
         rhs.m_TotalBytes = 0;
         rhs.m_UsedBytes = 0;
         rhs.m_NumAllocations = 0;
+        rhs.m_TotalAllocations = 0;
         rhs.m_StartPtr = nullptr;
 
         return *this;
@@ -50,17 +64,22 @@ namespace QE
 
     std::size_t AllocatorBase::GetUsedSize() const noexcept
     {
-        return m_UsedBytes;
+        return LoadStat(m_UsedBytes);
     }
 
     std::size_t AllocatorBase::GetFreeSize() const noexcept
     {
-        return m_TotalBytes - m_UsedBytes;
+        return m_TotalBytes - LoadStat(m_UsedBytes);
     }
 
     std::size_t AllocatorBase::GetNumberOfAllocations() const noexcept
     {
-        return m_NumAllocations;
+        return LoadStat(m_NumAllocations);
+    }
+
+    std::size_t AllocatorBase::GetTotalAllocations() const noexcept
+    {
+        return LoadStat(m_TotalAllocations);
     }
 
     const void* AllocatorBase::GetStartPtr() const noexcept
@@ -0,0 +1,224 @@
+#include "Core/Allocators/DoubleEndedStackAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include <algorithm>
+#include <utility>
+
+namespace QE
+{
+    DoubleEndedStackAllocator::DoubleEndedStackAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept
+        : AllocatorBase(sizeInBytes, addressOfAllocatedMemory), m_BottomPtr(addressOfAllocatedMemory), m_TopPtr(ptr_add(addressOfAllocatedMemory, sizeInBytes))
+    {
+    }
+
+    DoubleEndedStackAllocator::DoubleEndedStackAllocator(DoubleEndedStackAllocator&& other) noexcept
+        : AllocatorBase(std::move(other)), m_BottomPtr(other.m_BottomPtr), m_TopPtr(other.m_TopPtr),
+        m_LastBottomAllocation(other.m_LastBottomAllocation), m_LastTopAllocation(other.m_LastTopAllocation),
+        m_BottomAllocations(other.m_BottomAllocations), m_TopAllocations(other.m_TopAllocations)
+    {
+        other.m_BottomPtr = nullptr;
+        other.m_TopPtr = nullptr;
+        other.m_LastBottomAllocation = nullptr;
+        other.m_LastTopAllocation = nullptr;
+        other.m_BottomAllocations = 0;
+        other.m_TopAllocations = 0;
+    }
+
+    DoubleEndedStackAllocator& DoubleEndedStackAllocator::operator=(DoubleEndedStackAllocator&& rhs) noexcept
+    {
+        AllocatorBase::operator=(std::move(rhs));
+        m_BottomPtr = rhs.m_BottomPtr;
+        m_TopPtr = rhs.m_TopPtr;
+        m_LastBottomAllocation = rhs.m_LastBottomAllocation;
+        m_LastTopAllocation = rhs.m_LastTopAllocation;
+        m_BottomAllocations = rhs.m_BottomAllocations;
+        m_TopAllocations = rhs.m_TopAllocations;
+
+        rhs.m_BottomPtr = nullptr;
+        rhs.m_TopPtr = nullptr;
+        rhs.m_LastBottomAllocation = nullptr;
+        rhs.m_LastTopAllocation = nullptr;
+        rhs.m_BottomAllocations = 0;
+        rhs.m_TopAllocations = 0;
+        return *this;
+    }
+
+    DoubleEndedStackAllocator::~DoubleEndedStackAllocator() noexcept
+    {
+    }
+
+    void* DoubleEndedStackAllocator::Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        return AllocateBottom(sizeInBytes, alignment);
+    }
+
+    void DoubleEndedStackAllocator::Free(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        if (ptr >= m_TopPtr)
+            FreeTop(ptr);
+        else
+            FreeBottom(ptr);
+    }
+
+    void* DoubleEndedStackAllocator::AllocateBottom(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        void* ptr = TryAllocateBottom(sizeInBytes, alignment);
+        if (!ptr)
+            LOG_ERROR_TAG("DoubleEndedStackAllocator", "Out of memory (bottom): requested {} bytes with {} of {} bytes used", sizeInBytes, m_UsedBytes, m_TotalBytes);
+        return ptr;
+    }
+
+    void* DoubleEndedStackAllocator::AllocateTop(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        void* ptr = TryAllocateTop(sizeInBytes, alignment);
+        if (!ptr)
+            LOG_ERROR_TAG("DoubleEndedStackAllocator", "Out of memory (top): requested {} bytes with {} of {} bytes used", sizeInBytes, m_UsedBytes, m_TotalBytes);
+        return ptr;
+    }
+
+    void* DoubleEndedStackAllocator::TryAllocateBottom(const std::size_t sizeInBytes, const std::uintptr_t alignment) noexcept
+    {
+        QE_ASSERT(sizeInBytes > 0 && is_power_of_two(alignment));
+
+        const std::size_t headerAlignment = std::max<std::size_t>(alignment, alignof(StackAllocationHeader));
+        const std::size_t adjustment = align_forward_adjustment_with_header(m_BottomPtr, headerAlignment, sizeof(StackAllocationHeader));
+
+        if (adjustment + sizeInBytes > ptr_diff(m_BottomPtr, m_TopPtr))
+            return nullptr;
+
+        void* alignedAddress = ptr_add(m_BottomPtr, adjustment);
+
+        auto* header = static_cast<StackAllocationHeader*>(ptr_sub(alignedAddress, sizeof(StackAllocationHeader)));
+        header->PreviousTop = m_BottomPtr;
+        header->PreviousAllocation = m_LastBottomAllocation;
+
+        m_BottomPtr = ptr_add(alignedAddress, sizeInBytes);
+        m_LastBottomAllocation = alignedAddress;
+        m_BottomAllocations++;
+        m_TotalAllocations++;
+        UpdateStats();
+
+        return alignedAddress;
+    }
+
+    void* DoubleEndedStackAllocator::TryAllocateTop(const std::size_t sizeInBytes, const std::uintptr_t alignment) noexcept
+    {
+        QE_ASSERT(sizeInBytes > 0 && is_power_of_two(alignment));
+
+        const std::size_t headerAlignment = std::max<std::size_t>(alignment, alignof(StackAllocationHeader));
+        const std::size_t freeBytes = ptr_diff(m_BottomPtr, m_TopPtr);
+
+        // Grow downwards, the header sits right below the aligned address
+        void* alignedAddress = sizeInBytes <= freeBytes ? align_backward(ptr_sub(m_TopPtr, sizeInBytes), headerAlignment) : nullptr;
+        if (!alignedAddress || alignedAddress < m_BottomPtr || ptr_diff(m_BottomPtr, alignedAddress) < sizeof(StackAllocationHeader))
+            return nullptr;
+
+        auto* header = static_cast<StackAllocationHeader*>(ptr_sub(alignedAddress, sizeof(StackAllocationHeader)));
+        header->PreviousTop = m_TopPtr;
+        header->PreviousAllocation = m_LastTopAllocation;
+
+        m_TopPtr = header;
+        m_LastTopAllocation = alignedAddress;
+        m_TopAllocations++;
+        m_TotalAllocations++;
+        UpdateStats();
+
+        return alignedAddress;
+    }
+
+    void DoubleEndedStackAllocator::FreeBottom(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        QE_ASSERT(ptr == m_LastBottomAllocation);
+
+        const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(ptr, sizeof(StackAllocationHeader)));
+        m_BottomPtr = header->PreviousTop;
+        m_LastBottomAllocation = header->PreviousAllocation;
+        m_BottomAllocations--;
+        UpdateStats();
+    }
+
+    void DoubleEndedStackAllocator::FreeTop(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        QE_ASSERT(ptr == m_LastTopAllocation);
+
+        const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(ptr, sizeof(StackAllocationHeader)));
+        m_TopPtr = header->PreviousTop;
+        m_LastTopAllocation = header->PreviousAllocation;
+        m_TopAllocations--;
+        UpdateStats();
+    }
+
+    StackMarker DoubleEndedStackAllocator::GetBottomMarker() const noexcept
+    {
+        return ptr_diff(m_StartPtr, m_BottomPtr);
+    }
+
+    StackMarker DoubleEndedStackAllocator::GetTopMarker() const noexcept
+    {
+        return ptr_diff(m_TopPtr, GetEndPtr());
+    }
+
+    void DoubleEndedStackAllocator::FreeBottomToMarker(const StackMarker marker) noexcept
+    {
+        QE_ASSERT(marker <= GetBottomMarker());
+
+        void* const markerPtr = ptr_add(m_StartPtr, marker);
+        while (m_LastBottomAllocation && m_LastBottomAllocation >= markerPtr)
+        {
+            const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(m_LastBottomAllocation, sizeof(StackAllocationHeader)));
+            m_LastBottomAllocation = header->PreviousAllocation;
+            m_BottomAllocations--;
+        }
+
+        m_BottomPtr = markerPtr;
+        UpdateStats();
+    }
+
+    void DoubleEndedStackAllocator::FreeTopToMarker(const StackMarker marker) noexcept
+    {
+        QE_ASSERT(marker <= GetTopMarker());
+
+        void* const markerPtr = ptr_sub(GetEndPtr(), marker);
+        while (m_LastTopAllocation && m_LastTopAllocation < markerPtr)
+        {
+            const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(m_LastTopAllocation, sizeof(StackAllocationHeader)));
+            m_LastTopAllocation = header->PreviousAllocation;
+            m_TopAllocations--;
+        }
+
+        m_TopPtr = markerPtr;
+        UpdateStats();
+    }
+
+    void DoubleEndedStackAllocator::ClearBottom() noexcept
+    {
+        FreeBottomToMarker(0);
+    }
+
+    void DoubleEndedStackAllocator::ClearTop() noexcept
+    {
+        FreeTopToMarker(0);
+    }
+
+    void DoubleEndedStackAllocator::UpdateStats() noexcept
+    {
+        m_UsedBytes = GetBottomMarker() + GetTopMarker();
+        m_NumAllocations = m_BottomAllocations + m_TopAllocations;
+    }
+
+    void* DoubleEndedStackAllocator::GetEndPtr() const noexcept
+    {
+        return ptr_add(m_StartPtr, m_TotalBytes);
+    }
+}
@@ -0,0 +1,66 @@
+#include "Core/Allocators/FrameAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
+
+#include "Core/Core.h"
+#include <cstdlib>
+
+namespace QE
+{
+    FrameAllocator::FrameAllocator(const std::size_t sizeInBytesPerFrame) noexcept
+        : AllocatorBase(sizeInBytesPerFrame * 2, std::malloc(sizeInBytesPerFrame * 2)),
+        m_FrameBuffers{
+            LinearAllocator(sizeInBytesPerFrame, m_StartPtr),
+            LinearAllocator(sizeInBytesPerFrame, ptr_add(m_StartPtr, sizeInBytesPerFrame))
+        }
+    {
+        QE_ASSERT(m_StartPtr != nullptr);
+    }
+
+    FrameAllocator::~FrameAllocator() noexcept
+    {
+        std::free(m_StartPtr);
+    }
+
+    void* FrameAllocator::Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        // Only the current buffer changes, its padding counts as used like it does there
+        LinearAllocator& buffer = m_FrameBuffers[m_CurrentBuffer];
+        const std::size_t usedBefore = buffer.GetUsedSize();
+        void* ptr = buffer.Allocate(sizeInBytes, alignment);
+        if (ptr)
+        {
+            m_UsedBytes += buffer.GetUsedSize() - usedBefore;
+            m_NumAllocations++;
+            m_TotalAllocations++;
+        }
+        return ptr;
+    }
+
+    void FrameAllocator::Free([[maybe_unused]] void* const ptr) noexcept
+    {
+    }
+
+    void FrameAllocator::BeginFrame() noexcept
+    {
+        m_CurrentBuffer ^= 1;
+        m_FrameBuffers[m_CurrentBuffer].Clear();
+        UpdateStats();
+    }
+
+    LinearAllocator& FrameAllocator::GetCurrentFrameAllocator() noexcept
+    {
+        return m_FrameBuffers[m_CurrentBuffer];
+    }
+
+    std::uint32_t FrameAllocator::GetCurrentBufferIndex() const noexcept
+    {
+        return m_CurrentBuffer;
+    }
+
+    void FrameAllocator::UpdateStats() noexcept
+    {
+        m_UsedBytes = m_FrameBuffers[0].GetUsedSize() + m_FrameBuffers[1].GetUsedSize();
+        m_NumAllocations = m_FrameBuffers[0].GetNumberOfAllocations() + m_FrameBuffers[1].GetNumberOfAllocations();
+        m_TotalAllocations = m_FrameBuffers[0].GetTotalAllocations() + m_FrameBuffers[1].GetTotalAllocations();
+    }
+}
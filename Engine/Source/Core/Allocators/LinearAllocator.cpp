@@ -1,4 +1,5 @@
 #include "Core/Allocators/LinearAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
 
 #include "Core/Core.h"
 #include "Core/Log.h"
@@ -6,19 +7,6 @@
 
 namespace QE
 {
-    inline std::size_t align_forward_adjustment(const void* const ptr, const std::size_t & alignment) noexcept
-    {
-        const auto iptr = reinterpret_cast<std::uintptr_t>(ptr);
-        const auto aligned = (iptr - 1u + alignment) & -alignment;
-        return aligned - iptr;
-    }
-
-    inline void* ptr_add(const void* const p, const std::uintptr_t& amount) noexcept
-    {
-        return reinterpret_cast<void*>
-            (reinterpret_cast<std::uintptr_t>(p) + amount);
-    }
-
     LinearAllocator::LinearAllocator(const size_t sizeInBytes, void * const addressOfAllocatedMemory) noexcept
         : AllocatorBase(sizeInBytes, addressOfAllocatedMemory), m_CurrentPtr(addressOfAllocatedMemory)
     {
@@ -45,25 +33,52 @@ namespace QE
 
     void* LinearAllocator::Allocate(const size_t sizeInBytes, const std::uintptr_t alignment)
     {
-        QE_ASSERT(sizeInBytes > 0 && alignment > 0);
+        QE_ASSERT(sizeInBytes > 0 && is_power_of_two(alignment));
 
-        size_t adjustment = align_forward_adjustment(m_CurrentPtr, alignment);
+        const size_t adjustment = align_forward_adjustment(m_CurrentPtr, alignment);
+
+        if (m_UsedBytes + adjustment + sizeInBytes > m_TotalBytes)
+        {
+            LOG_ERROR_TAG("LinearAllocator", "Out of memory: requested {} bytes with {} of {} bytes used", sizeInBytes, m_UsedBytes, m_TotalBytes);
+            return nullptr;
+        }
+
+        void* alignedAddress = ptr_add(m_CurrentPtr, adjustment);
+        m_CurrentPtr = ptr_add(alignedAddress, sizeInBytes);
+
+        m_UsedBytes += adjustment + sizeInBytes;
+        m_NumAllocations++;
+        m_TotalAllocations++;
+
+        return alignedAddress;
     }
 
-    void LinearAllocator::Free(void * const ptr) noexcept
+    void LinearAllocator::Free([[maybe_unused]] void * const ptr) noexcept
     {
+        // Nothing to do, use Rewind or Clear instead
     }
 
     void* LinearAllocator::GetCurrentPointer() const noexcept
     {
-        return nullptr;
+        return m_CurrentPtr;
     }
 
     void LinearAllocator::Rewind(void * const mark) noexcept
     {
+        QE_ASSERT(mark >= m_StartPtr && mark <= m_CurrentPtr);
+
+        m_CurrentPtr = mark;
+        m_UsedBytes = ptr_diff(m_StartPtr, mark);
+
+        // Individual allocations aren't tracked, so the count is only exact when rewinding to the start
+        if (m_UsedBytes == 0)
+            m_NumAllocations = 0;
     }
 
     void LinearAllocator::Clear() noexcept
     {
+        m_CurrentPtr = m_StartPtr;
+        m_UsedBytes = 0;
+        m_NumAllocations = 0;
     }
 }
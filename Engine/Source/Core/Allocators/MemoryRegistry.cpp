@@ -0,0 +1,293 @@
+#include "Core/Allocators/MemoryRegistry.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include "imgui.h"
+#include <algorithm>
+#include <glaze/glaze.hpp>
+#include <glaze/csv.hpp>
+
+namespace QE
+{
+    namespace
+    {
+        // Flat records for the dumps, tags are written as their names
+        struct AllocatorRecord
+        {
+            std::string Name;
+            std::string Tag;
+            std::size_t UsedBytes;
+            std::size_t TotalBytes;
+            std::size_t PeakBytes;
+            std::size_t LiveAllocations;
+            std::size_t AllocationsPerFrame;
+        };
+
+        struct TagRecord
+        {
+            std::string Tag;
+            std::size_t UsedBytes;
+            std::size_t TotalBytes;
+            std::size_t PeakBytes;
+            std::size_t AllocationsPerFrame;
+            std::size_t BudgetBytes;
+            bool OverBudget;
+        };
+
+        struct MemorySnapshot
+        {
+            std::vector<AllocatorRecord> Allocators;
+            std::vector<TagRecord> Tags;
+        };
+
+        // Column layout so the CSV gets one row per allocator with a header line
+        struct AllocatorColumns
+        {
+            std::vector<std::string> Name;
+            std::vector<std::string> Tag;
+            std::vector<std::size_t> UsedBytes;
+            std::vector<std::size_t> TotalBytes;
+            std::vector<std::size_t> PeakBytes;
+            std::vector<std::size_t> LiveAllocations;
+            std::vector<std::size_t> AllocationsPerFrame;
+        };
+
+        float ToMiB(const std::size_t bytes)
+        {
+            return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+        }
+    }
+
+    std::string_view MemoryTagToString(const MemoryTag tag) noexcept
+    {
+        switch (tag)
+        {
+            case MemoryTag::Core: return "Core";
+            case MemoryTag::Renderer: return "Renderer";
+            case MemoryTag::Assets: return "Assets";
+            case MemoryTag::Events: return "Events";
+            case MemoryTag::Game: return "Game";
+            default: return "Unknown";
+        }
+    }
+
+    void MemoryRegistry::RegisterAllocator(const AllocatorBase* allocator, std::string_view name, const MemoryTag tag)
+    {
+        QE_ASSERT(allocator && tag < MemoryTag::Count);
+
+        std::lock_guard lock(m_Mutex);
+        QE_ASSERT(std::ranges::none_of(m_Entries, [allocator](const Entry& entry) { return entry.Allocator == allocator; }));
+
+        Entry entry{ allocator, AllocatorStats{ std::string(name), tag }, allocator->GetTotalAllocations() };
+        entry.Stats.UsedBytes = allocator->GetUsedSize();
+        entry.Stats.TotalBytes = allocator->GetTotalSize();
+        entry.Stats.PeakBytes = entry.Stats.UsedBytes;
+        entry.Stats.LiveAllocations = allocator->GetNumberOfAllocations();
+        m_Entries.push_back(std::move(entry));
+    }
+
+    void MemoryRegistry::UnregisterAllocator(const AllocatorBase* allocator)
+    {
+        std::lock_guard lock(m_Mutex);
+        std::erase_if(m_Entries, [allocator](const Entry& entry) { return entry.Allocator == allocator; });
+    }
+
+    void MemoryRegistry::SetBudget(const MemoryTag tag, const std::size_t budgetInBytes)
+    {
+        QE_ASSERT(tag < MemoryTag::Count);
+
+        std::lock_guard lock(m_Mutex);
+        MemoryTagStats& tagStats = m_TagStats[static_cast<std::size_t>(tag)];
+        tagStats.BudgetBytes = budgetInBytes;
+        tagStats.OverBudget = false;
+    }
+
+    void MemoryRegistry::Update()
+    {
+        std::lock_guard lock(m_Mutex);
+
+        for (MemoryTagStats& tagStats : m_TagStats)
+        {
+            tagStats.UsedBytes = 0;
+            tagStats.TotalBytes = 0;
+            tagStats.AllocationsPerFrame = 0;
+        }
+
+        for (Entry& entry : m_Entries)
+        {
+            AllocatorStats& stats = entry.Stats;
+            const std::size_t totalAllocations = entry.Allocator->GetTotalAllocations();
+
+            stats.UsedBytes = entry.Allocator->GetUsedSize();
+            stats.TotalBytes = entry.Allocator->GetTotalSize();
+            stats.PeakBytes = std::max(stats.PeakBytes, stats.UsedBytes);
+            stats.LiveAllocations = entry.Allocator->GetNumberOfAllocations();
+            stats.AllocationsPerFrame = totalAllocations - entry.LastTotalAllocations;
+            entry.LastTotalAllocations = totalAllocations;
+
+            MemoryTagStats& tagStats = m_TagStats[static_cast<std::size_t>(stats.Tag)];
+            tagStats.UsedBytes += stats.UsedBytes;
+            tagStats.TotalBytes += stats.TotalBytes;
+            tagStats.AllocationsPerFrame += stats.AllocationsPerFrame;
+        }
+
+        for (std::size_t i = 0; i < m_TagStats.size(); i++)
+        {
+            MemoryTagStats& tagStats = m_TagStats[i];
+            tagStats.PeakBytes = std::max(tagStats.PeakBytes, tagStats.UsedBytes);
+
+            // Only warn when crossing the budget, not every frame spent over it
+            const bool overBudget = tagStats.BudgetBytes != 0 && tagStats.UsedBytes > tagStats.BudgetBytes;
+            if (overBudget && !tagStats.OverBudget)
+            {
+                LOG_WARN_TAG("Memory", "{} is over budget: {} of {} bytes used", MemoryTagToString(static_cast<MemoryTag>(i)),
+                    tagStats.UsedBytes, tagStats.BudgetBytes);
+            }
+            tagStats.OverBudget = overBudget;
+        }
+    }
+
+    std::vector<AllocatorStats> MemoryRegistry::GetAllocatorStats() const
+    {
+        std::lock_guard lock(m_Mutex);
+
+        std::vector<AllocatorStats> stats;
+        stats.reserve(m_Entries.size());
+        for (const Entry& entry : m_Entries)
+            stats.push_back(entry.Stats);
+        return stats;
+    }
+
+    MemoryTagStats MemoryRegistry::GetTagStats(const MemoryTag tag) const
+    {
+        QE_ASSERT(tag < MemoryTag::Count);
+
+        std::lock_guard lock(m_Mutex);
+        return m_TagStats[static_cast<std::size_t>(tag)];
+    }
+
+    bool MemoryRegistry::DumpToJson(const std::string& path) const
+    {
+        MemorySnapshot snapshot;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const Entry& entry : m_Entries)
+            {
+                const AllocatorStats& stats = entry.Stats;
+                snapshot.Allocators.push_back({ stats.Name, std::string(MemoryTagToString(stats.Tag)), stats.UsedBytes, stats.TotalBytes,
+                    stats.PeakBytes, stats.LiveAllocations, stats.AllocationsPerFrame });
+            }
+
+            for (std::size_t i = 0; i < m_TagStats.size(); i++)
+            {
+                const MemoryTagStats& tagStats = m_TagStats[i];
+                snapshot.Tags.push_back({ std::string(MemoryTagToString(static_cast<MemoryTag>(i))), tagStats.UsedBytes, tagStats.TotalBytes,
+                    tagStats.PeakBytes, tagStats.AllocationsPerFrame, tagStats.BudgetBytes, tagStats.OverBudget });
+            }
+        }
+
+        if (auto error = glz::write_file_json<glz::opts{ .prettify = true }>(snapshot, path, std::string{}))
+        {
+            LOG_ERROR_TAG("Memory", "Failed to write memory stats to {}: {}", path, glz::format_error(error));
+            return false;
+        }
+
+        LOG_INFO_TAG("Memory", "Memory stats written to {}", path);
+        return true;
+    }
+
+    bool MemoryRegistry::DumpToCsv(const std::string& path) const
+    {
+        AllocatorColumns columns;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const Entry& entry : m_Entries)
+            {
+                const AllocatorStats& stats = entry.Stats;
+                columns.Name.push_back(stats.Name);
+                columns.Tag.emplace_back(MemoryTagToString(stats.Tag));
+                columns.UsedBytes.push_back(stats.UsedBytes);
+                columns.TotalBytes.push_back(stats.TotalBytes);
+                columns.PeakBytes.push_back(stats.PeakBytes);
+                columns.LiveAllocations.push_back(stats.LiveAllocations);
+                columns.AllocationsPerFrame.push_back(stats.AllocationsPerFrame);
+            }
+        }
+
+        if (auto error = glz::write_file_csv<glz::colwise>(columns, path, std::string{}))
+        {
+            LOG_ERROR_TAG("Memory", "Failed to write memory stats to {}: {}", path, glz::format_error(error));
+            return false;
+        }
+
+        LOG_INFO_TAG("Memory", "Memory stats written to {}", path);
+        return true;
+    }
+
+    void MemoryRegistry::DrawDebugInfo()
+    {
+        const std::vector<AllocatorStats> allocatorStats = GetAllocatorStats();
+
+        ImGui::Begin("Memory");
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(MemoryTag::Count); i++)
+        {
+            const MemoryTagStats tagStats = GetTagStats(static_cast<MemoryTag>(i));
+            const std::string_view tagName = MemoryTagToString(static_cast<MemoryTag>(i));
+            const ImVec4 color = tagStats.OverBudget ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImGui::GetStyleColorVec4(ImGuiCol_Text);
+
+            if (tagStats.BudgetBytes != 0)
+            {
+                ImGui::TextColored(color, "%-8.*s %.2f / %.2f MiB (peak %.2f), %zu allocs/frame", static_cast<int>(tagName.size()), tagName.data(),
+                    ToMiB(tagStats.UsedBytes), ToMiB(tagStats.BudgetBytes), ToMiB(tagStats.PeakBytes), tagStats.AllocationsPerFrame);
+                ImGui::ProgressBar(std::min(1.0f, static_cast<float>(tagStats.UsedBytes) / static_cast<float>(tagStats.BudgetBytes)));
+            }
+            else
+            {
+                ImGui::TextColored(color, "%-8.*s %.2f MiB (peak %.2f), %zu allocs/frame", static_cast<int>(tagName.size()), tagName.data(),
+                    ToMiB(tagStats.UsedBytes), ToMiB(tagStats.PeakBytes), tagStats.AllocationsPerFrame);
+            }
+        }
+
+        ImGui::Separator();
+
+        if (ImGui::BeginTable("Allocators", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Used (MiB)");
+            ImGui::TableSetupColumn("Peak (MiB)");
+            ImGui::TableSetupColumn("Size (MiB)");
+            ImGui::TableSetupColumn("Allocs/frame");
+            ImGui::TableHeadersRow();
+
+            for (const AllocatorStats& stats : allocatorStats)
+            {
+                const std::string_view tagName = MemoryTagToString(stats.Tag);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stats.Name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(tagName.data(), tagName.data() + tagName.size());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", ToMiB(stats.UsedBytes));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", ToMiB(stats.PeakBytes));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", ToMiB(stats.TotalBytes));
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.AllocationsPerFrame);
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button("Dump JSON"))
+            DumpToJson("MemoryStats.json");
+        ImGui::SameLine();
+        if (ImGui::Button("Dump CSV"))
+            DumpToCsv("MemoryStats.csv");
+
+        ImGui::End();
+    }
+}
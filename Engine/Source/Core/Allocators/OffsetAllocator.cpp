@@ -0,0 +1,170 @@
+#include "Core/Allocators/OffsetAllocator.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include <algorithm>
+#include <iterator>
+
+namespace QE
+{
+    OffsetAllocator::OffsetAllocator(const std::uint32_t size)
+    {
+        Grow(size);
+    }
+
+    OffsetAllocator::Allocation OffsetAllocator::Allocate(const std::uint32_t size)
+    {
+        if (size == 0)
+            return {};
+
+        // Best fit, the smallest free range that can hold the request
+        auto bySize = m_FreeBySize.lower_bound(size);
+        if (bySize == m_FreeBySize.end())
+            return {};
+
+        const std::uint32_t offset = bySize->second;
+        const std::uint32_t rangeSize = bySize->first;
+        RemoveFreeRange(m_FreeByOffset.find(offset));
+
+        // Give the tail back
+        if (rangeSize > size)
+            InsertFreeRange(offset + size, rangeSize - size);
+
+        m_UsedSize += size;
+        m_NumAllocations++;
+        return { offset, size };
+    }
+
+    void OffsetAllocator::Free(const Allocation& allocation)
+    {
+        if (!allocation.IsValid())
+            return;
+
+        QE_ASSERT(allocation.Offset + allocation.Size <= m_TotalSize && m_NumAllocations > 0);
+
+        std::uint32_t offset = allocation.Offset;
+        std::uint32_t size = allocation.Size;
+
+        // Merge with the free range that ends where this one starts
+        auto next = m_FreeByOffset.lower_bound(offset);
+        if (next != m_FreeByOffset.begin())
+        {
+            auto previous = std::prev(next);
+            QE_ASSERT(previous->first + previous->second <= offset);
+            if (previous->first + previous->second == offset)
+            {
+                offset = previous->first;
+                size += previous->second;
+                RemoveFreeRange(previous);
+            }
+        }
+
+        // And with the one that starts where this one ends
+        if (next != m_FreeByOffset.end())
+        {
+            QE_ASSERT(allocation.Offset + allocation.Size <= next->first);
+            if (allocation.Offset + allocation.Size == next->first)
+            {
+                size += next->second;
+                RemoveFreeRange(next);
+            }
+        }
+
+        InsertFreeRange(offset, size);
+
+        m_UsedSize -= allocation.Size;
+        m_NumAllocations--;
+    }
+
+    void OffsetAllocator::Grow(const std::uint32_t newSize)
+    {
+        if (newSize <= m_TotalSize)
+            return;
+
+        std::uint32_t offset = m_TotalSize;
+        std::uint32_t size = newSize - m_TotalSize;
+
+        // Extend the last free range when it runs up to the old end
+        if (!m_FreeByOffset.empty())
+        {
+            auto last = std::prev(m_FreeByOffset.end());
+            if (last->first + last->second == m_TotalSize)
+            {
+                offset = last->first;
+                size += last->second;
+                RemoveFreeRange(last);
+            }
+        }
+
+        InsertFreeRange(offset, size);
+        m_TotalSize = newSize;
+    }
+
+    void OffsetAllocator::Reset()
+    {
+        m_FreeByOffset.clear();
+        m_FreeBySize.clear();
+        m_UsedSize = 0;
+        m_NumAllocations = 0;
+
+        if (m_TotalSize > 0)
+            InsertFreeRange(0, m_TotalSize);
+    }
+
+    std::vector<OffsetAllocator::Move> OffsetAllocator::Compact(std::span<Allocation* const> allocations)
+    {
+        std::vector<Allocation*> sorted(allocations.begin(), allocations.end());
+        std::erase_if(sorted, [](const Allocation* allocation) { return !allocation->IsValid(); });
+        std::sort(sorted.begin(), sorted.end(), [](const Allocation* a, const Allocation* b) { return a->Offset < b->Offset; });
+
+        // Moving down in offset order never passes an allocation that hasn't moved yet
+        std::vector<Move> moves;
+        moves.reserve(sorted.size());
+        std::uint32_t offset = 0;
+        std::uint32_t previousEnd = 0;
+        for (Allocation* allocation : sorted)
+        {
+            QE_ASSERT(allocation->Offset >= previousEnd && allocation->Offset + allocation->Size <= m_TotalSize);
+            previousEnd = allocation->Offset + allocation->Size;
+            moves.push_back({ allocation->Offset, offset, allocation->Size });
+            allocation->Offset = offset;
+            offset += allocation->Size;
+        }
+
+        m_FreeByOffset.clear();
+        m_FreeBySize.clear();
+        m_UsedSize = offset;
+        m_NumAllocations = static_cast<std::uint32_t>(sorted.size());
+
+        if (offset < m_TotalSize)
+            InsertFreeRange(offset, m_TotalSize - offset);
+
+        return moves;
+    }
+
+    std::uint32_t OffsetAllocator::GetLargestFreeRange() const noexcept
+    {
+        return m_FreeBySize.empty() ? 0 : std::prev(m_FreeBySize.end())->first;
+    }
+
+    void OffsetAllocator::InsertFreeRange(const std::uint32_t offset, const std::uint32_t size)
+    {
+        m_FreeByOffset.emplace(offset, size);
+        m_FreeBySize.emplace(size, offset);
+    }
+
+    void OffsetAllocator::RemoveFreeRange(std::map<std::uint32_t, std::uint32_t>::iterator range)
+    {
+        auto [first, last] = m_FreeBySize.equal_range(range->second);
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second == range->first)
+            {
+                m_FreeBySize.erase(it);
+                break;
+            }
+        }
+
+        m_FreeByOffset.erase(range);
+    }
+}
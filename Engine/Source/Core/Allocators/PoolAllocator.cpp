@@ -0,0 +1,185 @@
+#include "Core/Allocators/PoolAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include <algorithm>
+
+namespace QE
+{
+    PoolAllocator::PoolAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory, const std::size_t blockSize,
+        const std::size_t blockAlignment, const bool allowGrowth) noexcept
+        : AllocatorBase(sizeInBytes, addressOfAllocatedMemory), m_BlockSize(blockSize), m_BlockAlignment(std::max(blockAlignment, alignof(void*))),
+        m_AllowGrowth(allowGrowth)
+    {
+        QE_ASSERT(blockSize > 0 && is_power_of_two(blockAlignment));
+
+        // Every block has to be able to hold the free list pointer and keep the next block aligned
+        const std::size_t minimumSize = std::max(blockSize, sizeof(void*));
+        m_BlockStride = (minimumSize + m_BlockAlignment - 1) & ~(m_BlockAlignment - 1);
+
+        const std::size_t adjustment = align_forward_adjustment(addressOfAllocatedMemory, m_BlockAlignment);
+        m_BlocksPerPage = sizeInBytes > adjustment ? (sizeInBytes - adjustment) / m_BlockStride : 0;
+        QE_ASSERT(m_BlocksPerPage > 0);
+
+        // Only count the memory that can actually be handed out
+        m_TotalBytes = m_BlocksPerPage * m_BlockStride;
+        PushBlocks(ptr_add(addressOfAllocatedMemory, adjustment), m_BlocksPerPage);
+    }
+
+    PoolAllocator::PoolAllocator(PoolAllocator&& other) noexcept
+        : AllocatorBase(std::move(other)), m_BlockSize(other.m_BlockSize), m_BlockAlignment(other.m_BlockAlignment), m_BlockStride(other.m_BlockStride),
+        m_BlocksPerPage(other.m_BlocksPerPage), m_PageCount(other.m_PageCount), m_AllowGrowth(other.m_AllowGrowth),
+        m_FreeList(other.m_FreeList), m_GrownPages(other.m_GrownPages)
+    {
+        other.m_FreeList = nullptr;
+        other.m_GrownPages = nullptr;
+        other.m_PageCount = 0;
+    }
+
+    PoolAllocator& PoolAllocator::operator=(PoolAllocator&& rhs) noexcept
+    {
+        ReleaseGrownPages();
+        AllocatorBase::operator=(std::move(rhs));
+        m_BlockSize = rhs.m_BlockSize;
+        m_BlockAlignment = rhs.m_BlockAlignment;
+        m_BlockStride = rhs.m_BlockStride;
+        m_BlocksPerPage = rhs.m_BlocksPerPage;
+        m_PageCount = rhs.m_PageCount;
+        m_AllowGrowth = rhs.m_AllowGrowth;
+        m_FreeList = rhs.m_FreeList;
+        m_GrownPages = rhs.m_GrownPages;
+        rhs.m_FreeList = nullptr;
+        rhs.m_GrownPages = nullptr;
+        rhs.m_PageCount = 0;
+        return *this;
+    }
+
+    PoolAllocator::~PoolAllocator() noexcept
+    {
+        ReleaseGrownPages();
+    }
+
+    void* PoolAllocator::Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        QE_ASSERT(sizeInBytes <= m_BlockSize && alignment <= m_BlockAlignment);
+
+        if (!m_FreeList && !(m_AllowGrowth && AddPage()))
+        {
+            LOG_ERROR_TAG("PoolAllocator", "Out of blocks: {} blocks of {} bytes in use", m_NumAllocations, m_BlockSize);
+            return nullptr;
+        }
+
+        void* block = m_FreeList;
+        m_FreeList = *static_cast<void**>(block);
+
+        m_UsedBytes += m_BlockStride;
+        m_NumAllocations++;
+        m_TotalAllocations++;
+
+        return block;
+    }
+
+    void PoolAllocator::Free(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        *static_cast<void**>(ptr) = m_FreeList;
+        m_FreeList = ptr;
+
+        m_UsedBytes -= m_BlockStride;
+        m_NumAllocations--;
+    }
+
+    std::size_t PoolAllocator::GetBlockSize() const noexcept
+    {
+        return m_BlockSize;
+    }
+
+    std::size_t PoolAllocator::GetBlockAlignment() const noexcept
+    {
+        return m_BlockAlignment;
+    }
+
+    std::size_t PoolAllocator::GetPageCount() const noexcept
+    {
+        return m_PageCount;
+    }
+
+    void PoolAllocator::PushBlocks(void* const firstBlock, const std::size_t blockCount) noexcept
+    {
+        // Link back to front so blocks are handed out in address order
+        for (std::size_t i = blockCount; i > 0; i--)
+        {
+            void* block = ptr_add(firstBlock, (i - 1) * m_BlockStride);
+            *static_cast<void**>(block) = m_FreeList;
+            m_FreeList = block;
+        }
+    }
+
+    void PoolAllocator::ReleaseGrownPages() noexcept
+    {
+        void* page = m_GrownPages;
+        while (page)
+        {
+            void* next = *static_cast<void**>(page);
+            ::operator delete(page, std::align_val_t(m_BlockAlignment));
+            page = next;
+        }
+        m_GrownPages = nullptr;
+    }
+
+    bool PoolAllocator::AddPage()
+    {
+        // The first block of a grown page is reserved for the link to the next page
+        const std::size_t pageSize = (m_BlocksPerPage + 1) * m_BlockStride;
+        void* page = ::operator new(pageSize, std::align_val_t(m_BlockAlignment), std::nothrow);
+        if (!page)
+            return false;
+
+        *static_cast<void**>(page) = m_GrownPages;
+        m_GrownPages = page;
+        m_PageCount++;
+        m_TotalBytes += m_BlocksPerPage * m_BlockStride;
+
+        PushBlocks(ptr_add(page, m_BlockStride), m_BlocksPerPage);
+        LOG_DEBUG_TAG("PoolAllocator", "Grew pool to {} pages ({} blocks of {} bytes)", m_PageCount, m_PageCount * m_BlocksPerPage, m_BlockSize);
+        return true;
+    }
+
+    PoolMemoryResource::PoolMemoryResource(PoolAllocator& pool, std::pmr::memory_resource* upstream) noexcept
+        : m_Pool(&pool), m_Upstream(upstream)
+    {
+    }
+
+    void* PoolMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (FitsInPool(bytes, alignment))
+        {
+            if (void* block = m_Pool->Allocate(bytes, alignment))
+                return block;
+            throw std::bad_alloc();
+        }
+        return m_Upstream->allocate(bytes, alignment);
+    }
+
+    void PoolMemoryResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+    {
+        // pmr guarantees the same size and alignment as the allocation, so this routes to the same place
+        if (FitsInPool(bytes, alignment))
+            m_Pool->Free(ptr);
+        else
+            m_Upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool PoolMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    bool PoolMemoryResource::FitsInPool(std::size_t bytes, std::size_t alignment) const noexcept
+    {
+        return bytes <= m_Pool->GetBlockSize() && alignment <= m_Pool->GetBlockAlignment();
+    }
+}
@@ -0,0 +1,111 @@
+#include "Core/Allocators/StackAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include <algorithm>
+#include <utility>
+
+namespace QE
+{
+    StackAllocator::StackAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept
+        : AllocatorBase(sizeInBytes, addressOfAllocatedMemory), m_CurrentPtr(addressOfAllocatedMemory)
+    {
+    }
+
+    StackAllocator::StackAllocator(StackAllocator&& other) noexcept
+        : AllocatorBase(std::move(other)), m_CurrentPtr(other.m_CurrentPtr), m_LastAllocation(other.m_LastAllocation)
+    {
+        other.m_CurrentPtr = nullptr;
+        other.m_LastAllocation = nullptr;
+    }
+
+    StackAllocator& StackAllocator::operator=(StackAllocator&& rhs) noexcept
+    {
+        AllocatorBase::operator=(std::move(rhs));
+        m_CurrentPtr = rhs.m_CurrentPtr;
+        m_LastAllocation = rhs.m_LastAllocation;
+        rhs.m_CurrentPtr = nullptr;
+        rhs.m_LastAllocation = nullptr;
+        return *this;
+    }
+
+    StackAllocator::~StackAllocator() noexcept
+    {
+        StackAllocator::Clear();
+    }
+
+    void* StackAllocator::Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        QE_ASSERT(sizeInBytes > 0 && is_power_of_two(alignment));
+
+        const std::size_t headerAlignment = std::max<std::size_t>(alignment, alignof(StackAllocationHeader));
+        const std::size_t adjustment = align_forward_adjustment_with_header(m_CurrentPtr, headerAlignment, sizeof(StackAllocationHeader));
+
+        if (m_UsedBytes + adjustment + sizeInBytes > m_TotalBytes)
+        {
+            LOG_ERROR_TAG("StackAllocator", "Out of memory: requested {} bytes with {} of {} bytes used", sizeInBytes, m_UsedBytes, m_TotalBytes);
+            return nullptr;
+        }
+
+        void* alignedAddress = ptr_add(m_CurrentPtr, adjustment);
+
+        auto* header = static_cast<StackAllocationHeader*>(ptr_sub(alignedAddress, sizeof(StackAllocationHeader)));
+        header->PreviousTop = m_CurrentPtr;
+        header->PreviousAllocation = m_LastAllocation;
+
+        m_CurrentPtr = ptr_add(alignedAddress, sizeInBytes);
+        m_LastAllocation = alignedAddress;
+
+        m_UsedBytes += adjustment + sizeInBytes;
+        m_NumAllocations++;
+        m_TotalAllocations++;
+
+        return alignedAddress;
+    }
+
+    void StackAllocator::Free(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        QE_ASSERT(ptr == m_LastAllocation);
+
+        const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(ptr, sizeof(StackAllocationHeader)));
+        m_CurrentPtr = header->PreviousTop;
+        m_LastAllocation = header->PreviousAllocation;
+
+        m_UsedBytes = ptr_diff(m_StartPtr, m_CurrentPtr);
+        m_NumAllocations--;
+    }
+
+    StackMarker StackAllocator::GetMarker() const noexcept
+    {
+        return ptr_diff(m_StartPtr, m_CurrentPtr);
+    }
+
+    void StackAllocator::FreeToMarker(const StackMarker marker) noexcept
+    {
+        QE_ASSERT(marker <= m_UsedBytes);
+
+        // Walk the header chain so the allocation count stays exact
+        void* const markerPtr = ptr_add(m_StartPtr, marker);
+        while (m_LastAllocation && m_LastAllocation >= markerPtr)
+        {
+            const auto* header = static_cast<const StackAllocationHeader*>(ptr_sub(m_LastAllocation, sizeof(StackAllocationHeader)));
+            m_LastAllocation = header->PreviousAllocation;
+            m_NumAllocations--;
+        }
+
+        m_CurrentPtr = markerPtr;
+        m_UsedBytes = marker;
+    }
+
+    void StackAllocator::Clear() noexcept
+    {
+        m_CurrentPtr = m_StartPtr;
+        m_LastAllocation = nullptr;
+        m_UsedBytes = 0;
+        m_NumAllocations = 0;
+    }
+}
@@ -0,0 +1,496 @@
+#include "Core/Allocators/TLSFAllocator.h"
+#include "Core/Allocators/AllocatorUtility.h"
+
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace QE
+{
+    // One thread's cache of small free blocks for one allocator. Only that thread touches the bins, so caching
+    // takes no lock. The mutex orders the thread exiting against the allocator being destroyed
+    struct TLSFThreadCache
+    {
+        // Cleared when the allocator is destroyed, its blocks are then simply forgotten
+        std::atomic<TLSFAllocator*> Owner{ nullptr };
+        std::mutex Mutex;
+        std::array<TLSFAllocator::BlockHeader*, TLSFAllocator::THREAD_CACHE_BIN_COUNT> Bins{};
+        std::array<std::uint32_t, TLSFAllocator::THREAD_CACHE_BIN_COUNT> Counts{};
+        // Cache hits not yet added to the owner's total, added in batches so threads don't share a counter
+        std::uint32_t PendingAllocations = 0;
+
+        // Called when the thread exits, gives the blocks back and drops the cache from its allocator
+        void Release() noexcept
+        {
+            std::lock_guard lock(Mutex);
+            TLSFAllocator* owner = Owner.load(std::memory_order_acquire);
+            if (!owner)
+                return;
+
+            owner->FlushThreadCache(*this);
+            std::lock_guard ownerLock(owner->m_Mutex);
+            std::erase_if(owner->m_ThreadCaches, [this](const std::shared_ptr<TLSFThreadCache>& cache) { return cache.get() == this; });
+        }
+    };
+
+    namespace
+    {
+        constexpr std::size_t FREE_BIT = 1;
+        constexpr std::uint32_t PENDING_ALLOCATIONS_BATCH = 32;
+        // A thread that uses more allocators than this only caches for the first ones
+        constexpr std::size_t MAX_THREAD_CACHES = 8;
+
+        struct ThreadCacheSet
+        {
+            ~ThreadCacheSet()
+            {
+                for (std::shared_ptr<TLSFThreadCache>& cache : Caches)
+                {
+                    if (cache)
+                        cache->Release();
+                }
+            }
+
+            std::array<std::shared_ptr<TLSFThreadCache>, MAX_THREAD_CACHES> Caches;
+        };
+
+        thread_local ThreadCacheSet t_ThreadCaches;
+
+        std::size_t align_up(const std::size_t value, const std::size_t alignment) noexcept
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    TLSFAllocator::TLSFAllocator(const std::size_t sizeInBytes, void* const addressOfAllocatedMemory) noexcept
+        : AllocatorBase(sizeInBytes, addressOfAllocatedMemory), m_EndPtr(ptr_add(addressOfAllocatedMemory, sizeInBytes))
+    {
+        const std::size_t adjustment = align_forward_adjustment(addressOfAllocatedMemory, ALIGNMENT);
+        QE_ASSERT(sizeInBytes > adjustment + 2 * BLOCK_HEADER_SIZE + MIN_BLOCK_SIZE);
+
+        // One free block spanning the whole memory, followed by a zero sized used block so merging never runs off the end
+        const std::size_t blockSize = (sizeInBytes - adjustment - 2 * BLOCK_HEADER_SIZE) & ~(ALIGNMENT - 1);
+        QE_ASSERT(blockSize < MAX_BLOCK_SIZE);
+
+        auto* block = static_cast<BlockHeader*>(ptr_add(addressOfAllocatedMemory, adjustment));
+        block->PreviousPhysical = nullptr;
+        block->Size = blockSize | FREE_BIT;
+
+        auto* sentinel = static_cast<BlockHeader*>(ptr_add(block, BLOCK_HEADER_SIZE + blockSize));
+        sentinel->PreviousPhysical = block;
+        sentinel->Size = 0;
+
+        // Only count the memory that can actually be handed out
+        m_TotalBytes = blockSize;
+        InsertFreeBlock(block);
+    }
+
+    TLSFAllocator::~TLSFAllocator() noexcept
+    {
+        std::vector<std::shared_ptr<TLSFThreadCache>> caches;
+        {
+            std::lock_guard lock(m_Mutex);
+            caches.swap(m_ThreadCaches);
+        }
+
+        // Waits for threads that are exiting right now to finish flushing into this allocator
+        for (const std::shared_ptr<TLSFThreadCache>& cache : caches)
+        {
+            std::lock_guard lock(cache->Mutex);
+            cache->Owner.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    void* TLSFAllocator::Allocate(const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        QE_ASSERT(sizeInBytes > 0 && is_power_of_two(alignment));
+
+        if (sizeInBytes >= MAX_BLOCK_SIZE)
+        {
+            LOG_ERROR_TAG("TLSFAllocator", "Requested {} bytes, which is more than a single block can hold", sizeInBytes);
+            return nullptr;
+        }
+
+        const std::size_t size = align_up(std::max(sizeInBytes, MIN_BLOCK_SIZE), ALIGNMENT);
+        if (alignment <= ALIGNMENT && size <= THREAD_CACHE_MAX_SIZE)
+        {
+            TLSFThreadCache* cache = GetThreadCache();
+            const std::size_t bin = size / ALIGNMENT - 1;
+
+            if (cache && cache->Bins[bin])
+            {
+                BlockHeader* block = cache->Bins[bin];
+                cache->Bins[bin] = block->NextFree;
+                cache->Counts[bin]--;
+                if (++cache->PendingAllocations == PENDING_ALLOCATIONS_BATCH)
+                {
+                    std::atomic_ref(m_TotalAllocations).fetch_add(PENDING_ALLOCATIONS_BATCH, std::memory_order_relaxed);
+                    cache->PendingAllocations = 0;
+                }
+                return ptr_add(block, BLOCK_HEADER_SIZE);
+            }
+        }
+
+        return AllocateFromCore(size, alignment);
+    }
+
+    void TLSFAllocator::Free(void* const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        auto* block = static_cast<BlockHeader*>(ptr_sub(ptr, BLOCK_HEADER_SIZE));
+        QE_ASSERT(!(block->Size & FREE_BIT));
+
+        const std::size_t size = block->Size;
+        if (size <= THREAD_CACHE_MAX_SIZE)
+        {
+            TLSFThreadCache* cache = GetThreadCache();
+            const std::size_t bin = size / ALIGNMENT - 1;
+
+            if (cache && cache->Counts[bin] < THREAD_CACHE_BIN_CAPACITY)
+            {
+                block->NextFree = cache->Bins[bin];
+                cache->Bins[bin] = block;
+                cache->Counts[bin]++;
+                return;
+            }
+        }
+
+        FreeToCore(block);
+    }
+
+    void* TLSFAllocator::Reallocate(void* const ptr, const std::size_t sizeInBytes, const std::uintptr_t alignment)
+    {
+        if (!ptr)
+            return Allocate(sizeInBytes, alignment);
+
+        if (sizeInBytes == 0)
+        {
+            Free(ptr);
+            return nullptr;
+        }
+
+        auto* block = static_cast<BlockHeader*>(ptr_sub(ptr, BLOCK_HEADER_SIZE));
+        const std::size_t currentSize = block->Size;
+        const std::size_t size = align_up(std::max(sizeInBytes, MIN_BLOCK_SIZE), ALIGNMENT);
+
+        {
+            std::lock_guard lock(m_Mutex);
+
+            if (size <= currentSize)
+            {
+                TrimUsedBlock(block, size);
+                std::atomic_ref(m_UsedBytes).fetch_sub(currentSize - block->Size, std::memory_order_relaxed);
+                return ptr;
+            }
+
+            // Grow into the next block if it is free and big enough
+            auto* next = static_cast<BlockHeader*>(ptr_add(ptr, currentSize));
+            if ((next->Size & FREE_BIT) && currentSize + BLOCK_HEADER_SIZE + (next->Size & ~FREE_BIT) >= size)
+            {
+                RemoveFreeBlock(next);
+                block->Size = currentSize + BLOCK_HEADER_SIZE + (next->Size & ~FREE_BIT);
+                static_cast<BlockHeader*>(ptr_add(ptr, block->Size))->PreviousPhysical = block;
+
+                TrimUsedBlock(block, size);
+                std::atomic_ref(m_UsedBytes).fetch_add(block->Size - currentSize, std::memory_order_relaxed);
+                return ptr;
+            }
+        }
+
+        void* newPtr = Allocate(sizeInBytes, alignment);
+        if (!newPtr)
+            return nullptr;
+
+        std::memcpy(newPtr, ptr, std::min(currentSize, sizeInBytes));
+        Free(ptr);
+        return newPtr;
+    }
+
+    bool TLSFAllocator::Owns(const void* const ptr) const noexcept
+    {
+        return ptr >= m_StartPtr && ptr < m_EndPtr;
+    }
+
+    std::size_t TLSFAllocator::GetAllocationSize(const void* const ptr) const noexcept
+    {
+        return ptr ? static_cast<const BlockHeader*>(ptr_sub(ptr, BLOCK_HEADER_SIZE))->Size : 0;
+    }
+
+    std::size_t TLSFAllocator::GetLargestFreeBlock() noexcept
+    {
+        std::lock_guard lock(m_Mutex);
+        if (!m_FLBitmap)
+            return 0;
+
+        // The largest block is somewhere in the highest non empty bin
+        const std::uint32_t firstLevel = 31 - std::countl_zero(m_FLBitmap);
+        const std::uint32_t secondLevel = 31 - std::countl_zero(m_SLBitmaps[firstLevel]);
+
+        std::size_t largest = 0;
+        for (const BlockHeader* block = m_FreeBlocks[firstLevel][secondLevel]; block; block = block->NextFree)
+            largest = std::max(largest, block->Size & ~FREE_BIT);
+        return largest;
+    }
+
+    void TLSFAllocator::FlushThreadCaches() noexcept
+    {
+        for (const std::shared_ptr<TLSFThreadCache>& cache : t_ThreadCaches.Caches)
+        {
+            if (cache && cache->Owner.load(std::memory_order_relaxed) == this)
+                FlushThreadCache(*cache);
+        }
+    }
+
+    TLSFThreadCache* TLSFAllocator::GetThreadCache()
+    {
+        for (const std::shared_ptr<TLSFThreadCache>& cache : t_ThreadCaches.Caches)
+        {
+            if (cache && cache->Owner.load(std::memory_order_relaxed) == this)
+                return cache.get();
+        }
+
+        return CreateThreadCache();
+    }
+
+    TLSFThreadCache* TLSFAllocator::CreateThreadCache()
+    {
+        // Reuse the slot of an allocator that has been destroyed since
+        for (std::shared_ptr<TLSFThreadCache>& slot : t_ThreadCaches.Caches)
+        {
+            if (slot && slot->Owner.load(std::memory_order_acquire))
+                continue;
+
+            slot = std::make_shared<TLSFThreadCache>();
+            slot->Owner.store(this, std::memory_order_relaxed);
+
+            std::lock_guard lock(m_Mutex);
+            m_ThreadCaches.push_back(slot);
+            return slot.get();
+        }
+
+        return nullptr;
+    }
+
+    void TLSFAllocator::FlushThreadCache(TLSFThreadCache& cache) noexcept
+    {
+        for (std::size_t bin = 0; bin < THREAD_CACHE_BIN_COUNT; bin++)
+        {
+            BlockHeader* block = std::exchange(cache.Bins[bin], nullptr);
+            cache.Counts[bin] = 0;
+            while (block)
+            {
+                BlockHeader* next = block->NextFree;
+                FreeToCore(block);
+                block = next;
+            }
+        }
+
+        std::atomic_ref(m_TotalAllocations).fetch_add(std::exchange(cache.PendingAllocations, 0), std::memory_order_relaxed);
+    }
+
+    void TLSFAllocator::MapSize(const std::size_t size, std::uint32_t& firstLevel, std::uint32_t& secondLevel) noexcept
+    {
+        if (size < SMALL_BLOCK_SIZE)
+        {
+            // Small sizes get a linear mapping inside the first bin
+            firstLevel = 0;
+            secondLevel = static_cast<std::uint32_t>(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+        }
+        else
+        {
+            const std::uint32_t fls = static_cast<std::uint32_t>(std::bit_width(size)) - 1;
+            secondLevel = static_cast<std::uint32_t>(size >> (fls - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+            firstLevel = fls - (FL_INDEX_SHIFT - 1);
+        }
+    }
+
+    void* TLSFAllocator::AllocateFromCore(const std::size_t size, const std::size_t alignment)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        // Over aligned requests ask for enough slack to split a free block off the front
+        const bool overAligned = alignment > ALIGNMENT;
+        const std::size_t searchSize = overAligned ? size + alignment + sizeof(BlockHeader) : size;
+
+        BlockHeader* block = FindFreeBlock(searchSize);
+        if (!block)
+        {
+            LOG_ERROR_TAG("TLSFAllocator", "Out of memory: requested {} bytes with {} of {} bytes used", size, m_UsedBytes, m_TotalBytes);
+            return nullptr;
+        }
+        RemoveFreeBlock(block);
+
+        if (overAligned)
+        {
+            void* payload = ptr_add(block, BLOCK_HEADER_SIZE);
+            std::size_t gap = align_forward_adjustment(payload, alignment);
+            if (gap != 0 && gap < sizeof(BlockHeader))
+                gap = sizeof(BlockHeader) + align_forward_adjustment(ptr_add(payload, sizeof(BlockHeader)), alignment);
+
+            if (gap != 0)
+            {
+                // The front of the block stays free, it can't merge backwards because free blocks never touch
+                auto* aligned = static_cast<BlockHeader*>(ptr_add(payload, gap - BLOCK_HEADER_SIZE));
+                aligned->PreviousPhysical = block;
+                aligned->Size = (block->Size & ~FREE_BIT) - gap;
+                static_cast<BlockHeader*>(ptr_add(aligned, BLOCK_HEADER_SIZE + aligned->Size))->PreviousPhysical = aligned;
+
+                block->Size = (gap - BLOCK_HEADER_SIZE) | FREE_BIT;
+                InsertFreeBlock(block);
+                block = aligned;
+            }
+        }
+
+        block->Size &= ~FREE_BIT;
+        TrimUsedBlock(block, size);
+
+        // The stats are only written under the lock, but read without it
+        std::atomic_ref(m_UsedBytes).fetch_add(block->Size, std::memory_order_relaxed);
+        std::atomic_ref(m_NumAllocations).fetch_add(1, std::memory_order_relaxed);
+        std::atomic_ref(m_TotalAllocations).fetch_add(1, std::memory_order_relaxed);
+
+        return ptr_add(block, BLOCK_HEADER_SIZE);
+    }
+
+    void TLSFAllocator::FreeToCore(BlockHeader* block) noexcept
+    {
+        std::lock_guard lock(m_Mutex);
+
+        std::atomic_ref(m_UsedBytes).fetch_sub(block->Size, std::memory_order_relaxed);
+        std::atomic_ref(m_NumAllocations).fetch_sub(1, std::memory_order_relaxed);
+
+        block->Size |= FREE_BIT;
+        InsertFreeBlock(MergeWithNeighbours(block));
+    }
+
+    void TLSFAllocator::InsertFreeBlock(BlockHeader* block) noexcept
+    {
+        std::uint32_t firstLevel, secondLevel;
+        MapSize(block->Size & ~FREE_BIT, firstLevel, secondLevel);
+
+        BlockHeader*& head = m_FreeBlocks[firstLevel][secondLevel];
+        block->NextFree = head;
+        block->PreviousFree = nullptr;
+        if (head)
+            head->PreviousFree = block;
+        head = block;
+
+        m_FLBitmap |= 1u << firstLevel;
+        m_SLBitmaps[firstLevel] |= 1u << secondLevel;
+    }
+
+    void TLSFAllocator::RemoveFreeBlock(BlockHeader* block) noexcept
+    {
+        std::uint32_t firstLevel, secondLevel;
+        MapSize(block->Size & ~FREE_BIT, firstLevel, secondLevel);
+
+        if (block->NextFree)
+            block->NextFree->PreviousFree = block->PreviousFree;
+        if (block->PreviousFree)
+        {
+            block->PreviousFree->NextFree = block->NextFree;
+            return;
+        }
+
+        BlockHeader*& head = m_FreeBlocks[firstLevel][secondLevel];
+        head = block->NextFree;
+        if (!head)
+        {
+            m_SLBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (!m_SLBitmaps[firstLevel])
+                m_FLBitmap &= ~(1u << firstLevel);
+        }
+    }
+
+    TLSFAllocator::BlockHeader* TLSFAllocator::FindFreeBlock(std::size_t size) noexcept
+    {
+        // Round up to the next bin so any block found there is big enough
+        if (size >= SMALL_BLOCK_SIZE)
+            size += (std::size_t(1) << (std::bit_width(size) - 1 - SL_INDEX_COUNT_LOG2)) - 1;
+
+        std::uint32_t firstLevel, secondLevel;
+        MapSize(size, firstLevel, secondLevel);
+        if (firstLevel >= FL_INDEX_COUNT)
+            return nullptr;
+
+        std::uint32_t slMap = m_SLBitmaps[firstLevel] & (~0u << secondLevel);
+        if (!slMap)
+        {
+            const std::uint32_t flMap = m_FLBitmap & (~0u << (firstLevel + 1));
+            if (!flMap)
+                return nullptr;
+
+            firstLevel = std::countr_zero(flMap);
+            slMap = m_SLBitmaps[firstLevel];
+        }
+
+        return m_FreeBlocks[firstLevel][std::countr_zero(slMap)];
+    }
+
+    void TLSFAllocator::TrimUsedBlock(BlockHeader* block, const std::size_t size) noexcept
+    {
+        const std::size_t blockSize = block->Size;
+        if (blockSize < size + sizeof(BlockHeader))
+            return;
+
+        auto* remainder = static_cast<BlockHeader*>(ptr_add(block, BLOCK_HEADER_SIZE + size));
+        remainder->PreviousPhysical = block;
+        remainder->Size = (blockSize - size - BLOCK_HEADER_SIZE) | FREE_BIT;
+        static_cast<BlockHeader*>(ptr_add(remainder, BLOCK_HEADER_SIZE + (remainder->Size & ~FREE_BIT)))->PreviousPhysical = remainder;
+        block->Size = size;
+
+        InsertFreeBlock(MergeWithNeighbours(remainder));
+    }
+
+    TLSFAllocator::BlockHeader* TLSFAllocator::MergeWithNeighbours(BlockHeader* block) noexcept
+    {
+        BlockHeader* previous = block->PreviousPhysical;
+        if (previous && (previous->Size & FREE_BIT))
+        {
+            RemoveFreeBlock(previous);
+            previous->Size += BLOCK_HEADER_SIZE + (block->Size & ~FREE_BIT);
+            block = previous;
+        }
+
+        auto* next = static_cast<BlockHeader*>(ptr_add(block, BLOCK_HEADER_SIZE + (block->Size & ~FREE_BIT)));
+        if (next->Size & FREE_BIT)
+        {
+            RemoveFreeBlock(next);
+            block->Size += BLOCK_HEADER_SIZE + (next->Size & ~FREE_BIT);
+            next = static_cast<BlockHeader*>(ptr_add(block, BLOCK_HEADER_SIZE + (block->Size & ~FREE_BIT)));
+        }
+
+        next->PreviousPhysical = block;
+        return block;
+    }
+
+    TLSFMemoryResource::TLSFMemoryResource(TLSFAllocator& allocator, std::pmr::memory_resource* upstream) noexcept
+        : m_Allocator(&allocator), m_Upstream(upstream)
+    {
+    }
+
+    void* TLSFMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        if (void* ptr = m_Allocator->Allocate(std::max<std::size_t>(bytes, 1), alignment))
+            return ptr;
+        return m_Upstream->allocate(bytes, alignment);
+    }
+
+    void TLSFMemoryResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+    {
+        if (m_Allocator->Owns(ptr))
+            m_Allocator->Free(ptr);
+        else
+            m_Upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool TLSFMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+}
@@ -5,6 +5,7 @@ namespace QE
     static EventManager g_EventManager{};
 
     EventManager::EventManager()
+        : m_EventMemory(std::make_unique_for_overwrite<std::byte[]>(EVENT_QUEUE_SIZE)), m_EventAllocator(EVENT_QUEUE_SIZE, m_EventMemory.get(), EVENT_BLOCK_SIZE, EVENT_BLOCK_ALIGNMENT, true)
     {
         m_EventQueue.reserve(1000);
     }
@@ -26,9 +27,12 @@ namespace QE
     void EventManager::Flush()
     {
         //LOG_DEBUG("Flushing events with size: {}", m_EventQueue.size());
-        for (auto& event : m_EventQueue)
+        // Callbacks may queue more events, they are appended and fired in order in this flush
+        for (std::size_t i = 0; i < m_EventQueue.size(); i++)
         {
+            EventBase* event = m_EventQueue[i];
             FireEvent(*event);
+            m_EventAllocator.Delete(event);
         }
         m_EventQueue.clear();
     }
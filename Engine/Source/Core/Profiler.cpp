@@ -0,0 +1,349 @@
+#include "Core/Profiler.h"
+
+#include "imgui.h"
+#include <algorithm>
+#include <cfloat>
+#include <format>
+#include <functional>
+#include <map>
+#include <glaze/glaze.hpp>
+
+namespace QE
+{
+    // The global profiler
+    static Profiler g_Profiler;
+
+    namespace
+    {
+        // Trace event format, field names are the keys chrome://tracing expects
+        struct TraceEvent
+        {
+            std::string name;
+            std::string cat;
+            std::string ph; // X for complete events, M for metadata
+            double ts = 0.0; // microseconds
+            double dur = 0.0;
+            std::uint32_t pid = 0;
+            std::uint32_t tid = 0;
+            std::map<std::string, std::string> args;
+        };
+
+        struct Trace
+        {
+            std::vector<TraceEvent> traceEvents;
+            std::string displayTimeUnit = "ms";
+        };
+
+        constexpr std::uint32_t CPU_THREAD = 0;
+        constexpr std::uint32_t GPU_THREAD = 1;
+
+        TraceEvent BuildThreadName(std::uint32_t thread, const char* name)
+        {
+            TraceEvent event;
+            event.name = "thread_name";
+            event.ph = "M";
+            event.tid = thread;
+            event.args["name"] = name;
+            return event;
+        }
+
+        TraceEvent BuildEvent(const std::string& name, const char* category, std::uint32_t thread, double startMs, double durationMs)
+        {
+            TraceEvent event;
+            event.name = name;
+            event.cat = category;
+            event.ph = "X";
+            event.ts = startMs * 1000.0;
+            event.dur = durationMs * 1000.0;
+            event.tid = thread;
+            return event;
+        }
+
+        void AddStatistics(TraceEvent& event, const ProfileZone& zone)
+        {
+            if (!zone.HasStatistics)
+                return;
+
+            event.args["Input primitives"] = std::to_string(zone.Statistics.InputPrimitives);
+            event.args["Vertex invocations"] = std::to_string(zone.Statistics.VertexInvocations);
+            event.args["Clipping primitives"] = std::to_string(zone.Statistics.ClippingPrimitives);
+            event.args["Fragment invocations"] = std::to_string(zone.Statistics.FragmentInvocations);
+            event.args["Compute invocations"] = std::to_string(zone.Statistics.ComputeInvocations);
+        }
+
+        // Same name, same color, in every frame and lane
+        ImU32 GetZoneColor(const std::string& name)
+        {
+            const float hue = static_cast<float>(std::hash<std::string>{}(name) % 360) / 360.0f;
+            float r, g, b;
+            ImGui::ColorConvertHSVtoRGB(hue, 0.5f, 0.75f, r, g, b);
+            return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+        }
+
+        struct TimelineView
+        {
+            ImDrawList* DrawList;
+            ImVec2 Origin;
+            float Width;
+            float RowHeight;
+            double StartMs;
+            double PixelsPerMs;
+        };
+
+        void DrawZoneBar(const TimelineView& view, std::uint32_t row, double startMs, double durationMs, const std::string& name, const ProfileZone* zone)
+        {
+            const float left = std::max(0.0f, static_cast<float>((startMs - view.StartMs) * view.PixelsPerMs));
+            const float right = std::min(view.Width, static_cast<float>((startMs + durationMs - view.StartMs) * view.PixelsPerMs));
+            if (right <= 0.0f || left >= view.Width)
+                return;
+
+            const ImVec2 min(view.Origin.x + left, view.Origin.y + row * view.RowHeight);
+            const ImVec2 max(view.Origin.x + std::max(right, left + 1.0f), min.y + view.RowHeight - 1.0f);
+            view.DrawList->AddRectFilled(min, max, GetZoneColor(name));
+
+            // Labels only where they fit
+            const ImVec2 textSize = ImGui::CalcTextSize(name.c_str());
+            if (textSize.x + 4.0f < max.x - min.x)
+                view.DrawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), name.c_str());
+
+            if (!ImGui::IsMouseHoveringRect(min, max))
+                return;
+
+            ImGui::BeginTooltip();
+            ImGui::Text("%s: %.3f ms", name.c_str(), durationMs);
+            if (zone && zone->HasStatistics)
+            {
+                ImGui::Text("Input primitives: %llu", static_cast<unsigned long long>(zone->Statistics.InputPrimitives));
+                ImGui::Text("Vertex invocations: %llu", static_cast<unsigned long long>(zone->Statistics.VertexInvocations));
+                ImGui::Text("Clipping primitives: %llu", static_cast<unsigned long long>(zone->Statistics.ClippingPrimitives));
+                ImGui::Text("Fragment invocations: %llu", static_cast<unsigned long long>(zone->Statistics.FragmentInvocations));
+                ImGui::Text("Compute invocations: %llu", static_cast<unsigned long long>(zone->Statistics.ComputeInvocations));
+            }
+            ImGui::EndTooltip();
+        }
+
+        // Frame on the top row, its zones below by depth
+        void DrawFrame(const TimelineView& view, std::uint32_t frame, double startMs, double durationMs, const std::vector<ProfileZone>& zones)
+        {
+            DrawZoneBar(view, 0, startMs, durationMs, std::format("Frame {}", frame), nullptr);
+            for (const ProfileZone& zone : zones)
+                DrawZoneBar(view, zone.Depth + 1, startMs + zone.StartMs, zone.DurationMs, zone.Name, &zone);
+        }
+
+        template<typename FrameType>
+        std::uint32_t GetLaneRows(const std::deque<FrameType>& frames)
+        {
+            std::uint32_t rows = 1;
+            for (const FrameType& frame : frames)
+            {
+                for (const ProfileZone& zone : frame.Zones)
+                    rows = std::max(rows, zone.Depth + 2);
+            }
+            return rows;
+        }
+    }
+
+    Profiler::Profiler()
+        : m_Epoch(ProfilerClock::now())
+    {
+    }
+
+    void Profiler::BeginFrame(std::uint32_t frame)
+    {
+        m_FrameThread = std::this_thread::get_id();
+        m_InFrame = !m_Paused;
+        m_OpenZones.clear();
+
+        m_CurrentFrame = {};
+        m_CurrentFrame.Frame = frame;
+        m_CurrentFrame.StartMs = GetTimeMs();
+    }
+
+    void Profiler::EndFrame()
+    {
+        if (!m_InFrame)
+            return;
+
+        // Zones still open are cut off at the end of the frame
+        while (!m_OpenZones.empty())
+            EndCpuZone();
+
+        m_CurrentFrame.DurationMs = GetTimeMs() - m_CurrentFrame.StartMs;
+        m_CpuFrames.push_back(std::move(m_CurrentFrame));
+        if (m_CpuFrames.size() > HISTORY_FRAMES)
+            m_CpuFrames.pop_front();
+
+        m_InFrame = false;
+    }
+
+    bool Profiler::BeginCpuZone(std::string_view name)
+    {
+        if (!m_InFrame || std::this_thread::get_id() != m_FrameThread)
+            return false;
+
+        ProfileZone& zone = m_CurrentFrame.Zones.emplace_back();
+        zone.Name = name;
+        zone.Depth = static_cast<std::uint32_t>(m_OpenZones.size());
+        zone.StartMs = GetTimeMs() - m_CurrentFrame.StartMs;
+
+        m_OpenZones.push_back(static_cast<std::uint32_t>(m_CurrentFrame.Zones.size() - 1));
+        return true;
+    }
+
+    void Profiler::EndCpuZone()
+    {
+        if (!m_InFrame || m_OpenZones.empty())
+            return;
+
+        ProfileZone& zone = m_CurrentFrame.Zones[m_OpenZones.back()];
+        zone.DurationMs = GetTimeMs() - m_CurrentFrame.StartMs - zone.StartMs;
+        m_OpenZones.pop_back();
+    }
+
+    void Profiler::AddGpuFrame(const GpuFrameProfile& frame)
+    {
+        if (m_Paused || frame.Frame == UINT32_MAX)
+            return;
+        if (!m_GpuFrames.empty() && frame.Frame <= m_GpuFrames.back().Frame)
+            return;
+
+        // A frame cannot start on the GPU before it was submitted, the smallest offset that keeps every frame
+        // after its submission is the closest the two clocks can be lined up without calibrated timestamps
+        const double submitMs = std::chrono::duration<double, std::milli>(frame.SubmitTime - m_Epoch).count();
+        const double offset = submitMs - frame.StartMs;
+        if (!m_HasGpuClockOffset || offset > m_GpuClockOffsetMs)
+        {
+            m_GpuClockOffsetMs = offset;
+            m_HasGpuClockOffset = true;
+        }
+
+        m_GpuFrames.push_back(frame);
+        if (m_GpuFrames.size() > HISTORY_FRAMES)
+            m_GpuFrames.pop_front();
+    }
+
+    bool Profiler::ExportChromeTrace(const std::string& path) const
+    {
+        Trace trace;
+        trace.traceEvents.push_back(BuildThreadName(CPU_THREAD, "CPU"));
+        trace.traceEvents.push_back(BuildThreadName(GPU_THREAD, "GPU"));
+
+        for (const CpuFrameProfile& frame : m_CpuFrames)
+        {
+            trace.traceEvents.push_back(BuildEvent(std::format("Frame {}", frame.Frame), "CPU", CPU_THREAD, frame.StartMs, frame.DurationMs));
+            for (const ProfileZone& zone : frame.Zones)
+                trace.traceEvents.push_back(BuildEvent(zone.Name, "CPU", CPU_THREAD, frame.StartMs + zone.StartMs, zone.DurationMs));
+        }
+
+        for (const GpuFrameProfile& frame : m_GpuFrames)
+        {
+            const double frameStartMs = GetGpuFrameStartMs(frame);
+            trace.traceEvents.push_back(BuildEvent(std::format("Frame {}", frame.Frame), "GPU", GPU_THREAD, frameStartMs, frame.DurationMs));
+            for (const ProfileZone& zone : frame.Zones)
+            {
+                TraceEvent& event = trace.traceEvents.emplace_back(BuildEvent(zone.Name, "GPU", GPU_THREAD, frameStartMs + zone.StartMs, zone.DurationMs));
+                AddStatistics(event, zone);
+            }
+        }
+
+        if (auto error = glz::write_file_json(trace, path, std::string{}))
+        {
+            LOG_ERROR_TAG("Profiler", "Failed to write trace to {}: {}", path, glz::format_error(error));
+            return false;
+        }
+
+        LOG_INFO_TAG("Profiler", "Trace of {} CPU and {} GPU frames written to {}", m_CpuFrames.size(), m_GpuFrames.size(), path);
+        return true;
+    }
+
+    void Profiler::DrawDebugInfo()
+    {
+        ImGui::Begin("Profiler");
+
+        ImGui::Checkbox("Pause", &m_Paused);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace"))
+            ExportChromeTrace("ProfilerTrace.json");
+        ImGui::SliderFloat("Range (ms)", &m_TimelineRangeMs, 10.0f, 250.0f, "%.0f");
+
+        // Frame times over the history
+        std::vector<float> cpuTimes;
+        std::vector<float> gpuTimes;
+        for (const CpuFrameProfile& frame : m_CpuFrames)
+            cpuTimes.push_back(static_cast<float>(frame.DurationMs));
+        for (const GpuFrameProfile& frame : m_GpuFrames)
+            gpuTimes.push_back(static_cast<float>(frame.DurationMs));
+
+        const std::string cpuLabel = cpuTimes.empty() ? std::string() : std::format("{:.2f} ms", cpuTimes.back());
+        const std::string gpuLabel = gpuTimes.empty() ? std::string() : std::format("{:.2f} ms", gpuTimes.back());
+        ImGui::PlotLines("CPU", cpuTimes.data(), static_cast<int>(cpuTimes.size()), 0, cpuLabel.c_str(), 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+        ImGui::PlotLines("GPU", gpuTimes.data(), static_cast<int>(gpuTimes.size()), 0, gpuLabel.c_str(), 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+
+        // Rolling timeline ending with the last CPU frame, GPU frames trail behind by the frames in flight
+        if (!m_CpuFrames.empty())
+        {
+            const CpuFrameProfile& lastFrame = m_CpuFrames.back();
+            const double endMs = lastFrame.StartMs + lastFrame.DurationMs;
+            const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+            const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+            const std::uint32_t cpuRows = GetLaneRows(m_CpuFrames);
+            const std::uint32_t gpuRows = GetLaneRows(m_GpuFrames);
+
+            TimelineView view = { ImGui::GetWindowDrawList(), {}, width, rowHeight, endMs - m_TimelineRangeMs, width / m_TimelineRangeMs };
+
+            ImGui::TextUnformatted("CPU");
+            view.Origin = ImGui::GetCursorScreenPos();
+            for (const CpuFrameProfile& frame : m_CpuFrames)
+                DrawFrame(view, frame.Frame, frame.StartMs, frame.DurationMs, frame.Zones);
+            ImGui::Dummy(ImVec2(width, cpuRows * rowHeight));
+
+            ImGui::TextUnformatted("GPU");
+            view.Origin = ImGui::GetCursorScreenPos();
+            for (const GpuFrameProfile& frame : m_GpuFrames)
+                DrawFrame(view, frame.Frame, GetGpuFrameStartMs(frame), frame.DurationMs, frame.Zones);
+            ImGui::Dummy(ImVec2(width, gpuRows * rowHeight));
+        }
+
+        // Zones of the last frame the GPU finished
+        if (!m_GpuFrames.empty() && ImGui::BeginTable("GpuZones", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("GPU zone");
+            ImGui::TableSetupColumn("ms");
+            ImGui::TableSetupColumn("Primitives");
+            ImGui::TableSetupColumn("Fragments");
+            ImGui::TableSetupColumn("Compute");
+            ImGui::TableHeadersRow();
+
+            for (const ProfileZone& zone : m_GpuFrames.back().Zones)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", static_cast<int>(zone.Depth * 2), "", zone.Name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.DurationMs);
+                if (!zone.HasStatistics)
+                    continue;
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(zone.Statistics.ClippingPrimitives));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(zone.Statistics.FragmentInvocations));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(zone.Statistics.ComputeInvocations));
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
+    double Profiler::GetTimeMs() const
+    {
+        return std::chrono::duration<double, std::milli>(ProfilerClock::now() - m_Epoch).count();
+    }
+
+    Profiler* GetGlobalProfiler()
+    {
+        return &g_Profiler;
+    }
+}
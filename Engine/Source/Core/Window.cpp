@@ -1,6 +1,7 @@
 #include "Core/Window.h"
 
 #include "Platform/GLFW/GLFW_Window.h"
+#include "Platform/Headless/HeadlessWindow.h"
 
 namespace QE
 {
@@ -16,4 +17,9 @@ namespace QE
 	{
 		return std::make_unique<GLFW_Window>(windowName, width, height);
 	}
+
+	std::unique_ptr<Window> CreateHeadlessWindowFactory(std::string_view windowName, int width, int height)
+	{
+		return std::make_unique<HeadlessWindow>(windowName, width, height);
+	}
 }
\ No newline at end of file
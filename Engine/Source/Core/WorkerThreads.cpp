@@ -0,0 +1,97 @@
+#include "Core/WorkerThreads.h"
+
+#include <algorithm>
+
+namespace QE
+{
+    WorkerThreads::~WorkerThreads()
+    {
+        Stop();
+    }
+
+    void WorkerThreads::Start(std::uint32_t workerCount)
+    {
+        m_WorkerCount = std::clamp(workerCount, 1u, MAX_WORKERS);
+        m_ActiveWorkers = m_WorkerCount;
+
+        m_Stopping = false;
+        for (std::uint32_t worker = 1; worker < m_WorkerCount; worker++)
+            m_Threads.emplace_back(&WorkerThreads::WorkerLoop, this, worker);
+    }
+
+    void WorkerThreads::Stop()
+    {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_StartCondition.notify_all();
+        for (std::thread& thread : m_Threads)
+            thread.join();
+        m_Threads.clear();
+    }
+
+    void WorkerThreads::SetActiveWorkers(std::uint32_t count)
+    {
+        m_ActiveWorkers = std::clamp(count, 1u, m_WorkerCount);
+    }
+
+    void WorkerThreads::Run(std::uint32_t jobCount, const JobFunction& job)
+    {
+        if (jobCount == 0)
+            return;
+
+        const std::uint32_t passWorkers = std::min(jobCount, m_ActiveWorkers);
+        const std::uint32_t helpers = passWorkers - 1;
+        {
+            std::lock_guard lock(m_Mutex);
+            m_JobCount = jobCount;
+            m_PassWorkers = passWorkers;
+            m_Job = &job;
+            m_BusyWorkers = helpers;
+            m_Generation++;
+        }
+
+        // A single job runs here without waking anyone
+        if (helpers > 0)
+            m_StartCondition.notify_all();
+
+        RunJobs(0);
+
+        std::unique_lock lock(m_Mutex);
+        m_DoneCondition.wait(lock, [this]() { return m_BusyWorkers == 0; });
+        m_Job = nullptr;
+    }
+
+    void WorkerThreads::WorkerLoop(std::uint32_t worker)
+    {
+        std::uint64_t generation = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock lock(m_Mutex);
+                m_StartCondition.wait(lock, [&]() { return m_Stopping || m_Generation != generation; });
+                if (m_Stopping)
+                    return;
+
+                generation = m_Generation;
+
+                // Passes with fewer jobs than workers leave the last workers idle
+                if (worker >= m_PassWorkers)
+                    continue;
+            }
+
+            RunJobs(worker);
+
+            std::lock_guard lock(m_Mutex);
+            if (--m_BusyWorkers == 0)
+                m_DoneCondition.notify_one();
+        }
+    }
+
+    void WorkerThreads::RunJobs(std::uint32_t worker)
+    {
+        for (std::uint32_t job = worker; job < m_JobCount; job += m_PassWorkers)
+            (*m_Job)(worker, job);
+    }
+}
@@ -3,12 +3,70 @@
 #include "imgui.h"
 #include "Platform/PlatformUtility.h"
 #include "Core/Events/EventManager.h"
+#include "Core/Profiler.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <string_view>
 
 namespace QE
 {
 	// The global engine
 	Engine g_Engine{};
 
+	// Size of each of the two frame allocator buffers
+	constexpr std::size_t FRAME_ALLOCATOR_SIZE = 8 * 1024 * 1024;
+	// Size of the block shared by level data and asset load scratch
+	constexpr std::size_t LEVEL_ALLOCATOR_SIZE = 64 * 1024 * 1024;
+	// Size of the game's general purpose heap
+	constexpr std::size_t GAME_ALLOCATOR_SIZE = 64 * 1024 * 1024;
+
+	static bool ParseUInt(std::string_view text, std::uint32_t& value)
+	{
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return error == std::errc() && end == text.data() + text.size();
+	}
+
+	EngineConfig EngineConfig::FromCommandLine(int argc, char** argv)
+	{
+		EngineConfig config;
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string_view argument = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (argument == "--")
+			{
+				config.GameArguments.assign(argv + i + 1, argv + argc);
+				break;
+			}
+
+			bool valid = true;
+			if (argument == "--headless")
+				config.Headless = true;
+			else if (argument == "--frames" && hasValue)
+				valid = ParseUInt(argv[++i], config.FrameCount);
+			else if (argument == "--width" && hasValue)
+				valid = ParseUInt(argv[++i], config.Width) && config.Width > 0;
+			else if (argument == "--height" && hasValue)
+				valid = ParseUInt(argv[++i], config.Height) && config.Height > 0;
+			else if (argument == "--capture" && hasValue)
+				config.CaptureFolder = argv[++i];
+			else if (argument == "--capture-interval" && hasValue)
+				valid = ParseUInt(argv[++i], config.CaptureInterval);
+			else
+				LOG_WARN_TAG("Engine", "Ignoring unknown command line argument {}", argument);
+
+			if (!valid)
+				LOG_WARN_TAG("Engine", "Invalid value {} for {}", argv[i], argument);
+		}
+
+		return config;
+	}
+
 	Engine::Engine()
 		: m_GameApplication(nullptr)
 	{
@@ -22,17 +80,41 @@ namespace QE
 
 	Engine::~Engine()
 	{
+		m_GameMemoryResource.reset();
+		m_GameAllocator.reset();
+		std::free(m_GameMemory);
 	}
 
-	void Engine::Initialize()
+	void Engine::Initialize(const EngineConfig& config)
 	{
+		m_Config = config;
+
 		// Create Window
 		//m_Window = CreateWindowFactory("Quest Engine", 3840, 2160);
-		m_Window = CreateWindowFactory("Quest Engine", 2560, 1440);
+		if (m_Config.Headless)
+			m_Window = CreateHeadlessWindowFactory("Quest Engine", m_Config.Width, m_Config.Height);
+		else
+			m_Window = CreateWindowFactory("Quest Engine", m_Config.Width, m_Config.Height);
 		m_InputManager = m_Window->GetInputManagerPtr(); // This is the *ACTIVE* input manager from the active window
 
+		m_FrameAllocator = std::make_unique<FrameAllocator>(FRAME_ALLOCATOR_SIZE);
+		m_LevelMemory = std::malloc(LEVEL_ALLOCATOR_SIZE);
+		QE_ASSERT(m_LevelMemory);
+		m_LevelAllocator = std::make_unique<DoubleEndedStackAllocator>(LEVEL_ALLOCATOR_SIZE, m_LevelMemory);
+		m_GameMemory = std::malloc(GAME_ALLOCATOR_SIZE);
+		QE_ASSERT(m_GameMemory);
+		m_GameAllocator = std::make_unique<TLSFAllocator>(GAME_ALLOCATOR_SIZE, m_GameMemory);
+		m_GameMemoryResource = std::make_unique<TLSFMemoryResource>(*m_GameAllocator);
+
+		m_MemoryRegistry = std::make_unique<MemoryRegistry>();
+		m_MemoryRegistry->RegisterAllocator(m_FrameAllocator.get(), "Frame", MemoryTag::Core);
+		m_MemoryRegistry->RegisterAllocator(m_LevelAllocator.get(), "Level", MemoryTag::Assets);
+		m_MemoryRegistry->RegisterAllocator(m_GameAllocator.get(), "Game", MemoryTag::Game);
+		m_MemoryRegistry->RegisterAllocator(&GetGlobalEventManager()->GetEventAllocator(), "Event Queue", MemoryTag::Events);
+
 		// Initialize graphics device and context
 		m_GraphicsDevice = CreateGraphicsDeviceFactory(m_Window.get());
+		m_GraphicsDevice->RegisterAllocators(*m_MemoryRegistry);
 		m_GraphicsContext = m_GraphicsDevice->CreateGraphicsContext();
 		m_TestCamera = std::make_unique<TestCamera>();
 		m_GraphicsDevice->SetCamera(m_TestCamera.get());
@@ -50,26 +132,46 @@ namespace QE
 	{
 		m_GameApplication->Shutdown();
 
+		m_GraphicsDevice->UnregisterAllocators(*m_MemoryRegistry);
 		m_GraphicsDevice.reset();
+
+		m_MemoryRegistry->UnregisterAllocator(m_LevelAllocator.get());
+		m_LevelAllocator.reset();
+		std::free(m_LevelMemory);
+		m_LevelMemory = nullptr;
 	}
 
 	void Engine::Run()
 	{
 		EventManager* g_EventManager = GetGlobalEventManager();
-		constexpr bool RunGraphics = true;
+		Profiler* profiler = GetGlobalProfiler();
 		float deltaTime = 0.0f; // time between current frame and last frame
 		float lastFrame = 0.0f; // time of last frame
+		std::uint32_t frame = 0;
+		const auto runStart = std::chrono::steady_clock::now();
 		while (m_Running)
 		{
-			float currentFrameTime = static_cast<float>(GetTime());
+			// Headless runs have no window system clock and step a fixed time instead
+			float currentFrameTime = m_Config.Headless ? lastFrame + HEADLESS_DELTA_TIME : static_cast<float>(GetTime());
 			deltaTime = currentFrameTime - lastFrame;
 			lastFrame = currentFrameTime;
 
-			// Flush (dispatch) all pending events
-			g_EventManager->Flush();
+			profiler->BeginFrame(m_GraphicsDevice->GetFrameNumber());
+
+			// Sample last frame's allocator usage before any of it is dropped
+			m_MemoryRegistry->Update();
+
+			// Last frame's transient allocations stay alive, the ones from two frames ago are dropped
+			m_FrameAllocator->BeginFrame();
+
+			{
+				QE_PROFILE_SCOPE("Events");
+				// Flush (dispatch) all pending events
+				g_EventManager->Flush();
 
-			m_Window->GetInputManager().ProcessTransitions();
-			m_Window->ProcessEvents();
+				m_Window->GetInputManager().ProcessTransitions();
+				m_Window->ProcessEvents();
+			}
 
 			if (m_InputManager->IsKeyPressed(Escape))
 			{
@@ -78,19 +180,52 @@ namespace QE
 			if (m_InputManager->IsKeyPressed(P))
 				m_Window->ToggleMouseInputProcessing();
 
-			m_TestCamera->Update(deltaTime);
+			{
+				QE_PROFILE_SCOPE("Update");
+				m_TestCamera->Update(deltaTime);
+
+				m_GraphicsDevice->BeginFrame();
 
-			// Great value headless mode, will definitely fix later on
-			if (RunGraphics) m_GraphicsDevice->BeginFrame();
+				m_TestCamera->DrawDebugInfo();
 
-			m_TestCamera->DrawDebugInfo();
+				m_GameApplication->Update();
 
-			m_GameApplication->Update();
+				if (!m_Config.CaptureFolder.empty() && ShouldCaptureFrame(frame))
+					m_GraphicsDevice->CaptureFrame((std::filesystem::path(m_Config.CaptureFolder) / std::format("frame_{:05}.ppm", frame)).string());
+			}
+
+			{
+				QE_PROFILE_SCOPE("Render");
+				m_GraphicsDevice->EndFrame();
+			}
 
-			if (RunGraphics) m_GraphicsDevice->EndFrame();
+			{
+				QE_PROFILE_SCOPE("Present");
+				m_GraphicsDevice->PresentFrame();
+			}
 
-			if (RunGraphics) m_GraphicsDevice->PresentFrame();
+			// The latest frame the GPU finished, the profiler ignores it when it was already added
+			profiler->AddGpuFrame(m_GraphicsDevice->GetGpuFrameProfile());
+			profiler->EndFrame();
+
+			frame++;
+			if (m_Config.FrameCount != 0 && frame >= m_Config.FrameCount)
+				m_Running = false;
 		}
+
+		// Throughput of the whole run, the numbers render benchmarks compare
+		m_GraphicsDevice->WaitForDeviceIdle();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+		if (frame > 0 && seconds > 0.0)
+			LOG_INFO_TAG("Engine", "Rendered {} frames in {:.3f} s, {:.3f} ms per frame, {:.1f} fps", frame, seconds, seconds * 1000.0 / frame, frame / seconds);
+	}
+
+	bool Engine::ShouldCaptureFrame(std::uint32_t frame) const
+	{
+		if (m_Config.CaptureInterval != 0)
+			return frame % m_Config.CaptureInterval == 0;
+
+		return m_Config.FrameCount != 0 && frame + 1 == m_Config.FrameCount;
 	}
 
 	void Engine::SetWindowShouldClose(bool shouldClose)
@@ -126,6 +261,51 @@ namespace QE
 		return &m_Window->GetInputManager();
 	}
 
+	FrameAllocator& Engine::GetFrameAllocator()
+	{
+		return *m_FrameAllocator;
+	}
+
+	FrameAllocator* Engine::GetFrameAllocatorPtr()
+	{
+		return m_FrameAllocator.get();
+	}
+
+	DoubleEndedStackAllocator& Engine::GetLevelAllocator()
+	{
+		return *m_LevelAllocator;
+	}
+
+	DoubleEndedStackAllocator* Engine::GetLevelAllocatorPtr()
+	{
+		return m_LevelAllocator.get();
+	}
+
+	TLSFAllocator& Engine::GetGameAllocator()
+	{
+		return *m_GameAllocator;
+	}
+
+	TLSFAllocator* Engine::GetGameAllocatorPtr()
+	{
+		return m_GameAllocator.get();
+	}
+
+	std::pmr::memory_resource* Engine::GetGameMemoryResource()
+	{
+		return m_GameMemoryResource.get();
+	}
+
+	MemoryRegistry& Engine::GetMemoryRegistry()
+	{
+		return *m_MemoryRegistry;
+	}
+
+	MemoryRegistry* Engine::GetMemoryRegistryPtr()
+	{
+		return m_MemoryRegistry.get();
+	}
+
 	GraphicsDevice& Engine::GetGraphicsDevice()
 	{
 		return *m_GraphicsDevice;
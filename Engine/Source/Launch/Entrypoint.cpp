@@ -18,7 +18,7 @@ void TerminateHandler()
     exit(1);
 }
 
-void InitializeEngineEntrypoint()
+void InitializeEngineEntrypoint(int argc, char** argv)
 {
     using namespace QE;
 
@@ -34,7 +34,7 @@ void InitializeEngineEntrypoint()
     Log::Init();
     LOG_INFO("Hello from the Entrypoint for Quest Engine!");
 
-    g_Engine.Initialize();
+    g_Engine.Initialize(EngineConfig::FromCommandLine(argc, argv));
 }
 
 void RunEngine()
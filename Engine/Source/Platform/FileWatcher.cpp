@@ -0,0 +1,151 @@
+#include "Platform/FileWatcher.h"
+
+#include "Core/Log.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace QE
+{
+	FileWatcher::~FileWatcher()
+	{
+		Stop();
+	}
+
+#ifdef __linux__
+	bool FileWatcher::Watch(const std::filesystem::path& folder)
+	{
+		Stop();
+
+		m_InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_InotifyFd < 0)
+		{
+			LOG_WARN_TAG("FileWatcher", "inotify_init1 failed: {}", std::strerror(errno));
+			return false;
+		}
+
+		// Editors either write in place or write a temporary file and rename it over the original
+		m_WatchDescriptor = inotify_add_watch(m_InotifyFd, folder.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (m_WatchDescriptor < 0)
+		{
+			LOG_WARN_TAG("FileWatcher", "Cannot watch {}: {}", folder.string(), std::strerror(errno));
+			Stop();
+			return false;
+		}
+
+		m_Folder = folder;
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		if (m_InotifyFd >= 0)
+			close(m_InotifyFd);
+
+		m_InotifyFd = -1;
+		m_WatchDescriptor = -1;
+		m_Folder.clear();
+	}
+
+	std::vector<std::string> FileWatcher::Poll()
+	{
+		std::vector<std::string> changed;
+		if (m_InotifyFd < 0)
+			return changed;
+
+		alignas(inotify_event) char buffer[4096];
+		for (;;)
+		{
+			const ssize_t length = read(m_InotifyFd, buffer, sizeof(buffer));
+			if (length <= 0)
+				break; // EAGAIN once the queue is drained
+
+			for (ssize_t offset = 0; offset < length;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				if (event->len > 0 && !(event->mask & IN_ISDIR))
+				{
+					std::string name = event->name;
+					if (std::find(changed.begin(), changed.end(), name) == changed.end())
+						changed.push_back(std::move(name));
+				}
+
+				offset += sizeof(inotify_event) + event->len;
+			}
+		}
+
+		return changed;
+	}
+#else
+	bool FileWatcher::Watch(const std::filesystem::path& folder)
+	{
+		Stop();
+
+		std::error_code error;
+		if (!std::filesystem::is_directory(folder, error))
+		{
+			LOG_WARN_TAG("FileWatcher", "Cannot watch {}, it is not a folder", folder.string());
+			return false;
+		}
+
+		m_Folder = folder;
+		Scan(nullptr);
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		m_Folder.clear();
+		m_WriteTimes.clear();
+	}
+
+	std::vector<std::string> FileWatcher::Poll()
+	{
+		std::vector<std::string> changed;
+		if (m_Folder.empty())
+			return changed;
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - m_LastScan < SCAN_INTERVAL)
+			return changed;
+
+		Scan(&changed);
+		return changed;
+	}
+
+	void FileWatcher::Scan(std::vector<std::string>* changed)
+	{
+		m_LastScan = std::chrono::steady_clock::now();
+
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(m_Folder, error))
+		{
+			if (!entry.is_regular_file(error))
+				continue;
+
+			const std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+			if (error)
+				continue;
+
+			std::string name = entry.path().filename().string();
+			auto [it, inserted] = m_WriteTimes.try_emplace(name, writeTime);
+			if (!inserted && it->second != writeTime)
+			{
+				it->second = writeTime;
+				if (changed)
+					changed->push_back(std::move(name));
+			}
+			else if (inserted && changed)
+			{
+				changed->push_back(std::move(name));
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace QE
+{
+	// Reports files in a folder that were written since the last poll, without blocking. Uses inotify on Linux,
+	// elsewhere the folder is scanned for newer write times at most every SCAN_INTERVAL.
+	class FileWatcher
+	{
+	public:
+		static constexpr std::chrono::milliseconds SCAN_INTERVAL{ 250 };
+
+		FileWatcher() = default;
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// Not recursive, returns false when the folder cannot be watched
+		bool Watch(const std::filesystem::path& folder);
+		void Stop();
+
+		// File names relative to the folder, each name at most once per poll
+		std::vector<std::string> Poll();
+
+		[[nodiscard]] bool IsWatching() const { return !m_Folder.empty(); }
+	private:
+		std::filesystem::path m_Folder;
+#ifdef __linux__
+		int m_InotifyFd = -1;
+		int m_WatchDescriptor = -1;
+#else
+		void Scan(std::vector<std::string>* changed);
+
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+		std::chrono::steady_clock::time_point m_LastScan;
+#endif
+	};
+}
@@ -0,0 +1,32 @@
+#include "HeadlessWindow.h"
+
+#include "Core/Log.h"
+
+namespace QE
+{
+	HeadlessWindow::HeadlessWindow(std::string_view windowName, int width, int height)
+		: Window(windowName, width, height)
+	{
+		m_IsHeadless = true;
+		m_IsProcessingMouseInput = false;
+
+		LOG_INFO_TAG("HeadlessWindow", "Created headless window: [{0}] ({1}x{2})", windowName, width, height);
+	}
+
+	void* HeadlessWindow::GetNativeWindow()
+	{
+		return nullptr;
+	}
+
+	void HeadlessWindow::ProcessEvents()
+	{
+	}
+
+	void HeadlessWindow::PauseWindow()
+	{
+	}
+
+	void HeadlessWindow::ToggleMouseInputProcessing()
+	{
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Core/Window.h"
+
+namespace QE
+{
+	class HeadlessWindow : public Window
+	{
+	public:
+		HeadlessWindow(std::string_view windowName, int width, int height);
+		virtual ~HeadlessWindow() override = default;
+
+		// nullptr, there is nothing to create a surface for
+		virtual void* GetNativeWindow() override;
+		virtual void ProcessEvents() override;
+		virtual void PauseWindow() override;
+
+		virtual void ToggleMouseInputProcessing() override;
+	};
+}
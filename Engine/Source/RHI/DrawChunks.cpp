@@ -0,0 +1,38 @@
+#include "RHI/DrawChunks.h"
+
+#include <algorithm>
+
+namespace QE
+{
+	void SplitDrawChunks(std::span<const DrawKey> keys, std::uint32_t instanceCount, std::uint32_t workerCount, std::pmr::vector<DrawChunk>& chunks)
+	{
+		workerCount = std::max(workerCount, 1u);
+		const std::uint32_t chunkInstances = std::max(MIN_INSTANCES_PER_CHUNK, (instanceCount + workerCount - 1) / workerCount);
+
+		chunks.clear();
+		DrawChunk chunk = {};
+		std::uint32_t visibleCount = 0;
+		std::uint32_t chunkCount = 0;
+		for (std::uint32_t i = 0; i < keys.size(); i++)
+		{
+			if (chunk.KeyCount == 0)
+			{
+				chunk.FirstKey = i;
+				chunk.FirstVisible = visibleCount;
+				chunkCount = 0;
+			}
+
+			chunk.KeyCount++;
+			chunkCount += keys[i].InstanceCount;
+			visibleCount += keys[i].InstanceCount;
+
+			if (chunkCount >= chunkInstances)
+			{
+				chunks.push_back(chunk);
+				chunk = {};
+			}
+		}
+		if (chunk.KeyCount > 0)
+			chunks.push_back(chunk);
+	}
+}
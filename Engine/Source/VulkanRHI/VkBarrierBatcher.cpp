@@ -0,0 +1,241 @@
+#include "VkBarrierBatcher.h"
+#include "VkInit.h"
+
+#include <atomic>
+
+namespace QE
+{
+    namespace
+    {
+        // Accesses whose results have to be made available before anything else touches the resource
+        constexpr VkAccessFlags2 WRITE_ACCESSES = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+        std::atomic<bool> s_Conservative = false;
+
+        struct UsageInfo
+        {
+            VkPipelineStageFlags2 Stages;
+            VkAccessFlags2 ReadAccesses;
+            VkAccessFlags2 WriteAccesses;
+            VkImageLayout Layout;
+        };
+
+        UsageInfo GetUsageInfo(ResourceUsage usage)
+        {
+            switch (usage)
+            {
+                case ResourceUsage::ColorAttachment:
+                    return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+                case ResourceUsage::DepthAttachment:
+                    return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL };
+                case ResourceUsage::StorageImage:
+                    return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+                case ResourceUsage::Sampled:
+                    return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                        VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+                case ResourceUsage::Present:
+                    return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+                case ResourceUsage::TransferSrc:
+                    return { VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                        VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+                case ResourceUsage::TransferDst:
+                    return { VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_NONE,
+                        VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+                case ResourceUsage::CopyDst:
+                    return { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+                case ResourceUsage::ComputeStorage:
+                    return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+                case ResourceUsage::VertexStorage:
+                    return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                        VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED };
+                case ResourceUsage::IndirectCommands:
+                    return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                        VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED };
+                case ResourceUsage::HostRead:
+                    return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED };
+            }
+
+            return {};
+        }
+
+        VkAccessFlags2 GetAccesses(const UsageInfo& usage, ResourceAccess access)
+        {
+            const bool reads = access != ResourceAccess::Overwrite;
+            const bool writes = access != ResourceAccess::Read;
+            return (reads ? usage.ReadAccesses : VK_ACCESS_2_NONE) | (writes ? usage.WriteAccesses : VK_ACCESS_2_NONE);
+        }
+
+        // Reads after reads in the same layout only need a barrier for stages that have not waited yet
+        bool IsRedundant(const ResourceState& state, const UsageInfo& usage, VkAccessFlags2 accesses, ResourceAccess access)
+        {
+            if (s_Conservative.load(std::memory_order_relaxed))
+                return false;
+
+            const bool pendingWrites = (state.Accesses & WRITE_ACCESSES) != 0;
+            return state.Layout == usage.Layout && !pendingWrites && access == ResourceAccess::Read
+                && (usage.Stages & ~state.Stages) == 0 && (accesses & ~state.Accesses) == 0;
+        }
+    }
+
+    void VkBarrierBatcher::Image(VkImage image, VkImageAspectFlags aspect, ResourceState& state, ResourceUsage usage, ResourceAccess access)
+    {
+        const UsageInfo info = GetUsageInfo(usage);
+        const VkAccessFlags2 accesses = GetAccesses(info, access);
+        if (IsRedundant(state, info, accesses, access))
+        {
+            m_Stats.Skipped++;
+            return;
+        }
+
+        // Reads only wait for earlier reads, writes also have to be made available. Contents that are
+        // overwritten are discarded, which lets the transition skip preserving them
+        VkImageMemoryBarrier2 barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = state.Stages;
+        barrier.srcAccessMask = state.Accesses & WRITE_ACCESSES;
+        barrier.dstStageMask = info.Stages;
+        barrier.dstAccessMask = accesses;
+        barrier.oldLayout = access == ResourceAccess::Overwrite ? VK_IMAGE_LAYOUT_UNDEFINED : state.Layout;
+        barrier.newLayout = info.Layout;
+        barrier.image = image;
+        barrier.subresourceRange = VkInit::GetImageSubresourceRange(aspect);
+        m_ImageBarriers.push_back(barrier);
+
+        state = { info.Layout, info.Stages, accesses };
+    }
+
+    void VkBarrierBatcher::HandOffImage(VkImage image, VkImageAspectFlags aspect, ResourceState& state, VkImageLayout layout)
+    {
+        if (state.Layout == layout && (state.Accesses & WRITE_ACCESSES) == 0 && !IsConservative())
+        {
+            m_Stats.Skipped++;
+            return;
+        }
+
+        // Nothing later in this submission touches the image, the semaphore wait makes the transition visible.
+        // No destination stage also keeps the barrier valid on queues without graphics or compute
+        VkImageMemoryBarrier2 barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = state.Stages;
+        barrier.srcAccessMask = state.Accesses & WRITE_ACCESSES;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = state.Layout;
+        barrier.newLayout = layout;
+        barrier.image = image;
+        barrier.subresourceRange = VkInit::GetImageSubresourceRange(aspect);
+        m_ImageBarriers.push_back(barrier);
+
+        state = { layout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+    }
+
+    void VkBarrierBatcher::Buffer(VkBuffer buffer, ResourceState& state, ResourceUsage usage, ResourceAccess access, VkDeviceSize offset, VkDeviceSize size)
+    {
+        const UsageInfo info = GetUsageInfo(usage);
+        const VkAccessFlags2 accesses = GetAccesses(info, access);
+
+        // Buffers have no layout, so a first use of one nothing has touched in this submission never waits.
+        // Host writes made before the submission are visible to it without a barrier
+        if ((state.Stages == VK_PIPELINE_STAGE_2_NONE && !IsConservative()) || IsRedundant(state, info, accesses, access))
+        {
+            m_Stats.Skipped += state.Stages != VK_PIPELINE_STAGE_2_NONE;
+            state = { VK_IMAGE_LAYOUT_UNDEFINED, state.Stages | info.Stages, state.Accesses | accesses };
+            return;
+        }
+
+        VkBufferMemoryBarrier2 barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        barrier.srcStageMask = state.Stages;
+        barrier.srcAccessMask = state.Accesses & WRITE_ACCESSES;
+        barrier.dstStageMask = info.Stages;
+        barrier.dstAccessMask = accesses;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = buffer;
+        barrier.offset = offset;
+        barrier.size = size;
+        m_BufferBarriers.push_back(barrier);
+
+        state = { VK_IMAGE_LAYOUT_UNDEFINED, info.Stages, accesses };
+    }
+
+    void VkBarrierBatcher::SetConservative(bool conservative)
+    {
+        s_Conservative.store(conservative, std::memory_order_relaxed);
+    }
+
+    bool VkBarrierBatcher::IsConservative()
+    {
+        return s_Conservative.load(std::memory_order_relaxed);
+    }
+
+    void VkBarrierBatcher::Flush(VkCommandBuffer cmd)
+    {
+        if (IsEmpty())
+            return;
+
+        if (IsConservative())
+        {
+            FlushConservative(cmd);
+            return;
+        }
+
+        VkDependencyInfo dependencyInfo = {};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<std::uint32_t>(m_BufferBarriers.size());
+        dependencyInfo.pBufferMemoryBarriers = m_BufferBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<std::uint32_t>(m_ImageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = m_ImageBarriers.data();
+        vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+
+        m_Stats.Barriers += static_cast<std::uint32_t>(m_BufferBarriers.size() + m_ImageBarriers.size());
+        m_Stats.Flushes++;
+        m_BufferBarriers.clear();
+        m_ImageBarriers.clear();
+    }
+
+    void VkBarrierBatcher::FlushConservative(VkCommandBuffer cmd)
+    {
+        // Hand-offs keep their empty destination, it is what keeps them valid on transfer queues
+        auto widen = [](auto& barrier) {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+            if (barrier.dstStageMask != VK_PIPELINE_STAGE_2_NONE)
+            {
+                barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                barrier.dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT;
+            }
+        };
+
+        for (VkBufferMemoryBarrier2& barrier : m_BufferBarriers)
+        {
+            widen(barrier);
+            VkDependencyInfo dependencyInfo = {};
+            dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependencyInfo.bufferMemoryBarrierCount = 1;
+            dependencyInfo.pBufferMemoryBarriers = &barrier;
+            vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+        }
+
+        for (VkImageMemoryBarrier2& barrier : m_ImageBarriers)
+        {
+            widen(barrier);
+            VkDependencyInfo dependencyInfo = {};
+            dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependencyInfo.imageMemoryBarrierCount = 1;
+            dependencyInfo.pImageMemoryBarriers = &barrier;
+            vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+        }
+
+        const std::uint32_t count = static_cast<std::uint32_t>(m_BufferBarriers.size() + m_ImageBarriers.size());
+        m_Stats.Barriers += count;
+        m_Stats.Flushes += count;
+        m_BufferBarriers.clear();
+        m_ImageBarriers.clear();
+    }
+}
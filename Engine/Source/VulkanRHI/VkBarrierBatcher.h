@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace QE
+{
+    // How a resource is used, each usage has its own stages, accesses and image layout
+    enum class ResourceUsage : std::uint8_t
+    {
+        // Images
+        ColorAttachment,
+        DepthAttachment,
+        StorageImage, // compute shader
+        Sampled, // fragment and compute shaders
+        Present, // the presentation engine is ordered by the semaphore the submission signals
+
+        // Images and buffers
+        TransferSrc,
+        TransferDst, // copies, blits and fills
+        CopyDst, // copies only, also valid on transfer queues
+
+        // Buffers
+        ComputeStorage, // storage buffers and buffer device addresses
+        VertexStorage, // same, read by the vertex shader
+        IndirectCommands,
+        HostRead, // mapped readback once the submission has finished
+    };
+
+    enum class ResourceAccess : std::uint8_t
+    {
+        Read,
+        ReadWrite,
+        Overwrite, // earlier contents are not needed, images skip preserving them
+    };
+
+    // Where a resource was left. Layout only means something for images
+    struct ResourceState
+    {
+        VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE; // of the accesses since the last barrier
+        VkAccessFlags2 Accesses = VK_ACCESS_2_NONE;
+    };
+
+    // Collects image and buffer barriers and records them in one vkCmdPipelineBarrier2. Stages and accesses come
+    // from how the resource was used last and how it is used next, reads that follow reads in the same layout
+    // need no barrier and are dropped, as are the first uses of buffers nothing has touched yet
+    class VkBarrierBatcher
+    {
+    public:
+        struct Stats
+        {
+            std::uint32_t Barriers = 0;
+            std::uint32_t Skipped = 0; // redundant ones that were dropped
+            std::uint32_t Flushes = 0; // vkCmdPipelineBarrier2 calls
+        };
+
+        // state is moved to the new usage right away, the barrier is only recorded by Flush
+        void Image(VkImage image, VkImageAspectFlags aspect, ResourceState& state, ResourceUsage usage, ResourceAccess access);
+        // For whoever waits on the submission's semaphore, possibly on another queue
+        void HandOffImage(VkImage image, VkImageAspectFlags aspect, ResourceState& state, VkImageLayout layout);
+        void Buffer(VkBuffer buffer, ResourceState& state, ResourceUsage usage, ResourceAccess access, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+        // Records everything added since the last flush, nothing when it is all redundant
+        void Flush(VkCommandBuffer cmd);
+
+        // Records every barrier the way VkInit::TransitionImage used to: each in its own call, with ALL_COMMANDS and
+        // MEMORY_READ/WRITE masks and nothing dropped. Applies to every batcher, only there to measure the difference
+        static void SetConservative(bool conservative);
+        [[nodiscard]] static bool IsConservative();
+
+        [[nodiscard]] bool IsEmpty() const { return m_ImageBarriers.empty() && m_BufferBarriers.empty(); }
+        [[nodiscard]] const Stats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = {}; }
+    private:
+        void FlushConservative(VkCommandBuffer cmd);
+
+        std::vector<VkImageMemoryBarrier2> m_ImageBarriers;
+        std::vector<VkBufferMemoryBarrier2> m_BufferBarriers;
+        Stats m_Stats;
+    };
+}
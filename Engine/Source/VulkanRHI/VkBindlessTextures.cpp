@@ -0,0 +1,115 @@
+#include "VkBindlessTextures.h"
+#include "VkCommon.h"
+#include "VkDescriptors.h"
+
+#include <algorithm>
+
+namespace QE
+{
+    void VkBindlessTextures::Init(VkDevice device, VkPhysicalDevice physicalDevice, std::uint32_t capacity)
+    {
+        m_Device = device;
+
+        VkPhysicalDeviceVulkan12Properties properties12 = {};
+        properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &properties12;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+        m_Capacity = std::min({ capacity,
+            properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+            properties12.maxDescriptorSetUpdateAfterBindSampledImages });
+
+        // Pool and layout have to opt into update-after-bind, slots nobody registered are never read
+        VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_Capacity };
+        VkDescriptorPoolCreateInfo poolInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        VK_CHECK(vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_Pool));
+
+        VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+        bindingFlagsInfo.bindingCount = 1;
+        bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+        DescriptorLayoutBuilder builder;
+        builder.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_Capacity);
+        m_Layout = builder.Build(m_Device, VK_SHADER_STAGE_FRAGMENT_BIT, &bindingFlagsInfo, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+        VkDescriptorSetAllocateInfo allocInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = m_Pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_Layout;
+        VK_CHECK(vkAllocateDescriptorSets(m_Device, &allocInfo, &m_Set));
+
+        m_FreeSlots.resize(m_Capacity);
+        for (std::uint32_t i = 0; i < m_Capacity; i++)
+            m_FreeSlots[i] = m_Capacity - 1 - i;
+
+        LOG_DEBUG_TAG("VkBindlessTextures", "Created bindless texture table with {} slots", m_Capacity);
+    }
+
+    void VkBindlessTextures::Destroy()
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_Layout, nullptr);
+        vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+
+        m_Layout = VK_NULL_HANDLE;
+        m_Pool = VK_NULL_HANDLE;
+        m_Set = VK_NULL_HANDLE;
+        m_FreeSlots.clear();
+        m_PendingReleases.clear();
+    }
+
+    std::uint32_t VkBindlessTextures::Register(VkImageView imageView, VkSampler sampler)
+    {
+        if (m_FreeSlots.empty())
+        {
+            LOG_ERROR_TAG("VkBindlessTextures", "Bindless texture table is full ({} slots)", m_Capacity);
+            return INVALID_INDEX;
+        }
+
+        const std::uint32_t index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+
+        VkDescriptorImageInfo imageInfo = {};
+        imageInfo.sampler = sampler;
+        imageInfo.imageView = imageView;
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write = { .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet = m_Set;
+        write.dstBinding = 0;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(m_Device, 1, &write, 0, nullptr);
+
+        return index;
+    }
+
+    void VkBindlessTextures::Release(std::uint32_t index, std::uint32_t frame)
+    {
+        if (index == INVALID_INDEX)
+            return;
+
+        m_PendingReleases.push_back({ index, frame });
+    }
+
+    void VkBindlessTextures::Update(std::uint32_t completedFrame)
+    {
+        auto firstPending = std::find_if(m_PendingReleases.begin(), m_PendingReleases.end(), [completedFrame](const PendingRelease& pending) {
+            return pending.Frame > completedFrame;
+        });
+
+        for (auto it = m_PendingReleases.begin(); it != firstPending; ++it)
+            m_FreeSlots.push_back(it->Index);
+        m_PendingReleases.erase(m_PendingReleases.begin(), firstPending);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace QE
+{
+    // One descriptor set holding every texture as an array of combined image samplers. Textures are
+    // written into a free slot once when they are registered, shaders index the array with the slot so
+    // drawing never allocates or updates descriptors. Released slots are only handed out again once the
+    // frames that may still sample them have finished, since update-after-bind only allows rewriting
+    // descriptors that pending work does not use.
+    class VkBindlessTextures
+    {
+    public:
+        static constexpr std::uint32_t DEFAULT_CAPACITY = 4096;
+        static constexpr std::uint32_t INVALID_INDEX = UINT32_MAX;
+
+        // The capacity is clamped to what the device allows in a single stage
+        void Init(VkDevice device, VkPhysicalDevice physicalDevice, std::uint32_t capacity = DEFAULT_CAPACITY);
+        // Device has to be idle
+        void Destroy();
+
+        // Returns INVALID_INDEX when the table is full
+        std::uint32_t Register(VkImageView imageView, VkSampler sampler);
+        // frame is the frame being recorded
+        void Release(std::uint32_t index, std::uint32_t frame);
+        // Makes the slots released on or before completedFrame available again
+        void Update(std::uint32_t completedFrame);
+
+        [[nodiscard]] VkDescriptorSetLayout GetLayout() const { return m_Layout; }
+        [[nodiscard]] VkDescriptorSet GetSet() const { return m_Set; }
+        [[nodiscard]] std::uint32_t GetCapacity() const { return m_Capacity; }
+        [[nodiscard]] std::uint32_t GetUsedCount() const { return m_Capacity - static_cast<std::uint32_t>(m_FreeSlots.size()) - static_cast<std::uint32_t>(m_PendingReleases.size()); }
+    private:
+        struct PendingRelease
+        {
+            std::uint32_t Index;
+            std::uint32_t Frame;
+        };
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VkDescriptorPool m_Pool = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+        VkDescriptorSet m_Set = VK_NULL_HANDLE;
+        std::uint32_t m_Capacity = 0;
+
+        std::vector<std::uint32_t> m_FreeSlots; // popped from the back, lowest index last
+        std::vector<PendingRelease> m_PendingReleases; // in frame order
+    };
+}
@@ -0,0 +1,185 @@
+#include "VkDeletionQueue.h"
+#include "Core/Log.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace QE
+{
+    VkDeletionQueue::VkDeletionQueue(std::size_t initialCapacity)
+        : m_Records(std::bit_ceil(std::max<std::size_t>(initialCapacity, 1)))
+    {
+    }
+
+    void VkDeletionQueue::Push(VkBuffer buffer, VmaAllocation allocation, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(buffer), allocation, DeletionType::Buffer, frame);
+    }
+
+    void VkDeletionQueue::Push(VkImage image, VmaAllocation allocation, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(image), allocation, DeletionType::Image, frame);
+    }
+
+    void VkDeletionQueue::Push(VmaAllocation allocation, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(allocation), allocation, DeletionType::Allocation, frame);
+    }
+
+    void VkDeletionQueue::Push(VkImageView imageView, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(imageView), VK_NULL_HANDLE, DeletionType::ImageView, frame);
+    }
+
+    void VkDeletionQueue::Push(VkSampler sampler, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(sampler), VK_NULL_HANDLE, DeletionType::Sampler, frame);
+    }
+
+    void VkDeletionQueue::Push(VkSwapchainKHR swapchain, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(swapchain), VK_NULL_HANDLE, DeletionType::Swapchain, frame);
+    }
+
+    void VkDeletionQueue::Push(VkPipeline pipeline, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(pipeline), VK_NULL_HANDLE, DeletionType::Pipeline, frame);
+    }
+
+    void VkDeletionQueue::Push(VkPipelineLayout pipelineLayout, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(pipelineLayout), VK_NULL_HANDLE, DeletionType::PipelineLayout, frame);
+    }
+
+    void VkDeletionQueue::Push(VkDescriptorSetLayout descriptorSetLayout, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(descriptorSetLayout), VK_NULL_HANDLE, DeletionType::DescriptorSetLayout, frame);
+    }
+
+    void VkDeletionQueue::Push(VkDescriptorPool descriptorPool, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(descriptorPool), VK_NULL_HANDLE, DeletionType::DescriptorPool, frame);
+    }
+
+    void VkDeletionQueue::Push(VkCommandPool commandPool, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(commandPool), VK_NULL_HANDLE, DeletionType::CommandPool, frame);
+    }
+
+    void VkDeletionQueue::Push(VkFence fence, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(fence), VK_NULL_HANDLE, DeletionType::Fence, frame);
+    }
+
+    void VkDeletionQueue::Push(VkSemaphore semaphore, std::uint32_t frame)
+    {
+        PushRecord(reinterpret_cast<std::uint64_t>(semaphore), VK_NULL_HANDLE, DeletionType::Semaphore, frame);
+    }
+
+    void VkDeletionQueue::Flush(VkDevice device, VmaAllocator allocator, std::uint32_t completedFrame)
+    {
+        // Records are pushed with non decreasing frames, so the completed ones are a prefix
+        std::uint64_t end = m_Tail;
+        while (end != m_Head && At(end).Frame <= completedFrame)
+            end++;
+
+        DestroyRange(device, allocator, end);
+    }
+
+    void VkDeletionQueue::FlushAll(VkDevice device, VmaAllocator allocator)
+    {
+        DestroyRange(device, allocator, m_Head);
+    }
+
+    void VkDeletionQueue::PushRecord(std::uint64_t handle, VmaAllocation allocation, DeletionType type, std::uint32_t frame)
+    {
+        if (handle == 0)
+            return;
+
+        if (GetSize() == m_Records.size())
+            Grow();
+
+        At(m_Head++) = { handle, allocation, frame, type };
+    }
+
+    void VkDeletionQueue::DestroyRange(VkDevice device, VmaAllocator allocator, std::uint64_t end)
+    {
+        if (end == m_Tail)
+            return;
+
+        // One pass per type so each kind of object is torn down together and in dependency order
+        for (std::uint8_t type = 0; type < static_cast<std::uint8_t>(DeletionType::Count); type++)
+        {
+            for (std::uint64_t i = m_Tail; i != end; i++)
+            {
+                const Record& record = At(i);
+                if (record.Type != static_cast<DeletionType>(type))
+                    continue;
+
+                switch (record.Type)
+                {
+                    case DeletionType::Pipeline:
+                        vkDestroyPipeline(device, reinterpret_cast<VkPipeline>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::PipelineLayout:
+                        vkDestroyPipelineLayout(device, reinterpret_cast<VkPipelineLayout>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::DescriptorSetLayout:
+                        vkDestroyDescriptorSetLayout(device, reinterpret_cast<VkDescriptorSetLayout>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::DescriptorPool:
+                        vkDestroyDescriptorPool(device, reinterpret_cast<VkDescriptorPool>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::Sampler:
+                        vkDestroySampler(device, reinterpret_cast<VkSampler>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::ImageView:
+                        vkDestroyImageView(device, reinterpret_cast<VkImageView>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::Swapchain:
+                        vkDestroySwapchainKHR(device, reinterpret_cast<VkSwapchainKHR>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::Image:
+                        vmaDestroyImage(allocator, reinterpret_cast<VkImage>(record.Handle), record.Allocation);
+                        break;
+                    case DeletionType::Buffer:
+                        vmaDestroyBuffer(allocator, reinterpret_cast<VkBuffer>(record.Handle), record.Allocation);
+                        break;
+                    case DeletionType::Allocation:
+                        vmaFreeMemory(allocator, record.Allocation);
+                        break;
+                    case DeletionType::CommandPool:
+                        vkDestroyCommandPool(device, reinterpret_cast<VkCommandPool>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::Fence:
+                        vkDestroyFence(device, reinterpret_cast<VkFence>(record.Handle), nullptr);
+                        break;
+                    case DeletionType::Semaphore:
+                        vkDestroySemaphore(device, reinterpret_cast<VkSemaphore>(record.Handle), nullptr);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        m_Tail = end;
+        if (m_Tail == m_Head)
+            m_Tail = m_Head = 0;
+    }
+
+    void VkDeletionQueue::Grow()
+    {
+        std::vector<Record> records(m_Records.size() * 2);
+        const std::size_t size = GetSize();
+        for (std::size_t i = 0; i < size; i++)
+            records[i] = At(m_Tail + i);
+
+        m_Records = std::move(records);
+        m_Tail = 0;
+        m_Head = size;
+
+        LOG_DEBUG_TAG("VkDeletionQueue", "Grew to {} records", m_Records.size());
+    }
+}
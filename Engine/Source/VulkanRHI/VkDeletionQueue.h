@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <cstdint>
+#include <vector>
+
+namespace QE
+{
+    // Destroyed in this order, objects that reference others go first
+    enum class DeletionType : std::uint8_t
+    {
+        Pipeline,
+        PipelineLayout,
+        DescriptorSetLayout,
+        DescriptorPool,
+        Sampler,
+        ImageView,
+        Swapchain, // after the views of its images
+        Image,
+        Buffer,
+        Allocation, // memory that images were bound to by hand, after the images
+        CommandPool,
+        Fence,
+        Semaphore,
+        Count
+    };
+
+    // Deferred destruction of Vulkan objects. Records are kept in a ring in the order they were pushed,
+    // tagged with the frame that retired them, so flushing only has to pop the completed prefix.
+    // Objects are destroyed in one pass per type instead of through per-object callbacks, the ring only
+    // allocates when it has to grow.
+    class VkDeletionQueue
+    {
+    public:
+        explicit VkDeletionQueue(std::size_t initialCapacity = 256);
+
+        void Push(VkBuffer buffer, VmaAllocation allocation, std::uint32_t frame);
+        void Push(VkImage image, VmaAllocation allocation, std::uint32_t frame);
+        void Push(VmaAllocation allocation, std::uint32_t frame);
+        void Push(VkImageView imageView, std::uint32_t frame);
+        void Push(VkSampler sampler, std::uint32_t frame);
+        void Push(VkSwapchainKHR swapchain, std::uint32_t frame);
+        void Push(VkPipeline pipeline, std::uint32_t frame);
+        void Push(VkPipelineLayout pipelineLayout, std::uint32_t frame);
+        void Push(VkDescriptorSetLayout descriptorSetLayout, std::uint32_t frame);
+        void Push(VkDescriptorPool descriptorPool, std::uint32_t frame);
+        void Push(VkCommandPool commandPool, std::uint32_t frame);
+        void Push(VkFence fence, std::uint32_t frame);
+        void Push(VkSemaphore semaphore, std::uint32_t frame);
+
+        // Destroys everything retired on or before completedFrame
+        void Flush(VkDevice device, VmaAllocator allocator, std::uint32_t completedFrame);
+        // Destroys everything, the device has to be idle
+        void FlushAll(VkDevice device, VmaAllocator allocator);
+
+        [[nodiscard]] std::size_t GetSize() const { return static_cast<std::size_t>(m_Head - m_Tail); }
+        [[nodiscard]] bool IsEmpty() const { return m_Head == m_Tail; }
+    private:
+        struct Record
+        {
+            std::uint64_t Handle;
+            VmaAllocation Allocation;
+            std::uint32_t Frame;
+            DeletionType Type;
+        };
+
+        void PushRecord(std::uint64_t handle, VmaAllocation allocation, DeletionType type, std::uint32_t frame);
+        void DestroyRange(VkDevice device, VmaAllocator allocator, std::uint64_t end);
+        void Grow();
+
+        Record& At(std::uint64_t index) { return m_Records[index & (m_Records.size() - 1)]; }
+
+        std::vector<Record> m_Records; // size is kept a power of 2
+        std::uint64_t m_Head = 0; // next record to write
+        std::uint64_t m_Tail = 0; // oldest live record
+    };
+}
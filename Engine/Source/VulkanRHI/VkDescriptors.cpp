@@ -7,11 +7,11 @@
 
 namespace QE
 {
-	void DescriptorLayoutBuilder::AddBinding(uint32_t binding, VkDescriptorType type)
+	void DescriptorLayoutBuilder::AddBinding(uint32_t binding, VkDescriptorType type, uint32_t descriptorCount)
 	{
 		VkDescriptorSetLayoutBinding newBind{};
 		newBind.binding = binding;
-		newBind.descriptorCount = 1;
+		newBind.descriptorCount = descriptorCount;
 		newBind.descriptorType = type;
 
 		Bindings.push_back(newBind);
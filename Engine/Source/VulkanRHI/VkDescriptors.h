@@ -12,7 +12,7 @@ namespace QE
 
         std::vector<VkDescriptorSetLayoutBinding> Bindings;
 
-        void AddBinding(uint32_t binding, VkDescriptorType type);
+        void AddBinding(uint32_t binding, VkDescriptorType type, uint32_t descriptorCount = 1);
         void Clear();
         VkDescriptorSetLayout Build(VkDevice device, VkShaderStageFlags shaderStages, void* pNext = nullptr, VkDescriptorSetLayoutCreateFlags flags = 0);
     };
@@ -0,0 +1,95 @@
+#include "VkFrameScheduler.h"
+#include "VkCommon.h"
+#include "VkInit.h"
+
+#include <algorithm>
+
+namespace QE
+{
+    void VkFrameScheduler::Init(VkDevice device, std::uint32_t framesInFlight)
+    {
+        m_Device = device;
+        m_TimelineSemaphore = VkInit::CreateTimelineSemaphore(m_Device, 0);
+        m_LastSubmittedValue = 0;
+        m_FrameStart = m_LastSubmit = Clock::now();
+        SetFramesInFlight(framesInFlight);
+    }
+
+    void VkFrameScheduler::Destroy()
+    {
+        vkDestroySemaphore(m_Device, m_TimelineSemaphore, nullptr);
+        m_TimelineSemaphore = VK_NULL_HANDLE;
+    }
+
+    void VkFrameScheduler::BeginFrame()
+    {
+        m_FrameStart = Clock::now();
+        m_WaitTimeMs = 0.0f;
+    }
+
+    void VkFrameScheduler::WaitForSlot(std::uint32_t frame)
+    {
+        const std::uint64_t completed = GetCompletedFrames();
+        m_Stats.QueuedFrames = static_cast<std::uint32_t>(m_LastSubmittedValue - completed);
+
+        // Frame N reuses the slot of frame N - framesInFlight, which signals N - framesInFlight + 1
+        if (frame < m_FramesInFlight)
+            return;
+
+        const std::uint64_t value = frame - m_FramesInFlight + 1;
+        if (completed >= value)
+            return;
+
+        const Clock::time_point waitStart = Clock::now();
+        Wait(value);
+        m_WaitTimeMs += std::chrono::duration<float, std::milli>(Clock::now() - waitStart).count();
+    }
+
+    VkSemaphoreSubmitInfo VkFrameScheduler::BuildSignalInfo(std::uint32_t frame) const
+    {
+        VkSemaphoreSubmitInfo signalInfo = VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimelineSemaphore);
+        signalInfo.value = static_cast<std::uint64_t>(frame) + 1;
+        return signalInfo;
+    }
+
+    void VkFrameScheduler::OnSubmitted(std::uint32_t frame)
+    {
+        m_LastSubmittedValue = static_cast<std::uint64_t>(frame) + 1;
+
+        const Clock::time_point now = Clock::now();
+        m_Stats.FramesInFlight = m_FramesInFlight;
+        m_Stats.WaitTimeMs = m_WaitTimeMs;
+        m_Stats.CpuTimeMs = std::chrono::duration<float, std::milli>(now - m_FrameStart).count() - m_WaitTimeMs;
+        m_Stats.FrameTimeMs = std::chrono::duration<float, std::milli>(now - m_LastSubmit).count();
+        m_LastSubmit = now;
+    }
+
+    std::uint64_t VkFrameScheduler::GetCompletedFrames() const
+    {
+        std::uint64_t completedValue = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_TimelineSemaphore, &completedValue));
+        return completedValue;
+    }
+
+    void VkFrameScheduler::WaitIdle()
+    {
+        if (GetCompletedFrames() < m_LastSubmittedValue)
+            Wait(m_LastSubmittedValue);
+    }
+
+    void VkFrameScheduler::SetFramesInFlight(std::uint32_t count)
+    {
+        m_FramesInFlight = std::clamp(count, MIN_FRAMES_IN_FLIGHT, MAX_FRAMES_IN_FLIGHT);
+        m_Stats.FramesInFlight = m_FramesInFlight;
+    }
+
+    void VkFrameScheduler::Wait(std::uint64_t value)
+    {
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_TimelineSemaphore;
+        waitInfo.pValues = &value;
+        VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX));
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "RHI/ResourceTypes.h"
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+
+namespace QE
+{
+    // Paces frames with one timeline semaphore instead of a fence per frame. The submission of frame N signals
+    // N + 1, so the counter is the number of finished frames. A frame only needs the GPU to be done with the
+    // frame that last used its slot, and it waits for that as late as possible, right before it first touches
+    // the slot's resources. Everything else can ask how far the GPU is without blocking.
+    class VkFrameScheduler
+    {
+    public:
+        static constexpr std::uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+        static constexpr std::uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+        void Init(VkDevice device, std::uint32_t framesInFlight);
+        // Device has to be idle
+        void Destroy();
+
+        // Start of the CPU work of a frame, does not block
+        void BeginFrame();
+        // Blocks until the GPU is done with the frame that last used frame's slot
+        void WaitForSlot(std::uint32_t frame);
+        // Added to the submission of frame
+        [[nodiscard]] VkSemaphoreSubmitInfo BuildSignalInfo(std::uint32_t frame) const;
+        void OnSubmitted(std::uint32_t frame);
+
+        // Number of frames the GPU has finished, does not block
+        [[nodiscard]] std::uint64_t GetCompletedFrames() const;
+        // Blocks until every submitted frame has finished
+        void WaitIdle();
+
+        // Takes effect immediately, the caller waits for the GPU first since frames map to slots by the count
+        void SetFramesInFlight(std::uint32_t count);
+        [[nodiscard]] std::uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+        [[nodiscard]] std::uint32_t GetSlot(std::uint32_t frame) const { return frame % m_FramesInFlight; }
+
+        [[nodiscard]] const FramePacingStats& GetStats() const { return m_Stats; }
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void Wait(std::uint64_t value);
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VkSemaphore m_TimelineSemaphore = VK_NULL_HANDLE;
+        std::uint64_t m_LastSubmittedValue = 0;
+        std::uint32_t m_FramesInFlight = 2;
+
+        Clock::time_point m_FrameStart;
+        Clock::time_point m_LastSubmit;
+        float m_WaitTimeMs = 0.0f; // of the frame being recorded
+        FramePacingStats m_Stats;
+    };
+}
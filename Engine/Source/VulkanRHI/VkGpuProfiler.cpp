@@ -0,0 +1,201 @@
+#include "VkGpuProfiler.h"
+#include "VkCommon.h"
+
+#include <vector>
+
+namespace QE
+{
+    void VkGpuProfiler::Init(VkDevice device, VkPhysicalDevice physicalDevice, std::uint32_t queueFamily, std::uint32_t slotCount)
+    {
+        m_Device = device;
+        m_Slots.assign(slotCount, {});
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        std::uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+        const std::uint32_t validBits = families[queueFamily].timestampValidBits;
+        if (validBits == 0)
+        {
+            LOG_WARN_TAG("VkGpuProfiler", "Queue family {} has no timestamps, the GPU is not profiled", queueFamily);
+            return;
+        }
+
+        m_TimestampPeriod = properties.limits.timestampPeriod;
+        m_TimestampMask = validBits >= 64 ? UINT64_MAX : (std::uint64_t{ 1 } << validBits) - 1;
+
+        VkQueryPoolCreateInfo timestampInfo = {};
+        timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        timestampInfo.queryCount = slotCount * MAX_ZONES * 2;
+        VK_CHECK(vkCreateQueryPool(m_Device, &timestampInfo, nullptr, &m_TimestampPool));
+
+        // CreateLogicalDevice enables both whenever both are supported, zones around secondary command buffers
+        // need the inherited queries
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+        if (features.pipelineStatisticsQuery && features.inheritedQueries)
+        {
+            VkQueryPoolCreateInfo statisticsInfo = {};
+            statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statisticsInfo.queryCount = slotCount * MAX_ZONES;
+            statisticsInfo.pipelineStatistics = PIPELINE_STATISTICS;
+            VK_CHECK(vkCreateQueryPool(m_Device, &statisticsInfo, nullptr, &m_StatisticsPool));
+        }
+
+        LOG_DEBUG_TAG("VkGpuProfiler", "GPU profiler created, {} ns per tick, pipeline statistics: {}", m_TimestampPeriod, m_StatisticsPool != VK_NULL_HANDLE);
+    }
+
+    void VkGpuProfiler::Destroy()
+    {
+        vkDestroyQueryPool(m_Device, m_StatisticsPool, nullptr);
+        vkDestroyQueryPool(m_Device, m_TimestampPool, nullptr);
+        m_StatisticsPool = VK_NULL_HANDLE;
+        m_TimestampPool = VK_NULL_HANDLE;
+        m_Slots.clear();
+    }
+
+    void VkGpuProfiler::BeginFrame(VkCommandBuffer cmd, std::uint32_t slotIndex, std::uint32_t frame)
+    {
+        if (m_TimestampPool == VK_NULL_HANDLE)
+            return;
+
+        Slot& slot = m_Slots[slotIndex];
+        if (slot.Recorded)
+            ReadResults(slotIndex);
+
+        slot.Zones.clear();
+        slot.StatisticsQueries = 0;
+        slot.Frame = frame;
+        slot.Recorded = false;
+        m_CurrentSlot = slotIndex;
+        m_OpenZones.clear();
+        m_StatisticsActive = false;
+
+        // Queries have to be reset before they are written again
+        vkCmdResetQueryPool(cmd, m_TimestampPool, slotIndex * MAX_ZONES * 2, MAX_ZONES * 2);
+        if (m_StatisticsPool != VK_NULL_HANDLE)
+            vkCmdResetQueryPool(cmd, m_StatisticsPool, slotIndex * MAX_ZONES, MAX_ZONES);
+
+        slot.Zones.push_back({ "Frame", 0 });
+        m_OpenZones.push_back(0);
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_TimestampPool, slotIndex * MAX_ZONES * 2);
+    }
+
+    void VkGpuProfiler::EndFrame(VkCommandBuffer cmd)
+    {
+        if (m_TimestampPool == VK_NULL_HANDLE)
+            return;
+
+        QE_ASSERT(m_OpenZones.size() == 1);
+        EndZone(cmd, 0);
+
+        // Recorded right before the submission, the GPU cannot start the frame any earlier
+        Slot& slot = m_Slots[m_CurrentSlot];
+        slot.SubmitTime = ProfilerClock::now();
+        slot.Recorded = true;
+    }
+
+    std::uint32_t VkGpuProfiler::BeginZone(VkCommandBuffer cmd, std::string_view name)
+    {
+        // Zones outside a frame, or past the limit, are not measured
+        if (m_TimestampPool == VK_NULL_HANDLE || m_OpenZones.empty())
+            return INVALID_ZONE;
+
+        Slot& slot = m_Slots[m_CurrentSlot];
+        if (slot.Zones.size() == MAX_ZONES)
+            return INVALID_ZONE;
+
+        const std::uint32_t zoneIndex = static_cast<std::uint32_t>(slot.Zones.size());
+        Zone& zone = slot.Zones.emplace_back();
+        zone.Name = name;
+        zone.Depth = static_cast<std::uint32_t>(m_OpenZones.size());
+        m_OpenZones.push_back(zoneIndex);
+
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_TimestampPool, (m_CurrentSlot * MAX_ZONES + zoneIndex) * 2);
+
+        // Statistics queries cannot nest, nested zones count towards the zone around them
+        if (m_StatisticsPool != VK_NULL_HANDLE && !m_StatisticsActive)
+        {
+            zone.StatisticsQuery = slot.StatisticsQueries++;
+            vkCmdBeginQuery(cmd, m_StatisticsPool, m_CurrentSlot * MAX_ZONES + zone.StatisticsQuery, 0);
+            m_StatisticsActive = true;
+        }
+
+        return zoneIndex;
+    }
+
+    void VkGpuProfiler::EndZone(VkCommandBuffer cmd, std::uint32_t zoneIndex)
+    {
+        if (zoneIndex == INVALID_ZONE)
+            return;
+
+        QE_ASSERT(!m_OpenZones.empty() && m_OpenZones.back() == zoneIndex);
+        m_OpenZones.pop_back();
+
+        const Zone& zone = m_Slots[m_CurrentSlot].Zones[zoneIndex];
+        if (zone.StatisticsQuery != INVALID_ZONE)
+        {
+            vkCmdEndQuery(cmd, m_StatisticsPool, m_CurrentSlot * MAX_ZONES + zone.StatisticsQuery);
+            m_StatisticsActive = false;
+        }
+
+        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_TimestampPool, (m_CurrentSlot * MAX_ZONES + zoneIndex) * 2 + 1);
+    }
+
+    void VkGpuProfiler::ReadResults(std::uint32_t slotIndex)
+    {
+        const Slot& slot = m_Slots[slotIndex];
+
+        // Never waits, every query of the slot was written by a frame the GPU has finished
+        std::vector<std::uint64_t> timestamps(slot.Zones.size() * 2);
+        VkResult result = vkGetQueryPoolResults(m_Device, m_TimestampPool, slotIndex * MAX_ZONES * 2, static_cast<std::uint32_t>(timestamps.size()),
+            timestamps.size() * sizeof(std::uint64_t), timestamps.data(), sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result == VK_NOT_READY)
+            return;
+        VK_CHECK(result);
+
+        std::vector<std::uint64_t> statistics(slot.StatisticsQueries * STATISTIC_COUNT);
+        if (slot.StatisticsQueries > 0)
+        {
+            result = vkGetQueryPoolResults(m_Device, m_StatisticsPool, slotIndex * MAX_ZONES, slot.StatisticsQueries,
+                statistics.size() * sizeof(std::uint64_t), statistics.data(), STATISTIC_COUNT * sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT);
+            if (result == VK_NOT_READY)
+                return;
+            VK_CHECK(result);
+        }
+
+        auto toMs = [this](std::uint64_t ticks) { return static_cast<double>(ticks & m_TimestampMask) * m_TimestampPeriod / 1e6; };
+        const std::uint64_t frameStart = timestamps[0];
+
+        m_LastFrame.Frame = slot.Frame;
+        m_LastFrame.SubmitTime = slot.SubmitTime;
+        m_LastFrame.StartMs = toMs(frameStart);
+        m_LastFrame.DurationMs = toMs(timestamps[1] - frameStart);
+        m_LastFrame.Zones.clear();
+
+        // The frame is zone 0, the zones inside it start at depth 0 in the profile
+        for (std::size_t i = 1; i < slot.Zones.size(); i++)
+        {
+            const Zone& zone = slot.Zones[i];
+            ProfileZone& profileZone = m_LastFrame.Zones.emplace_back();
+            profileZone.Name = zone.Name;
+            profileZone.Depth = zone.Depth - 1;
+            profileZone.StartMs = toMs(timestamps[i * 2] - frameStart);
+            profileZone.DurationMs = toMs(timestamps[i * 2 + 1] - timestamps[i * 2]);
+
+            if (zone.StatisticsQuery != INVALID_ZONE)
+            {
+                // In the order of the flag bits
+                const std::uint64_t* values = &statistics[zone.StatisticsQuery * STATISTIC_COUNT];
+                profileZone.HasStatistics = true;
+                profileZone.Statistics = { values[0], values[1], values[2], values[3], values[4] };
+            }
+        }
+    }
+}
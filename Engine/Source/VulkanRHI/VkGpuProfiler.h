@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Core/Profiler.h"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace QE
+{
+    // Times GPU zones with timestamp queries, the outermost zones of a frame also collect pipeline statistics.
+    // Every frame slot owns a range of queries that is read when the slot comes around again, after the frame
+    // scheduler has waited for it, so the results are always there and reading them never stalls.
+    class VkGpuProfiler
+    {
+    public:
+        static constexpr std::uint32_t MAX_ZONES = 64; // per frame, the frame itself included
+        static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+            | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+        // The queue family is the one frames are submitted to, without timestamps there nothing is measured
+        void Init(VkDevice device, VkPhysicalDevice physicalDevice, std::uint32_t queueFamily, std::uint32_t slotCount);
+        // Device has to be idle
+        void Destroy();
+
+        // First and last commands of a frame's command buffer. The GPU has to be done with the slot, the results
+        // of the frame that used it last are read first
+        void BeginFrame(VkCommandBuffer cmd, std::uint32_t slot, std::uint32_t frame);
+        void EndFrame(VkCommandBuffer cmd);
+
+        // Zones nest and end in reverse order within the frame's command buffer. Zones that collect pipeline
+        // statistics have to begin and end on the same side of a rendering pass
+        std::uint32_t BeginZone(VkCommandBuffer cmd, std::string_view name);
+        void EndZone(VkCommandBuffer cmd, std::uint32_t zone);
+
+        // Inherited by secondary command buffers, a zone may be collecting statistics while they execute
+        [[nodiscard]] VkQueryPipelineStatisticFlags GetInheritedStatistics() const { return m_StatisticsPool != VK_NULL_HANDLE ? PIPELINE_STATISTICS : 0; }
+
+        // Last frame the GPU finished, a frame in flight count behind the one being recorded
+        [[nodiscard]] const GpuFrameProfile& GetLastFrame() const { return m_LastFrame; }
+    private:
+        static constexpr std::uint32_t INVALID_ZONE = UINT32_MAX;
+        static constexpr std::uint32_t STATISTIC_COUNT = 5;
+
+        struct Zone
+        {
+            std::string Name;
+            std::uint32_t Depth;
+            std::uint32_t StatisticsQuery = INVALID_ZONE; // only outermost zones have one
+        };
+
+        struct Slot
+        {
+            std::vector<Zone> Zones; // the frame is zone 0
+            std::uint32_t StatisticsQueries = 0;
+            std::uint32_t Frame = UINT32_MAX;
+            ProfilerClock::time_point SubmitTime;
+            bool Recorded = false;
+        };
+
+        void ReadResults(std::uint32_t slotIndex);
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VkQueryPool m_TimestampPool = VK_NULL_HANDLE; // MAX_ZONES * 2 per slot, start and end
+        VkQueryPool m_StatisticsPool = VK_NULL_HANDLE; // MAX_ZONES per slot, null when the device has no statistics
+        float m_TimestampPeriod = 0.0f; // nanoseconds per tick
+        std::uint64_t m_TimestampMask = 0; // of the bits the queue writes
+
+        std::vector<Slot> m_Slots;
+        std::uint32_t m_CurrentSlot = 0;
+        std::vector<std::uint32_t> m_OpenZones;
+        bool m_StatisticsActive = false; // only one statistics query can be active at a time
+
+        GpuFrameProfile m_LastFrame;
+    };
+}
@@ -1,5 +1,7 @@
 #include "VkGraphicsDevice.h"
 #include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/Allocators/MemoryRegistry.h"
 
 #include "VkInit.h"
 #include "VkPipelines.h"
@@ -20,10 +22,18 @@
 
 #include "VkRHISettings.h"
 
+#include <algorithm>
 #include <array>
-#include <unordered_map>
+#include <bit>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <mutex>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 // ImGui
 #include "imgui.h"
@@ -51,27 +61,54 @@ namespace QE
 		return result;
 	}
 
-	// Resource mappings
-	std::uint32_t s_BufferCount = 0; // starting handle
-	std::unordered_map<BufferHandle, AllocatedBuffer> s_BufferMap;
+	// Binary PPM of RGBA16F pixels. Values are clamped and written without a transfer function, the same way the
+	// blit to the UNORM swapchain shows them
+	static bool WritePPM(const std::filesystem::path& path, const uint16_t* pixels, VkExtent2D extent)
+	{
+		std::error_code error;
+		if (path.has_parent_path())
+			std::filesystem::create_directories(path.parent_path(), error);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
 
-	std::uint32_t s_TextureCount = 0; // starting handle
-	std::unordered_map<TextureHandle, AllocatedImage> s_TextureMap;
+		file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+		std::vector<uint8_t> row(static_cast<size_t>(extent.width) * 3);
+		for (uint32_t y = 0; y < extent.height; y++)
+		{
+			const uint16_t* source = pixels + static_cast<size_t>(y) * extent.width * 4;
+			for (uint32_t x = 0; x < extent.width; x++)
+			{
+				for (uint32_t channel = 0; channel < 3; channel++)
+				{
+					const float value = std::clamp(glm::unpackHalf1x16(source[x * 4 + channel]), 0.0f, 1.0f);
+					row[x * 3 + channel] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+				}
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+		}
 
-	std::uint32_t s_MeshBufferCount = 0; // starting handle
-	std::unordered_map<MeshHandle, GPUMeshBuffer> s_MeshMap;
+		return static_cast<bool>(file);
+	}
 
 	VkGraphicsDevice::VkGraphicsDevice(Window* window)
 		: GraphicsDevice(window), m_Window(window) // refactor to stored in graphicsdevice
 	{
-		// Handle maps
-		s_BufferMap.reserve(1000);
-		s_TextureMap.reserve(1000);
-		s_MeshMap.reserve(1000);
-
-		// Set real window size
-		int width, height;
-		glfwGetFramebufferSize(static_cast<GLFWwindow*>(window->GetNativeWindow()), &width, &height);
+		// Resource pools
+		m_BufferPool.Reserve(1000);
+		m_TexturePool.Reserve(1000);
+		m_MeshPool.Reserve(1000);
+		m_DrawRecords.reserve(1000);
+		m_DrawKeys.reserve(1000);
+
+		// Set real window size, headless devices render at the size the window was created with
+		m_Headless = window->IsHeadless();
+		int width = window->GetScreenWidth();
+		int height = window->GetScreenHeight();
+		if (!m_Headless)
+			glfwGetFramebufferSize(static_cast<GLFWwindow*>(window->GetNativeWindow()), &width, &height);
 
 		m_WindowExtent = {
 			static_cast<uint32_t>(width),
@@ -80,7 +117,7 @@ namespace QE
 
 		// Initialize Vulkan and all needed resources
 		// Setup the instance
-		m_Instance = VkInit::CreateInstance();
+		m_Instance = VkInit::CreateInstance(m_Headless);
 		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan Instance created");
 
 		// Print extension count
@@ -101,15 +138,23 @@ namespace QE
 
 		// Setup the surface
 		// Only using GLFW for now, change this later to detect window backend later if needed
-		glfwCreateWindowSurface(m_Instance, static_cast<GLFWwindow*>(window->GetNativeWindow()), nullptr, &m_Surface);
-		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan surface created and linked to GLFWwindow");
+		if (m_Headless)
+		{
+			m_Surface = VK_NULL_HANDLE;
+			LOG_INFO_TAG("VkGraphicsDevice", "Headless, rendering offscreen at {}x{}", m_WindowExtent.width, m_WindowExtent.height);
+		}
+		else
+		{
+			glfwCreateWindowSurface(m_Instance, static_cast<GLFWwindow*>(window->GetNativeWindow()), nullptr, &m_Surface);
+			LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan surface created and linked to GLFWwindow");
+		}
 
 		// Pick a GPU
 		m_PhysicalDevice = VkInit::PickPhysicalDevice(m_Instance, m_Surface);
 		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan device created");
 
 		// Logical device creation
-		m_Device = VkInit::CreateLogicalDevice(m_PhysicalDevice, m_Surface, &m_GraphicsQueue, &m_PresentQueue);
+		m_Device = VkInit::CreateLogicalDevice(m_PhysicalDevice, m_Surface, &m_GraphicsQueue, &m_PresentQueue, &m_TransferQueue);
 		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan physical device created");
 
 		// VMA Allocator
@@ -130,10 +175,20 @@ namespace QE
 		// Set the queue family indices
 		m_QueueFamilyIndices = VkInit::FindQueueFamilies(m_PhysicalDevice, m_Surface);
 
+		// Uploads go through the dedicated transfer queue when there is one
+		m_UploadQueue.Init(m_Device, m_Allocator, m_TransferQueue, m_QueueFamilyIndices.transferFamily.value_or(m_QueueFamilyIndices.graphicsFamily.value()));
+		LOG_DEBUG_TAG("VkGraphicsDevice", "Upload queue created, dedicated transfer queue: {}", m_QueueFamilyIndices.transferFamily.has_value());
+
+		// Shared vertex and index buffers for all meshes
+		std::vector<uint32_t> meshQueueFamilies = { m_QueueFamilyIndices.graphicsFamily.value() };
+		if (m_QueueFamilyIndices.transferFamily.has_value())
+			meshQueueFamilies.push_back(m_QueueFamilyIndices.transferFamily.value());
+		m_MeshArena.Init(m_Device, m_Allocator, &m_UploadQueue, meshQueueFamilies);
+
 		// Swapchain
 		InitSwapchain(m_WindowExtent);
 
-		// Frame semaphores and fences
+		// Frame semaphores and the frame timeline
 		InitializeFrameData();
 		// Command pools and buffers
 		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan command pools and buffers created");
@@ -141,6 +196,15 @@ namespace QE
 		// Descriptors
 		InitializeDescriptors();
 
+		// Shaders are compiled from source at runtime, unchanged ones come out of the SPIR-V cache
+		m_ShaderCompiler.Init(std::filesystem::path(QE_RESOURCES_FOLDER) / "Shaders", std::filesystem::path(QE_RESOURCES_FOLDER) / "ShaderCache" / "Compiled");
+		if (m_ShaderWatcher.Watch(std::filesystem::path(QE_RESOURCES_FOLDER) / "Shaders"))
+			LOG_DEBUG_TAG("VkGraphicsDevice", "Watching shader sources for hot reload");
+
+		// Pipeline cache left behind by the last run, kept in the working directory next to the logs since it is
+		// specific to this machine's GPU and driver
+		m_PipelineCache.Init(m_Device, m_PhysicalDevice, std::filesystem::path("cache") / "pipelines.bin");
+
 		// Graphics pipeline
 		//InitializeTrianglePipeline();
 		//VkInit::CreateGraphicsPipeline(m_Device, m_SwapchainImageFormat, &m_PipelineLayout);
@@ -155,29 +219,68 @@ namespace QE
 	{
 		vkDeviceWaitIdle(m_Device);
 
+		WriteCompletedCaptures(UINT32_MAX);
+		m_FrameScheduler.Destroy();
+		m_DrawRecorder.Destroy();
+		m_RenderGraph.Destroy();
+		m_GpuProfiler.Destroy();
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
 			vkFreeCommandBuffers(m_Device, m_FrameData[i].CommandPool, 1, &m_FrameData[i].CommandBuffer);
 			vkDestroyCommandPool(m_Device, m_FrameData[i].CommandPool, nullptr);
 
-			vkDestroyFence(m_Device, m_FrameData[i].RenderFence, nullptr);
 			vkDestroySemaphore(m_Device, m_FrameData[i].RenderSemaphore, nullptr);
 			vkDestroySemaphore(m_Device, m_FrameData[i].SwapchainSemaphore, nullptr);
-		}
 
-		// Flush global lifetime deletion queue
-		m_CleanupQueue.Flush();
+			DestroyBuffer(m_FrameData[i].SceneDataBuffer);
+			if (m_FrameData[i].InstanceCapacity > 0)
+			{
+				DestroyBuffer(m_FrameData[i].InstanceBuffer);
+				DestroyBuffer(m_FrameData[i].VisibleInstanceBuffer);
+			}
+			if (m_FrameData[i].DrawCapacity > 0)
+			{
+				DestroyBuffer(m_FrameData[i].DrawBuffer);
+				DestroyBuffer(m_FrameData[i].DrawCommandBuffer);
+			}
+		}
 
-		// Buffers
-		for (auto& [handle, buffer] : s_BufferMap)
+		// Resources still owned by the pools
+		for (const AllocatedBuffer& buffer : m_BufferPool.GetObjects())
 			DestroyBuffer(buffer);
+		for (const GPUTexture& texture : m_TexturePool.GetObjects())
+			DestroyImage(texture.Image);
+		m_MeshPool.Clear();
+		m_BufferPool.Clear();
+		m_TexturePool.Clear();
+
+		// Reloadable pipelines are swapped at runtime, so they are not in the lifetime queue
+		for (const ReloadablePipeline& reloadable : m_ReloadablePipelines)
+			vkDestroyPipeline(m_Device, *reloadable.Pipeline, nullptr);
+		m_ReloadablePipelines.clear();
+
+		m_BindlessTextures.Destroy();
+		m_PipelineCache.Destroy();
+		m_MeshArena.Destroy();
+		m_UploadQueue.Destroy();
+
+		// Draw targets are reallocated on resize, so they live in the frame queue
+		RetireDrawTargets();
+
+		// Flush the deletion queues, the lifetime cleanup queue goes last since it destroys the allocator
+		m_FrameDeletionQueue.FlushAll(m_Device, m_Allocator);
+		m_LifetimeDeletionQueue.FlushAll(m_Device, m_Allocator);
+		m_CleanupQueue.Flush();
 
 		// Cleanup all resources
 		//vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
 
-		DestroySwapchain();
-
-		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+		// Headless devices never created a surface or swapchain, nor loaded the extensions to destroy them
+		if (!m_Headless)
+		{
+			DestroySwapchain();
+			vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+		}
 		vkDestroyDevice(m_Device, nullptr);
 
 		if (VkInit::s_EnableValidationLayers)
@@ -188,17 +291,93 @@ namespace QE
 
 	void VkGraphicsDevice::BeginFrame()
 	{
-		// Wait for the previous frame to finish
-		vkWaitForFences(m_Device, 1, &GetCurrentFrameData().RenderFence, VK_TRUE, UINT64_MAX);
-		vkResetFences(m_Device, 1, &GetCurrentFrameData().RenderFence);
+		// Only CPU side work here, the wait for the GPU is left to BeginFrameRecording so the game's update
+		// overlaps with the frames still in flight
+		m_FrameScheduler.BeginFrame();
+		m_FrameRecording = false;
 
-		// See if there is a better place later
-		GetCurrentFrameData().CleanupQueue.Flush();
-		GetCurrentFrameData().FrameDescriptors.ClearPools(m_Device);
+		// Slots map to frames by the count, so it only changes once the GPU has caught up
+		if (m_PendingFramesInFlight != 0)
+		{
+			m_FrameScheduler.WaitIdle();
+			m_FrameScheduler.SetFramesInFlight(m_PendingFramesInFlight);
+			m_PendingFramesInFlight = 0;
+			LOG_INFO_TAG("VkGraphicsDevice", "Frames in flight set to {}", m_FrameScheduler.GetFramesInFlight());
+		}
+
+		// Recycle staging memory from uploads that have landed
+		m_UploadQueue.Update();
+		ReclaimCompletedFrames();
+		CompactMeshArena();
+
+		// Swapped at the frame boundary, nothing has been recorded with the old pipelines yet this frame
+		ReloadChangedShaders();
+
+		// A minimized window has nothing to present to, wait until it comes back
+		if (m_ResizeRequested && (m_WindowExtent.width == 0 || m_WindowExtent.height == 0))
+			m_Window->PauseWindow();
+
+		// Imgui, headless runs have no platform backend to fill in the display and the time step
+		if (m_Headless)
+		{
+			ImGuiIO& io = ImGui::GetIO();
+			io.DisplaySize = ImVec2(static_cast<float>(m_WindowExtent.width), static_cast<float>(m_WindowExtent.height));
+			io.DeltaTime = HEADLESS_DELTA_TIME;
+		}
+		else
+		{
+			ImGui_ImplVulkan_NewFrame();
+			ImGui_ImplGlfw_NewFrame();
+		}
+		ImGui::NewFrame();
+
+		// Draw triangle
+		//DrawTriangle(GetCurrentFrameData().CommandBuffer);
+	}
+
+	void VkGraphicsDevice::BeginFrameRecording()
+	{
+		if (m_FrameRecording)
+			return;
+		m_FrameRecording = true;
 
+		// The latest point to wait, the slot's buffers, descriptors and command buffer are about to be reused
+		{
+			QE_PROFILE_SCOPE("Wait for GPU");
+			m_FrameScheduler.WaitForSlot(m_CurrentFrameNumber);
+		}
+		ReclaimCompletedFrames();
+		GetCurrentFrameData().FrameDescriptors.ClearPools(m_Device);
+		m_DrawRecorder.ResetSlot(m_FrameScheduler.GetSlot(m_CurrentFrameNumber));
+
+		// Resize events only flag the swapchain, it is rebuilt here at most once per frame however many came in
+		if (m_ResizeRequested)
+			RecreateSwapchain();
+
+		// Request the image from the swapchain, headless frames only render into the draw image
+		VkResult acquireResult = VK_SUCCESS;
+		if (!m_Headless)
+			acquireResult = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, GetCurrentFrameData().SwapchainSemaphore, VK_NULL_HANDLE, &m_CurrentSwapchainImageIndex);
+		if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR && RecreateSwapchain())
+			acquireResult = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, GetCurrentFrameData().SwapchainSemaphore, VK_NULL_HANDLE, &m_CurrentSwapchainImageIndex);
+
+		// Suboptimal images can still be presented, the swapchain is rebuilt next frame
+		if (acquireResult == VK_SUBOPTIMAL_KHR)
+			m_ResizeRequested = true;
+		else if (acquireResult != VK_ERROR_OUT_OF_DATE_KHR)
+			VK_CHECK(acquireResult);
+
+		// Without an image the frame is skipped, draws are still accepted and dropped in EndFrame
+		m_FrameSkipped = acquireResult == VK_ERROR_OUT_OF_DATE_KHR;
+		if (m_FrameSkipped)
+		{
+			m_ResizeRequested = true;
+			return;
+		}
 
-		// Request the image from the swapchain
-		vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, GetCurrentFrameData().SwapchainSemaphore, VK_NULL_HANDLE, &m_CurrentSwapchainImageIndex);
+		// Dynamic resolution renders into the top left part of the draw targets, the copy to the swapchain scales it up
+		m_DrawExtent.width = std::max(1u, static_cast<uint32_t>(std::min(m_SwapchainExtent.width, m_DrawImage.ImageExtent.width) * m_RenderScale));
+		m_DrawExtent.height = std::max(1u, static_cast<uint32_t>(std::min(m_SwapchainExtent.height, m_DrawImage.ImageExtent.height) * m_RenderScale));
 
 		// Reset command buffer
 		vkResetCommandBuffer(GetCurrentFrameData().CommandBuffer, 0);
@@ -206,37 +385,133 @@ namespace QE
 		// Begin the buffer for recording
 		VkCommandBufferBeginInfo beginInfo = VkInit::BuildCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 		VK_CHECK(vkBeginCommandBuffer(GetCurrentFrameData().CommandBuffer, &beginInfo));
+		m_GpuProfiler.BeginFrame(GetCurrentFrameData().CommandBuffer, m_FrameScheduler.GetSlot(m_CurrentFrameNumber), m_CurrentFrameNumber);
 
-		// transition our main draw image into general layout so we can write into it
-		// we will overwrite it all so we dont care about what was the older layout
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_DrawImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_DrawImage.Image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_DepthImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
-		// Imgui
-		ImGui_ImplVulkan_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
+		// Layout transitions are left to the render graph in EndFrame
+	}
 
-		// Draw triangle
-		//DrawTriangle(GetCurrentFrameData().CommandBuffer);
+	void VkGraphicsDevice::ReclaimCompletedFrames()
+	{
+		// Everything retired up to the last finished frame is no longer in use by the GPU
+		const std::uint64_t completedFrames = m_FrameScheduler.GetCompletedFrames();
+		if (completedFrames == 0)
+			return;
+
+		const uint32_t completedFrame = static_cast<uint32_t>(completedFrames - 1);
+		WriteCompletedCaptures(completedFrame);
+		m_FrameDeletionQueue.Flush(m_Device, m_Allocator, completedFrame);
+		m_MeshArena.Update(completedFrame);
+		m_BindlessTextures.Update(completedFrame);
+	}
+
+	void VkGraphicsDevice::CompactMeshArena()
+	{
+		if (!m_MeshArena.NeedsCompaction())
+			return;
+
+		// Nothing has been submitted this frame yet, draws read the new offsets when the draw list is flushed
+		std::span<GPUMeshBuffer> meshBuffers = m_MeshPool.GetObjects();
+		std::vector<MeshRange> ranges(meshBuffers.size());
+		std::vector<MeshRange*> rangePointers(meshBuffers.size());
+		for (size_t i = 0; i < meshBuffers.size(); i++)
+		{
+			ranges[i].Vertices = { meshBuffers[i].VertexOffset, meshBuffers[i].VertexCount };
+			ranges[i].Indices = { meshBuffers[i].FirstIndex, meshBuffers[i].IndexCount };
+			rangePointers[i] = &ranges[i];
+		}
+
+		m_MeshArena.Compact(rangePointers, m_CurrentFrameNumber);
+
+		for (size_t i = 0; i < meshBuffers.size(); i++)
+		{
+			meshBuffers[i].VertexOffset = ranges[i].Vertices.Offset;
+			meshBuffers[i].FirstIndex = ranges[i].Indices.Offset;
+		}
 	}
 
 	void VkGraphicsDevice::EndFrame()
 	{
-		// Transition the draw image and the swapchain image into their correct transfer layouts
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_DrawImage.Image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_SwapchainImages[m_CurrentSwapchainImageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		BeginFrameRecording();
+
+		if (m_FrameSkipped)
+		{
+			// Keep ImGui's frames balanced even though nothing is rendered
+			ClearDrawList();
+			ImGui::EndFrame();
+
+			// The request was for this frame, a later one would capture a different image under its name
+			if (!m_CaptureRequest.empty())
+			{
+				LOG_WARN_TAG("VkGraphicsDevice", "Dropping the capture of {}, the frame was skipped", m_CaptureRequest);
+				m_CaptureRequest.clear();
+			}
+			return;
+		}
 
-		// Execute a copy from the draw image into the swapchain
-		VkInit::CopyImageToImage(GetCurrentFrameData().CommandBuffer, m_DrawImage.Image, m_SwapchainImages[m_CurrentSwapchainImageIndex], m_DrawExtent, m_SwapchainExtent);
+		// Headless frames have nowhere to draw ImGui and add no ImGui pass, ending the frame is enough to keep it balanced
+		if (m_Headless)
+			ImGui::EndFrame();
+		else
+			ImGui::Render();
+
+		// The frame's passes, the graph works out the barriers between them
+		m_RenderGraph.Reset();
+		const RGImage drawImage = m_RenderGraph.ImportImage("Draw", m_DrawImage.Image, m_DrawImage.ImageView, VK_IMAGE_ASPECT_COLOR_BIT, &m_DrawImageState);
+		const RGImage depthImage = m_RenderGraph.CreateImage("Depth", { DEPTH_FORMAT, m_DrawImage.ImageExtent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT });
+
+		// Everything submitted this frame goes out in one render pass
+		m_RenderGraph.AddPass("Mesh",
+			[&](VkRenderGraph::PassBuilder& pass) {
+				pass.Overwrite(drawImage, ResourceUsage::ColorAttachment);
+				pass.Overwrite(depthImage, ResourceUsage::DepthAttachment);
+			},
+			[this, depthImage](VkCommandBuffer cmd) { FlushDrawList(cmd, m_RenderGraph.GetImageView(depthImage)); });
+
+		// The capture is the scene without ImGui, windowed or headless
+		if (!m_CaptureRequest.empty())
+		{
+			m_RenderGraph.AddPass("Capture",
+				[&](VkRenderGraph::PassBuilder& pass) {
+					pass.Read(drawImage, ResourceUsage::TransferSrc);
+					pass.SetSideEffect();
+				},
+				[this](VkCommandBuffer cmd) { RecordFrameCapture(cmd); });
+		}
 
-		// Set swapchain image layout to Present so we can show it on the screen
-		VkInit::TransitionImage(GetCurrentFrameData().CommandBuffer, m_SwapchainImages[m_CurrentSwapchainImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		// The acquired image is undefined, the submission waits for it at the stages the first barrier starts from
+		ResourceState swapchainState = { VK_IMAGE_LAYOUT_UNDEFINED, SWAPCHAIN_ACQUIRE_STAGES, VK_ACCESS_2_NONE };
+		if (!m_Headless)
+		{
+			const RGImage swapchainImage = m_RenderGraph.ImportImage("Swapchain", m_SwapchainImages[m_CurrentSwapchainImageIndex],
+				m_SwapchainImageViews[m_CurrentSwapchainImageIndex], VK_IMAGE_ASPECT_COLOR_BIT, &swapchainState);
+
+			m_RenderGraph.AddPass("Blit",
+				[&](VkRenderGraph::PassBuilder& pass) {
+					pass.Read(drawImage, ResourceUsage::TransferSrc);
+					pass.Overwrite(swapchainImage, ResourceUsage::TransferDst);
+				},
+				[this](VkCommandBuffer cmd) {
+					VkInit::CopyImageToImage(cmd, m_DrawImage.Image, m_SwapchainImages[m_CurrentSwapchainImageIndex], m_DrawExtent, m_SwapchainExtent);
+				});
+
+			m_RenderGraph.AddPass("ImGui",
+				[&](VkRenderGraph::PassBuilder& pass) { pass.Write(swapchainImage, ResourceUsage::ColorAttachment); },
+				[this](VkCommandBuffer cmd) { DrawImGui(cmd, m_SwapchainImageViews[m_CurrentSwapchainImageIndex]); });
+
+			// Records nothing, it only leaves the image in the present layout
+			m_RenderGraph.AddPass("Present",
+				[&](VkRenderGraph::PassBuilder& pass) {
+					pass.Read(swapchainImage, ResourceUsage::Present);
+					pass.SetSideEffect();
+				},
+				[](VkCommandBuffer) {});
+		}
 
-		// Render ImGui
-		ImGui::Render();
-		// Draw imgui
-		DrawImGui(GetCurrentFrameData().CommandBuffer, m_SwapchainImageViews[m_CurrentSwapchainImageIndex]);
+		{
+			QE_PROFILE_SCOPE("Render graph");
+			m_RenderGraph.Execute(GetCurrentFrameData().CommandBuffer, m_FrameDeletionQueue, m_CurrentFrameNumber);
+		}
+		m_GpuProfiler.EndFrame(GetCurrentFrameData().CommandBuffer);
 
 		// End command buffer recording
 		VK_CHECK(vkEndCommandBuffer(GetCurrentFrameData().CommandBuffer));
@@ -244,15 +519,41 @@ namespace QE
 		// Submit command buffer to the graphics queue
 		VkCommandBufferSubmitInfo cmdSubmitInfo = VkInit::BuildCommandBufferSubmitInfo(GetCurrentFrameData().CommandBuffer);
 
-		VkSemaphoreSubmitInfo waitInfo = VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,GetCurrentFrameData().SwapchainSemaphore);
-		VkSemaphoreSubmitInfo signalInfo = VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, GetCurrentFrameData().RenderSemaphore);
+		QE_PROFILE_SCOPE("Submit");
 
-		VkSubmitInfo2 submitInfo = VkInit::BuildSubmitInfo2(&cmdSubmitInfo, &signalInfo, &waitInfo);
-		VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submitInfo, GetCurrentFrameData().RenderFence));
+		// Send off the uploads recorded up to now, the frame waits on them before it runs
+		UploadToken uploads = m_UploadQueue.Submit();
+
+		VkSemaphoreSubmitInfo waitInfos[2] = {
+			VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_UploadQueue.GetTimelineSemaphore()),
+			VkInit::BuildSemaphoreSubmitInfo(SWAPCHAIN_ACQUIRE_STAGES, GetCurrentFrameData().SwapchainSemaphore)
+		};
+		waitInfos[0].value = uploads.Value;
+		// The timeline value tells the CPU the frame is done, the binary semaphore is for presenting
+		VkSemaphoreSubmitInfo signalInfos[2] = {
+			m_FrameScheduler.BuildSignalInfo(m_CurrentFrameNumber),
+			VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, GetCurrentFrameData().RenderSemaphore)
+		};
+
+		// Headless frames neither acquire nor present, only the timelines are used
+		VkSubmitInfo2 submitInfo = VkInit::BuildSubmitInfo2(&cmdSubmitInfo, signalInfos, waitInfos);
+		submitInfo.waitSemaphoreInfoCount = m_Headless ? 1 : 2;
+		submitInfo.signalSemaphoreInfoCount = m_Headless ? 1 : 2;
+		VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+		m_FrameScheduler.OnSubmitted(m_CurrentFrameNumber);
 	}
 
 	void VkGraphicsDevice::PresentFrame()
 	{
+		if (m_FrameSkipped)
+			return;
+
+		if (m_Headless)
+		{
+			m_CurrentFrameNumber++;
+			return;
+		}
+
 		//LOG_DEBUG_TAG("VkGraphicsDevice", "Presenting frame: {0}", m_CurrentFrameNumber);
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -265,17 +566,72 @@ namespace QE
 
 		presentInfo.pImageIndices = &m_CurrentSwapchainImageIndex;
 
-		// Present the image
-		VK_CHECK(vkQueuePresentKHR(m_PresentQueue, &presentInfo));
+		// Present the image, an out of date swapchain is rebuilt at the start of the next frame
+		VkResult presentResult = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+		if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR)
+			m_ResizeRequested = true;
+		else
+			VK_CHECK(presentResult);
 
 		m_CurrentFrameNumber++;
 	}
 
 	void VkGraphicsDevice::UpdateWindowSize(uint32_t width, uint32_t height)
 	{
-		LOG_DEBUG_TAG("VkGraphicsDevice", "Updating window size: {0}x{1}", width, height);
+		// Called for every resize event while the window is dragged, only the latest size is kept
 		m_WindowExtent = { width, height };
-		RecreateSwapchain();
+		m_ResizeRequested = true;
+	}
+
+	void VkGraphicsDevice::SetRenderScale(float scale)
+	{
+		m_RenderScale = std::clamp(scale, MIN_RENDER_SCALE, 1.0f);
+	}
+
+	float VkGraphicsDevice::GetRenderScale() const
+	{
+		return m_RenderScale;
+	}
+
+	void VkGraphicsDevice::SetFramesInFlight(uint32_t count)
+	{
+		count = std::clamp(count, VkFrameScheduler::MIN_FRAMES_IN_FLIGHT, VkFrameScheduler::MAX_FRAMES_IN_FLIGHT);
+		m_PendingFramesInFlight = count != m_FrameScheduler.GetFramesInFlight() ? count : 0;
+	}
+
+	uint32_t VkGraphicsDevice::GetFramesInFlight() const
+	{
+		return m_PendingFramesInFlight != 0 ? m_PendingFramesInFlight : m_FrameScheduler.GetFramesInFlight();
+	}
+
+	void VkGraphicsDevice::SetConservativeBarriers(bool conservative)
+	{
+		VkBarrierBatcher::SetConservative(conservative);
+	}
+
+	bool VkGraphicsDevice::GetConservativeBarriers() const
+	{
+		return VkBarrierBatcher::IsConservative();
+	}
+
+	const GpuFrameProfile& VkGraphicsDevice::GetGpuFrameProfile() const
+	{
+		return m_GpuProfiler.GetLastFrame();
+	}
+
+	const FramePacingStats& VkGraphicsDevice::GetFramePacingStats() const
+	{
+		return m_FrameScheduler.GetStats();
+	}
+
+	const RenderGraphStats& VkGraphicsDevice::GetRenderGraphStats() const
+	{
+		return m_RenderGraph.GetStats();
+	}
+
+	void VkGraphicsDevice::CaptureFrame(const std::string& path)
+	{
+		m_CaptureRequest = path;
 	}
 
 	std::unique_ptr<GraphicsContext> VkGraphicsDevice::CreateGraphicsContext()
@@ -288,167 +644,169 @@ namespace QE
 		vkDeviceWaitIdle(m_Device);
 	}
 
-	BufferHandle VkGraphicsDevice::CreateBuffer(BufferDescription desc)
+	BufferHandle VkGraphicsDevice::CreateBuffer(const BufferDescription& desc)
 	{
 		LOG_DEBUG("Creating Buffer");
-		BufferHandle handle = { s_BufferCount++ };
 
 		VkBufferUsageFlags usageFlagsConverted = BufferTypeFlagsFromRHI(desc.Type) | BufferUsageFlagsFromRHI(desc.Usage);
 		// We use buffer device addressing in the Vulkan backend, so force this if it is a vertex buffer
 		if (desc.Type == BufferType::Vertex)
 			usageFlagsConverted |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 		VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
-		AllocatedBuffer allocatedBuffer = AllocateBuffer(desc.DataSize, usageFlagsConverted, memoryUsage);
+		AllocatedBuffer allocatedBuffer = AllocateBuffer(desc.Data.Size(), usageFlagsConverted, memoryUsage);
 		allocatedBuffer.Size = desc.Count;
 		LOG_DEBUG("Buffer size (count): {}", desc.Count);
-		UploadDataToBuffer(allocatedBuffer, desc.Data.data(), desc.DataSize);
+		UploadDataToBuffer(allocatedBuffer, desc.Data.Data(), desc.Data.Size());
 
-		s_BufferMap[handle] = allocatedBuffer;
-
-		return handle;
+		return m_BufferPool.Insert(allocatedBuffer);
 	}
 
-	TextureHandle VkGraphicsDevice::CreateTexture(TextureDescription desc)
+	TextureHandle VkGraphicsDevice::CreateTexture(const TextureDescription& desc)
 	{
 		LOG_DEBUG("Creating Texture");
-		TextureHandle handle = { s_TextureCount++ };
-
-		AllocatedImage texture = CreateImage(desc.Data.data(), {desc.ImageWidth, desc.ImageHeight, desc.ImageDepth}, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT);
-		s_TextureMap[handle] = texture;
 
-		return handle;
+		GPUTexture texture{};
+		texture.Image = CreateImage(desc.Data.Data(), {desc.ImageWidth, desc.ImageHeight, desc.ImageDepth}, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT);
+		// Written into the bindless table once, a full table falls back to the error texture when drawn
+		texture.BindlessIndex = m_BindlessTextures.Register(texture.Image.ImageView, m_DefaultSamplerNearest);
+		return m_TexturePool.Insert(texture);
 	}
 
 	MeshHandle VkGraphicsDevice::CreateMesh(std::span<Vertex> vertices, std::span<uint32_t> indices)
 	{
-		GPUMeshBuffer newMeshBuffer{};
+		// The data goes straight from the caller's memory to the staging buffer
+		MeshRange range = m_MeshArena.Allocate(vertices, indices, m_CurrentFrameNumber);
+		if (!range.IsValid())
+			return {};
 
-		//create vertex buffer
-		std::vector<std::uint8_t> verticesbuff;
-		verticesbuff.resize(vertices.size() * sizeof(Vertex));
-		memcpy(verticesbuff.data(), vertices.data(), verticesbuff.size());
-		BufferDescription verticesDesc = {
-			BufferType::Vertex,
-			BufferUsage::Default,
-			verticesbuff,
-			vertices.size() * sizeof(Vertex),
-			vertices.size()
-		};
-		BufferHandle vertexBuff = CreateBuffer(verticesDesc);
-
-		//find the address of the vertex buffer
-		VkBufferDeviceAddressInfo deviceAdressInfo{
-			.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-			.buffer = GetBufferFromHandle(vertexBuff).Buffer,
-		};
-		newMeshBuffer.VertexBufferAddress = vkGetBufferDeviceAddress(m_Device, &deviceAdressInfo);
-
-		//create index buffer
-		std::vector<std::uint8_t> indicesbuff(indices.size());
-		indicesbuff.resize(indices.size() * sizeof(std::uint32_t));
-		memcpy(indicesbuff.data(), indices.data(), indicesbuff.size());
-		BufferDescription indicesDesc = {
-			BufferType::Index,
-			BufferUsage::Default,
-			indicesbuff,
-			indices.size() * sizeof(std::uint32_t),
-			indices.size()
-		};
-		BufferHandle indexBuff = CreateBuffer(indicesDesc);
+		GPUMeshBuffer newMeshBuffer{};
+		newMeshBuffer.VertexOffset = range.Vertices.Offset;
+		newMeshBuffer.VertexCount = range.Vertices.Size;
+		newMeshBuffer.FirstIndex = range.Indices.Offset;
+		newMeshBuffer.IndexCount = range.Indices.Size;
+
+		// Bounding sphere for culling, centered on the bounding box which is close enough for our meshes
+		glm::vec3 minPosition(std::numeric_limits<float>::max());
+		glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+		for (const Vertex& vertex : vertices)
+		{
+			minPosition = glm::min(minPosition, vertex.Position);
+			maxPosition = glm::max(maxPosition, vertex.Position);
+		}
 
-		newMeshBuffer.VertexBuffer = vertexBuff;
-		newMeshBuffer.IndexBuffer = indexBuff;
+		glm::vec3 center = vertices.empty() ? glm::vec3(0.0f) : (minPosition + maxPosition) * 0.5f;
+		float radius = 0.0f;
+		for (const Vertex& vertex : vertices)
+			radius = std::max(radius, glm::distance(center, vertex.Position));
+		newMeshBuffer.BoundingSphere = glm::vec4(center, radius);
 
-		MeshHandle newMeshHandle {s_MeshBufferCount++ };
-		s_MeshMap[newMeshHandle] = newMeshBuffer;
-		return newMeshHandle;
+		return m_MeshPool.Insert(newMeshBuffer);
 	}
 
-	void VkGraphicsDevice::DrawMesh(MeshHandle mesh, TextureHandle* texture)
+	void VkGraphicsDevice::DestroyBuffer(BufferHandle buffer)
 	{
-		GPUMeshBuffer meshBuffer = s_MeshMap[mesh];
-		AllocatedBuffer vertexBuffer = GetBufferFromHandle(meshBuffer.VertexBuffer);
-		AllocatedBuffer indexBuffer = GetBufferFromHandle(meshBuffer.IndexBuffer);
+		AllocatedBuffer* allocatedBuffer = m_BufferPool.Get(buffer);
+		if (!allocatedBuffer)
+		{
+			LOG_WARN_TAG("VkGraphicsDevice", "DestroyBuffer called with a stale buffer handle ({}, gen {})", buffer.Index, buffer.Generation);
+			return;
+		}
 
-		//begin a render pass  connected to our draw image
-		VkClearValue clearValue = {0.0f, 0.0f, 0.0f, 1.0f};
-		VkRenderingAttachmentInfo colorAttachment = VkInit::BuildRenderingAttachmentInfo(m_DrawImage.ImageView, &clearValue, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-		VkRenderingAttachmentInfo depthAttachment = VkInit::BuildDepthAttachment(m_DepthImage.ImageView, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+		DeferDestroyBuffer(*allocatedBuffer);
+		m_BufferPool.Remove(buffer);
+	}
 
-		VkRenderingInfo renderInfo = VkInit::BuildRenderingInfo(m_DrawExtent, &colorAttachment, &depthAttachment);
-		// Get the current command buffer
-		VkCommandBuffer cmd = GetCurrentFrameData().CommandBuffer;
-		vkCmdBeginRendering(cmd, &renderInfo);
+	void VkGraphicsDevice::DestroyTexture(TextureHandle texture)
+	{
+		GPUTexture* gpuTexture = m_TexturePool.Get(texture);
+		if (!gpuTexture)
+		{
+			LOG_WARN_TAG("VkGraphicsDevice", "DestroyTexture called with a stale texture handle ({}, gen {})", texture.Index, texture.Generation);
+			return;
+		}
 
-		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshPipeline);
+		m_BindlessTextures.Release(gpuTexture->BindlessIndex, m_CurrentFrameNumber);
+		DeferDestroyImage(gpuTexture->Image);
+		m_TexturePool.Remove(texture);
+	}
 
-		// Bind a texture
-		VkDescriptorSet imageSet = GetCurrentFrameData().FrameDescriptors.Allocate(m_Device, m_SingleImageDescriptorLayout);
+	void VkGraphicsDevice::DestroyMesh(MeshHandle mesh)
+	{
+		GPUMeshBuffer* meshBuffer = m_MeshPool.Get(mesh);
+		if (!meshBuffer)
 		{
-			DescriptorWriter writer;
-			if (texture)
-			{
-				AllocatedImage tex = GetTextureFromHandle(*texture);
-				writer.WriteImage(0, tex.ImageView, m_DefaultSamplerNearest, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-			} else
-			{
-				writer.WriteImage(0, m_ErrorCheckerboardImage.ImageView, m_DefaultSamplerNearest, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-			}
-
-			writer.UpdateSet(m_Device, imageSet);
+			LOG_WARN_TAG("VkGraphicsDevice", "DestroyMesh called with a stale mesh handle ({}, gen {})", mesh.Index, mesh.Generation);
+			return;
 		}
 
-		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshPipelineLayout, 0, 1, &imageSet, 0, nullptr);
+		MeshRange range;
+		range.Vertices = { meshBuffer->VertexOffset, meshBuffer->VertexCount };
+		range.Indices = { meshBuffer->FirstIndex, meshBuffer->IndexCount };
+		m_MeshArena.Free(range, m_CurrentFrameNumber);
 
-		//set dynamic viewport and scissor
-		VkViewport viewport = {};
-		viewport.x = 0;
-		viewport.y = 0;
-		viewport.width = m_DrawExtent.width;
-		viewport.height = m_DrawExtent.height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+		m_MeshPool.Remove(mesh);
+	}
 
-		vkCmdSetViewport(cmd, 0, 1, &viewport);
+	void VkGraphicsDevice::SubmitDraw(const DrawPacket& packet)
+	{
+		DrawMeshInstanced(packet.Mesh, packet.Texture, std::span<const glm::mat4>(&packet.Transform, 1));
+	}
 
-		VkRect2D scissor = {};
-		scissor.offset.x = 0;
-		scissor.offset.y = 0;
-		scissor.extent.width = m_DrawExtent.width;
-		scissor.extent.height = m_DrawExtent.height;
+	void VkGraphicsDevice::DrawMeshInstanced(MeshHandle mesh, TextureHandle texture, std::span<const glm::mat4> transforms)
+	{
+		if (!m_MeshPool.Get(mesh))
+		{
+			LOG_ERROR_TAG("VkGraphicsDevice", "DrawMeshInstanced called with a stale mesh handle ({}, gen {})", mesh.Index, mesh.Generation);
+			return;
+		}
 
-		vkCmdSetScissor(cmd, 0, 1, &scissor);
+		if (transforms.empty())
+			return;
 
-		// Gross but leaving for now
-		static auto startTime = std::chrono::high_resolution_clock::now();
+		// Transforms go straight into the frame's mapped instance buffer, the draw index is filled in by FlushDrawList
+		BeginFrameRecording();
+		FrameData& frame = GetCurrentFrameData();
+		const uint32_t instanceCount = static_cast<uint32_t>(transforms.size());
+		EnsureInstanceCapacity(frame, frame.InstanceCount + instanceCount);
 
-		auto currentTime = std::chrono::high_resolution_clock::now();
-		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-		// Push constants for MVP
-		ModelViewProjection mvp = {};
-		mvp.Model = glm::mat4(1.0f);
-		mvp.View = m_Camera->GetViewMatrix();
-		// reverse near and far plane because using reverse-Z depth
-		// https://developer.nvidia.com/blog/visualizing-depth-precision/
-		mvp.Projection = ReversedZPerspective(glm::radians(m_Camera->Zoom), (float)m_SwapchainExtent.width / (float)m_SwapchainExtent.height, 0.1f);
+		GPUInstanceData* instances = static_cast<GPUInstanceData*>(frame.InstanceBuffer.AllocationInfo.pMappedData) + frame.InstanceCount;
+		for (uint32_t i = 0; i < instanceCount; i++)
+			instances[i].Transform = transforms[i];
 
-		GPUDrawPushConstants pushConstants{};
-		pushConstants.MVP = mvp;
-		pushConstants.MeshBufferAddress = meshBuffer.VertexBufferAddress;
+		// Pipeline in the top bits, then mesh, so sorting puts every instance of a mesh in the same draw.
+		// Textures are bindless and picked per instance, they do not split draws
+		const std::uint64_t pipelineKey = 0; // only the mesh pipeline for now
+		const std::uint64_t key = (pipelineKey << 56) | mesh.Index;
 
-		vkCmdPushConstants(cmd, m_MeshPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GPUDrawPushConstants), &pushConstants);
+		m_DrawKeys.push_back({ key, static_cast<std::uint32_t>(m_DrawRecords.size()), instanceCount });
+		m_DrawRecords.push_back({ mesh, texture, frame.InstanceCount, instanceCount });
+		frame.InstanceCount += instanceCount;
+	}
 
-		// Bind vertex buffer
-		//VkDeviceSize offsets[] = {0};
-		//vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer.Buffer, offsets);
+	const DrawStats& VkGraphicsDevice::GetDrawStats() const
+	{
+		return m_DrawStats;
+	}
 
-		// Bind index buffer
-		vkCmdBindIndexBuffer(cmd, indexBuffer.Buffer, 0, VK_INDEX_TYPE_UINT32);
+	void VkGraphicsDevice::SetRecordThreads(uint32_t count)
+	{
+		// Only read when the draw list is flushed, the next flush uses the new count
+		m_DrawRecorder.SetActiveWorkers(count);
+	}
 
-		//vkCmdDraw(cmd, allocatedBuffer.Size, 1, 0, 0);
-		vkCmdDrawIndexed(cmd, indexBuffer.Size, 1, 0, 0, 0);
+	uint32_t VkGraphicsDevice::GetRecordThreads() const
+	{
+		return m_DrawRecorder.GetWorkerCount();
+	}
 
-		vkCmdEndRendering(cmd);
+	uint32_t VkGraphicsDevice::GetMaxRecordThreads() const
+	{
+		return m_DrawRecorder.GetMaxWorkerCount();
+	}
+
+	void VkGraphicsDevice::DrawMesh(MeshHandle mesh, TextureHandle* texture)
+	{
+		SubmitDraw({ mesh, texture ? *texture : TextureHandle{}, glm::mat4(1.0f) });
 	}
 
 	void VkGraphicsDevice::SetCamera(TestCamera *camera)
@@ -456,40 +814,59 @@ namespace QE
 		m_Camera = camera;
 	}
 
+	void VkGraphicsDevice::RegisterAllocators(MemoryRegistry& registry)
+	{
+		registry.RegisterAllocator(&m_DrawListAllocator, "Draw List", MemoryTag::Renderer);
+	}
+
+	void VkGraphicsDevice::UnregisterAllocators(MemoryRegistry& registry)
+	{
+		registry.UnregisterAllocator(&m_DrawListAllocator);
+	}
+
 	FrameData& VkGraphicsDevice::GetCurrentFrameData()
 	{
-		return m_FrameData[m_CurrentFrameNumber % MAX_FRAMES_IN_FLIGHT];
+		return m_FrameData[m_FrameScheduler.GetSlot(m_CurrentFrameNumber)];
 	}
 
-	AllocatedBuffer VkGraphicsDevice::GetBufferFromHandle(BufferHandle handle)
+	AllocatedBuffer* VkGraphicsDevice::GetBufferFromHandle(BufferHandle handle)
 	{
-		return s_BufferMap[handle];
+		return m_BufferPool.Get(handle);
 	}
 
-	AllocatedImage VkGraphicsDevice::GetTextureFromHandle(TextureHandle handle)
+	AllocatedImage* VkGraphicsDevice::GetTextureFromHandle(TextureHandle handle)
 	{
-		return s_TextureMap[handle];
+		GPUTexture* texture = m_TexturePool.Get(handle);
+		return texture ? &texture->Image : nullptr;
 	}
 
-	GPUMeshBuffer VkGraphicsDevice::GetMeshFromHandle(MeshHandle handle)
+	GPUMeshBuffer* VkGraphicsDevice::GetMeshFromHandle(MeshHandle handle)
 	{
-		return s_MeshMap[handle];
+		return m_MeshPool.Get(handle);
 	}
 
 	// PRIVATE FUNCTIONS
 	void VkGraphicsDevice::InitSwapchain(VkExtent2D windowExtent)
 	{
-		CreateSwapchain(windowExtent);
+		// Headless devices only have the draw targets, the swapchain extent is what they render at
+		if (m_Headless)
+			m_SwapchainExtent = windowExtent;
+		else
+			CreateSwapchain(windowExtent);
+		CreateDrawTargets(windowExtent);
+
+		m_DrawExtent = windowExtent;
+	}
 
+	void VkGraphicsDevice::CreateDrawTargets(VkExtent2D extent)
+	{
 		// Setup draw image
 		VkExtent3D drawImageExtent = {
-			windowExtent.width,
-			windowExtent.height,
+			extent.width,
+			extent.height,
 			1
 		};
 
-		m_DrawExtent = windowExtent;
-
 		m_DrawImage.ImageFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
 		m_DrawImage.ImageExtent = drawImageExtent;
 
@@ -511,28 +888,15 @@ namespace QE
 		// Build the image view
 		VkImageViewCreateInfo imageViewInfo = VkInit::BuildImageViewCreateInfo(m_DrawImage.ImageFormat, m_DrawImage.Image, VK_IMAGE_ASPECT_COLOR_BIT);
 		VK_CHECK(vkCreateImageView(m_Device, &imageViewInfo, nullptr, &m_DrawImage.ImageView));
+		m_DrawImageState = {};
 
-		// Setup the depth image
-		// https://www.reddit.com/r/vulkan/comments/1l6n502/gtx_1080_vulkan_tutorial_and_poor_depth_stencil/
-		// D16_UNORM for shadow mapping (depth but not needing too much precision)
-		m_DepthImage.ImageFormat = VK_FORMAT_D32_SFLOAT; // good format for reverse Z
-		m_DepthImage.ImageExtent = drawImageExtent;
-
-		VkImageUsageFlags depthImageUsages{};
-		depthImageUsages |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-
-		VkImageCreateInfo dimg_info = VkInit::BuildImageCreateInfo(m_DepthImage.ImageFormat, depthImageUsages, m_DepthImage.ImageExtent);
-		vmaCreateImage(m_Allocator, &dimg_info, &ring_allocInfo, &m_DepthImage.Image, &m_DepthImage.Allocation, nullptr);
-
-		VkImageViewCreateInfo dview_info = VkInit::BuildImageViewCreateInfo(m_DepthImage.ImageFormat, m_DepthImage.Image, VK_IMAGE_ASPECT_DEPTH_BIT);
-
-		VK_CHECK(vkCreateImageView(m_Device, &dview_info, nullptr, &m_DepthImage.ImageView));
+		// The depth image only lives for a frame, it is a transient render graph image of the same size
+	}
 
-		//add to deletion queues
-		m_CleanupQueue.PushFunction([=]() {
-			DestroyImage(m_DepthImage);
-			DestroyImage(m_DrawImage);
-		});
+	void VkGraphicsDevice::RetireDrawTargets()
+	{
+		m_FrameDeletionQueue.Push(m_DrawImage.ImageView, m_CurrentFrameNumber);
+		m_FrameDeletionQueue.Push(m_DrawImage.Image, m_DrawImage.Allocation, m_CurrentFrameNumber);
 	}
 
 	void VkGraphicsDevice::CreateSwapchain(VkExtent2D windowExtent)
@@ -542,13 +906,38 @@ namespace QE
 		LOG_DEBUG_TAG("VkGraphicsDevice", "Vulkan Swapchain and views created");
 	}
 
-	void VkGraphicsDevice::RecreateSwapchain()
+	bool VkGraphicsDevice::RecreateSwapchain()
 	{
-		LOG_DEBUG_TAG("VkGraphicsDevice", "Recreating Vulkan Swapchain");
-		WaitForDeviceIdle();
+		if (m_WindowExtent.width == 0 || m_WindowExtent.height == 0)
+			return false;
+
+		LOG_DEBUG_TAG("VkGraphicsDevice", "Recreating Vulkan Swapchain: {}x{}", m_WindowExtent.width, m_WindowExtent.height);
+
+		// No device idle, frames in flight may still present from the old swapchain. It is handed to the new one
+		// and destroyed with its views once those frames are done
+		VkSwapchainKHR oldSwapchain = m_Swapchain;
+		for (VkImageView imageView : m_SwapchainImageViews)
+			m_FrameDeletionQueue.Push(imageView, m_CurrentFrameNumber);
+
+		m_Swapchain = VkInit::CreateSwapchain(m_PhysicalDevice, m_Device, m_Surface, m_WindowExtent, &m_SwapchainImages, &m_SwapchainImageFormat, &m_SwapchainExtent, oldSwapchain);
+		VkInit::CreateSwapchainImageViews(m_Device, &m_SwapchainImages, m_SwapchainImageFormat, &m_SwapchainImageViews);
+		m_FrameDeletionQueue.Push(oldSwapchain, m_CurrentFrameNumber);
+
+		// Draw targets only grow, a smaller window renders into part of them. Dragging a window edge
+		// then only reallocates while the window is getting bigger than it has been so far
+		const VkExtent3D drawImageExtent = m_DrawImage.ImageExtent;
+		if (m_SwapchainExtent.width > drawImageExtent.width || m_SwapchainExtent.height > drawImageExtent.height)
+		{
+			RetireDrawTargets();
+			CreateDrawTargets({ std::max(m_SwapchainExtent.width, drawImageExtent.width), std::max(m_SwapchainExtent.height, drawImageExtent.height) });
 
-		DestroySwapchain();
-		CreateSwapchain(m_WindowExtent);
+			DescriptorWriter writer;
+			writer.WriteImage(0, m_DrawImage.ImageView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+			writer.UpdateSet(m_Device, m_DrawImageDescriptors);
+		}
+
+		m_ResizeRequested = false;
+		return true;
 	}
 
 	void VkGraphicsDevice::DestroySwapchain()
@@ -564,6 +953,10 @@ namespace QE
 
 	void VkGraphicsDevice::InitializeFrameData()
 	{
+		// Every slot is created up front so the number of frames in flight can change at runtime
+		m_FrameScheduler.Init(m_Device, DEFAULT_FRAMES_IN_FLIGHT);
+		m_GpuProfiler.Init(m_Device, m_PhysicalDevice, m_QueueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT);
+
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 		{
 			// Command pools and buffers
@@ -574,9 +967,15 @@ namespace QE
 			m_FrameData[i].SwapchainSemaphore = VkInit::CreateSemaphore(m_Device);
 			m_FrameData[i].RenderSemaphore = VkInit::CreateSemaphore(m_Device);
 
-			// Fences
-			m_FrameData[i].RenderFence = VkInit::CreateFence(m_Device, VK_FENCE_CREATE_SIGNALED_BIT);
+			// Scene uniform, also read by the culling pass through its address
+			m_FrameData[i].SceneDataBuffer = AllocateBuffer(sizeof(GPUSceneData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
 		}
+
+		// Passes of the frame and the memory of their transient images
+		m_RenderGraph.Init(m_Device, m_Allocator, &m_GpuProfiler);
+
+		// Secondary command buffers for the draw list, one pool per worker and slot
+		m_DrawRecorder.Init(m_Device, m_QueueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT);
 	}
 
 	void VkGraphicsDevice::InitializeDescriptors()
@@ -598,11 +997,14 @@ namespace QE
 			m_DrawImageDescriptorSetLayout = builder.Build(m_Device, VK_SHADER_STAGE_COMPUTE_BIT);
 		}
 
-		// Single image descriptor set
+		// Bindless texture table
+		m_BindlessTextures.Init(m_Device, m_PhysicalDevice);
+
+		// Per frame scene data
 		{
 			DescriptorLayoutBuilder builder;
-			builder.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-			m_SingleImageDescriptorLayout = builder.Build(m_Device, VK_SHADER_STAGE_FRAGMENT_BIT);
+			builder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			m_SceneDataDescriptorLayout = builder.Build(m_Device, VK_SHADER_STAGE_VERTEX_BIT);
 		}
 
 		//allocate a descriptor set for our draw image
@@ -614,12 +1016,9 @@ namespace QE
 		writer.UpdateSet(m_Device, m_DrawImageDescriptors);
 
 		//make sure both the descriptor allocator and the new layout get cleaned up properly
-		m_CleanupQueue.PushFunction([&]() {
-			m_DescriptorAllocator.DestroyPool(m_Device);
-
-			vkDestroyDescriptorSetLayout(m_Device, m_DrawImageDescriptorSetLayout, nullptr);
-			vkDestroyDescriptorSetLayout(m_Device, m_SingleImageDescriptorLayout, nullptr);
-		});
+		m_LifetimeDeletionQueue.Push(m_DescriptorAllocator.Pool, 0);
+		m_LifetimeDeletionQueue.Push(m_DrawImageDescriptorSetLayout, 0);
+		m_LifetimeDeletionQueue.Push(m_SceneDataDescriptorLayout, 0);
 
 		// Growable descriptor allocator
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
@@ -646,9 +1045,6 @@ namespace QE
 	{
 		// Compute
 		InitializeBackgroundPipelines();
-
-		// Graphics
-		InitializeMeshPipeline();
 	}
 
 	void VkGraphicsDevice::InitializeBackgroundPipelines()
@@ -662,8 +1058,8 @@ namespace QE
 
 		VK_CHECK(vkCreatePipelineLayout(m_Device, &computeLayout, nullptr, &m_GradientPipelineLayout));
 
-		VkShaderModule gradientShader = VkInit::CreateShaderModule(m_Device, "gradient-comp.spv");
-		VkShaderModule skyShader = VkInit::CreateShaderModule(m_Device, "sky-comp.spv");
+		VkShaderModule gradientShader = m_ShaderCompiler.CreateShaderModule(m_Device, "gradient.comp");
+		VkShaderModule skyShader = m_ShaderCompiler.CreateShaderModule(m_Device, "sky.comp");
 
 		VkPipelineShaderStageCreateInfo stageinfo{};
 		stageinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -687,7 +1083,7 @@ namespace QE
 		gradient.Data.Data1 = glm::vec4(1, 0, 0, 1);
 		gradient.Data.Data2 = glm::vec4(0, 0, 1, 1);
 
-		VK_CHECK(vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &gradient.Pipeline));
+		VK_CHECK(vkCreateComputePipelines(m_Device, m_PipelineCache.GetHandle(), 1, &computePipelineCreateInfo, nullptr, &gradient.Pipeline));
 
 		//change the shader module only to create the sky shader
 		computePipelineCreateInfo.stage.module = skyShader;
@@ -699,7 +1095,7 @@ namespace QE
 		//default sky parameters
 		sky.Data.Data1 = glm::vec4(0.1, 0.2, 0.4, 0.97);
 
-		VK_CHECK(vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &sky.Pipeline));
+		VK_CHECK(vkCreateComputePipelines(m_Device, m_PipelineCache.GetHandle(), 1, &computePipelineCreateInfo, nullptr, &sky.Pipeline));
 
 		//add the 2 background effects into the array
 		m_BackgroundEffects.push_back(gradient);
@@ -708,68 +1104,171 @@ namespace QE
 		//destroy structures properly
 		vkDestroyShaderModule(m_Device, gradientShader, nullptr);
 		vkDestroyShaderModule(m_Device, skyShader, nullptr);
-		m_CleanupQueue.PushFunction([=]() {
-			vkDestroyPipelineLayout(m_Device, m_GradientPipelineLayout, nullptr);
-			vkDestroyPipeline(m_Device, sky.Pipeline, nullptr);
-			vkDestroyPipeline(m_Device, gradient.Pipeline, nullptr);
-		});
+		m_LifetimeDeletionQueue.Push(m_GradientPipelineLayout, 0);
+		m_LifetimeDeletionQueue.Push(sky.Pipeline, 0);
+		m_LifetimeDeletionQueue.Push(gradient.Pipeline, 0);
 	}
 
-	void VkGraphicsDevice::InitializeMeshPipeline()
+	void VkGraphicsDevice::InitializeCullPipeline()
 	{
-		VkShaderModule triangleFragShader = VkInit::CreateShaderModule(m_Device, "colored_triangle-frag.spv");
-		VkShaderModule triangleVertexShader = VkInit::CreateShaderModule(m_Device, "colored_triangle_mesh-vert.spv");
+		VkPushConstantRange pushConstant{};
+		pushConstant.offset = 0;
+		pushConstant.size = sizeof(GPUCullPushConstants);
+		pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
-		VkPushConstantRange bufferRange{};
-		bufferRange.offset = 0;
-		bufferRange.size = sizeof(GPUDrawPushConstants);
-		bufferRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		VkPipelineLayoutCreateInfo layoutInfo = VkInit::BuildPipelineCreateInfo();
+		layoutInfo.pPushConstantRanges = &pushConstant;
+		layoutInfo.pushConstantRangeCount = 1;
 
-		VkPipelineLayoutCreateInfo pipeline_layout_info = VkInit::BuildPipelineCreateInfo(); // rename this function, i was confused
-		pipeline_layout_info.pPushConstantRanges = &bufferRange;
-		pipeline_layout_info.pushConstantRangeCount = 1;
-		pipeline_layout_info.pSetLayouts = &m_SingleImageDescriptorLayout;
-		pipeline_layout_info.setLayoutCount = 1;
+		VK_CHECK(vkCreatePipelineLayout(m_Device, &layoutInfo, nullptr, &m_CullPipelineLayout));
 
-		VK_CHECK(vkCreatePipelineLayout(m_Device, &pipeline_layout_info, nullptr, &m_MeshPipelineLayout));
+		RegisterReloadablePipeline({ "cull.comp" }, &m_CullPipeline, &VkGraphicsDevice::BuildCullPipeline);
 
-		PipelineBuilder pipelineBuilder;
+		std::scoped_lock lock(m_PipelineInitMutex);
+		m_LifetimeDeletionQueue.Push(m_CullPipelineLayout, 0);
+	}
+
+	VkPipeline VkGraphicsDevice::BuildCullPipeline()
+	{
+		VkShaderModule cullShader = m_ShaderCompiler.CreateShaderModule(m_Device, "cull.comp");
 
-		//use the triangle layout we created
-		pipelineBuilder.PipelineLayout = m_MeshPipelineLayout;
-		//connecting the vertex and pixel shaders to the pipeline
-		pipelineBuilder.SetShaders(triangleVertexShader, triangleFragShader);
-		//it will draw triangles
+		VkPipelineShaderStageCreateInfo stageInfo{};
+		stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stageInfo.pNext = nullptr;
+		stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		stageInfo.module = cullShader;
+		stageInfo.pName = "main";
+
+		VkComputePipelineCreateInfo computePipelineCreateInfo{};
+		computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computePipelineCreateInfo.pNext = nullptr;
+		computePipelineCreateInfo.layout = m_CullPipelineLayout;
+		computePipelineCreateInfo.stage = stageInfo;
+
+		// Failures are returned instead of checked, a reload keeps the current pipeline and startup aborts
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		const VkResult result = vkCreateComputePipelines(m_Device, m_PipelineCache.GetHandle(), 1, &computePipelineCreateInfo, nullptr, &pipeline);
+		if (result != VK_SUCCESS)
+		{
+			LOG_ERROR_TAG("VkGraphicsDevice", "Failed to create the cull pipeline: {}", string_VkResult(result));
+			pipeline = VK_NULL_HANDLE;
+		}
+
+		vkDestroyShaderModule(m_Device, cullShader, nullptr);
+
+		return pipeline;
+	}
+
+	void VkGraphicsDevice::InitializeIndirectMeshPipeline()
+	{
+		// Everything per draw comes from the instance buffers, so no push constants
+		std::array<VkDescriptorSetLayout, 2> setLayouts = { m_BindlessTextures.GetLayout(), m_SceneDataDescriptorLayout };
+
+		VkPipelineLayoutCreateInfo pipeline_layout_info = VkInit::BuildPipelineCreateInfo();
+		pipeline_layout_info.pSetLayouts = setLayouts.data();
+		pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+
+		VK_CHECK(vkCreatePipelineLayout(m_Device, &pipeline_layout_info, nullptr, &m_IndirectMeshPipelineLayout));
+
+		RegisterReloadablePipeline({ "mesh_indirect.vert", "mesh_indirect.frag" }, &m_IndirectMeshPipeline, &VkGraphicsDevice::BuildIndirectMeshPipeline);
+
+		std::scoped_lock lock(m_PipelineInitMutex);
+		m_LifetimeDeletionQueue.Push(m_IndirectMeshPipelineLayout, 0);
+	}
+
+	VkPipeline VkGraphicsDevice::BuildIndirectMeshPipeline()
+	{
+		VkShaderModule fragShader = m_ShaderCompiler.CreateShaderModule(m_Device, "mesh_indirect.frag");
+		VkShaderModule vertexShader = m_ShaderCompiler.CreateShaderModule(m_Device, "mesh_indirect.vert");
+
+		// Same state as the mesh pipeline, only the shaders differ
+		PipelineBuilder pipelineBuilder;
+		pipelineBuilder.PipelineLayout = m_IndirectMeshPipelineLayout;
+		pipelineBuilder.SetShaders(vertexShader, fragShader);
 		pipelineBuilder.SetInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-		//filled triangles
 		pipelineBuilder.SetPolygonMode(VK_POLYGON_MODE_FILL);
-		//no backface culling
 		pipelineBuilder.SetCullMode(VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
-		//no multisampling
 		pipelineBuilder.SetMultisamplingMode();
-		// additive blending
-		//pipelineBuilder.EnableBlendingAdditive();
 		pipelineBuilder.EnableBlendingAlphaBlend();
-		//pipelineBuilder.DisableBlending();
-
-		// VK_COMPARE_OP_GREATER_OR_EQUAL
 		pipelineBuilder.EnableDepthTest(true, VK_COMPARE_OP_GREATER_OR_EQUAL);
-
-		//connect the image format we will draw into, from draw image
 		pipelineBuilder.SetColorAttachmentFormat(m_DrawImage.ImageFormat);
-		pipelineBuilder.SetDepthFormat(m_DepthImage.ImageFormat);
+		pipelineBuilder.SetDepthFormat(DEPTH_FORMAT);
 
-		//finally build the pipeline
-		m_MeshPipeline = pipelineBuilder.BuildPipeline(m_Device);
+		VkPipeline pipeline = pipelineBuilder.BuildPipeline(m_Device, m_PipelineCache.GetHandle());
 
-		//clean structures
-		vkDestroyShaderModule(m_Device, triangleFragShader, nullptr);
-		vkDestroyShaderModule(m_Device, triangleVertexShader, nullptr);
+		vkDestroyShaderModule(m_Device, fragShader, nullptr);
+		vkDestroyShaderModule(m_Device, vertexShader, nullptr);
 
-		m_CleanupQueue.PushFunction([&]() {
-			vkDestroyPipelineLayout(m_Device, m_MeshPipelineLayout, nullptr);
-			vkDestroyPipeline(m_Device, m_MeshPipeline, nullptr);
-		});
+		return pipeline;
+	}
+
+	void VkGraphicsDevice::RegisterReloadablePipeline(std::vector<std::string> shaders, VkPipeline* pipeline, VkPipeline (VkGraphicsDevice::*build)())
+	{
+		*pipeline = (this->*build)();
+
+		// Only reloads can fall back to the pipeline they replace, at startup there is nothing to draw with
+		if (*pipeline == VK_NULL_HANDLE)
+		{
+			LOG_FATAL_TAG("VkGraphicsDevice", "Failed to build the pipeline for {}", shaders.front());
+			abort();
+		}
+
+		std::scoped_lock lock(m_PipelineInitMutex);
+		m_ReloadablePipelines.push_back({ std::move(shaders), pipeline, build });
+	}
+
+	void VkGraphicsDevice::ReloadChangedShaders()
+	{
+		std::vector<std::string> changed = m_ShaderWatcher.Poll();
+		if (changed.empty())
+			return;
+
+		// Stage files map to the pipelines that use them, an edited include may be used by any of them.
+		// Everything else in the folder (editor swap files and such) is ignored
+		constexpr std::array<std::string_view, 6> stageExtensions = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+		constexpr std::array<std::string_view, 2> includeExtensions = { ".glsl", ".h" };
+
+		bool includeChanged = false;
+		std::vector<std::string> changedStages;
+		for (const std::string& name : changed)
+		{
+			const std::string extension = std::filesystem::path(name).extension().string();
+			if (std::ranges::find(stageExtensions, extension) != stageExtensions.end())
+				changedStages.push_back(name);
+			else if (std::ranges::find(includeExtensions, extension) != includeExtensions.end())
+				includeChanged = true;
+		}
+
+		for (ReloadablePipeline& reloadable : m_ReloadablePipelines)
+		{
+			const bool affected = includeChanged || std::ranges::any_of(reloadable.Shaders, [&](const std::string& shader) {
+				return std::ranges::find(changedStages, shader) != changedStages.end();
+			});
+			if (!affected)
+				continue;
+
+			// A shader with errors keeps the current pipeline instead of falling back to the prebuilt one
+			const bool compiles = std::ranges::all_of(reloadable.Shaders, [&](const std::string& shader) {
+				return !m_ShaderCompiler.Compile(shader).empty();
+			});
+			if (!compiles)
+			{
+				LOG_ERROR_TAG("VkGraphicsDevice", "Keeping the current pipeline for {}, a shader failed to compile", reloadable.Shaders.front());
+				continue;
+			}
+
+			VkPipeline pipeline = (this->*reloadable.Build)();
+			if (pipeline == VK_NULL_HANDLE)
+			{
+				LOG_ERROR_TAG("VkGraphicsDevice", "Keeping the current pipeline for {}, the new one failed to build", reloadable.Shaders.front());
+				continue;
+			}
+
+			// Frames still in flight keep using the old pipeline, it goes away once they are done
+			m_FrameDeletionQueue.Push(*reloadable.Pipeline, m_CurrentFrameNumber);
+			*reloadable.Pipeline = pipeline;
+			LOG_INFO_TAG("VkGraphicsDevice", "Reloaded pipeline for {}", reloadable.Shaders.front());
+		}
 	}
 
 	void VkGraphicsDevice::InitializeImGui()
@@ -783,15 +1282,11 @@ namespace QE
 
 		VK_CHECK(vkAllocateCommandBuffers(m_Device, &cmdAllocInfo, &m_ImGuiCommandBuffer));
 
-		m_CleanupQueue.PushFunction([=]() {
-			vkDestroyCommandPool(m_Device, m_ImGuiCommandPool, nullptr);
-		});
+		m_LifetimeDeletionQueue.Push(m_ImGuiCommandPool, 0);
 
 		VkFenceCreateInfo fenceCreateInfo = VkInit::BuildFenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
 		VK_CHECK(vkCreateFence(m_Device, &fenceCreateInfo, nullptr, &m_ImGuiFence));
-		m_CleanupQueue.PushFunction([=]() {
-			vkDestroyFence(m_Device, m_ImGuiFence, nullptr);
-		});
+		m_LifetimeDeletionQueue.Push(m_ImGuiFence, 0);
 
 		// 1: create descriptor pool for IMGUI
 		//  the size of the pool is very oversize, but it's copied from imgui demo
@@ -825,6 +1320,21 @@ namespace QE
 		// this initializes the core structures of imgui
 		ImGui::CreateContext();
 
+		// Headless runs still let the game build its windows, they are just never drawn. Building the font
+		// atlas on the CPU is all ImGui needs without backends
+		if (m_Headless)
+		{
+			unsigned char* pixels = nullptr;
+			int atlasWidth = 0, atlasHeight = 0;
+			ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+
+			m_CleanupQueue.PushFunction([=]() {
+				ImGui::DestroyContext();
+				vkDestroyDescriptorPool(m_Device, imguiPool, nullptr);
+			});
+			return;
+		}
+
 		// this initializes imgui for SDL
 		ImGui_ImplGlfw_InitForVulkan(static_cast<GLFWwindow*>(m_Window->GetNativeWindow()), true);
 
@@ -891,25 +1401,350 @@ namespace QE
 
 		vkCreateSampler(m_Device, &sampl, nullptr, &m_DefaultSamplerLinear);
 
-		m_CleanupQueue.PushFunction([=]()
-		{
-			vkDestroySampler(m_Device, m_DefaultSamplerNearest, nullptr);
-			vkDestroySampler(m_Device, m_DefaultSamplerLinear, nullptr);
+		m_LifetimeDeletionQueue.Push(m_DefaultSamplerNearest, 0);
+		m_LifetimeDeletionQueue.Push(m_DefaultSamplerLinear, 0);
 
-			DestroyImage(m_WhiteImage);
-			DestroyImage(m_GreyImage);
-			DestroyImage(m_BlackImage);
-			DestroyImage(m_ErrorCheckerboardImage);
-		});
+		m_ErrorCheckerboardIndex = m_BindlessTextures.Register(m_ErrorCheckerboardImage.ImageView, m_DefaultSamplerNearest);
+		for (const AllocatedImage& image : { m_WhiteImage, m_GreyImage, m_BlackImage, m_ErrorCheckerboardImage })
+		{
+			m_LifetimeDeletionQueue.Push(image.ImageView, 0);
+			m_LifetimeDeletionQueue.Push(image.Image, image.Allocation, 0);
+		}
 	}
 
 	void VkGraphicsDevice::TutorialSetupStuff()
 	{
 		//InitializeMesh2DPipeline();
-		InitializeMeshPipeline();
+
+		// The pipelines do not depend on each other, compiling them on worker threads overlaps the driver work.
+		// With a warm pipeline cache most of the time goes to cache lookups instead
+		const auto pipelineStart = std::chrono::steady_clock::now();
+		std::array<std::future<void>, 2> pipelineBuilds = {
+			std::async(std::launch::async, [this]() { InitializeCullPipeline(); }),
+			std::async(std::launch::async, [this]() { InitializeIndirectMeshPipeline(); }),
+		};
+		for (std::future<void>& build : pipelineBuilds)
+			build.get();
+		const std::chrono::duration<double, std::milli> pipelineTime = std::chrono::steady_clock::now() - pipelineStart;
+		const VkShaderCompiler::Stats shaderStats = m_ShaderCompiler.GetStats();
+		m_PipelineCache.SetBuildTime(pipelineTime.count());
+		if (m_PipelineCache.IsWarm() && m_PipelineCache.GetColdBuildTime() > 0.0)
+		{
+			LOG_INFO_TAG("VkGraphicsDevice", "Compiled {} pipelines in {:.2f} ms with a warm pipeline cache, {:.2f} ms when it was cold ({} shaders compiled, {} from the SPIR-V cache)",
+				pipelineBuilds.size(), pipelineTime.count(), m_PipelineCache.GetColdBuildTime(), shaderStats.Compiles, shaderStats.CacheHits);
+		}
+		else
+		{
+			LOG_INFO_TAG("VkGraphicsDevice", "Compiled {} pipelines in {:.2f} ms with a {} pipeline cache ({} shaders compiled, {} from the SPIR-V cache)",
+				pipelineBuilds.size(), pipelineTime.count(), m_PipelineCache.IsWarm() ? "warm" : "cold", shaderStats.Compiles, shaderStats.CacheHits);
+		}
+
+		// Saved right away so a crash later on still keeps the compiled pipelines for the next launch
+		m_PipelineCache.Save();
+
 		InitializeDefaultData();
 	}
 
+	void VkGraphicsDevice::FlushDrawList(VkCommandBuffer cmd, VkImageView depthView)
+	{
+		QE_PROFILE_SCOPE("Record draw list");
+		m_DrawStats = {};
+		const auto recordStart = std::chrono::steady_clock::now();
+
+		std::sort(m_DrawKeys.begin(), m_DrawKeys.end(), [](const DrawKey& a, const DrawKey& b) {
+			return a.Key < b.Key;
+		});
+
+		FrameData& frame = GetCurrentFrameData();
+		if (!m_DrawKeys.empty())
+			EnsureDrawCapacity(frame, static_cast<uint32_t>(m_DrawKeys.size()));
+
+		const uint32_t workerCount = m_DrawRecorder.GetWorkerCount();
+		SplitDrawChunks(m_DrawKeys, frame.InstanceCount, workerCount, m_DrawChunks);
+
+		// Workers only read the pools and write their own part of the mapped buffers, the scene set is shared
+		std::span<const VkCommandBuffer> secondaries;
+		if (!m_DrawChunks.empty())
+		{
+			VkDescriptorSet sceneSet = frame.FrameDescriptors.Allocate(m_Device, m_SceneDataDescriptorLayout);
+			{
+				DescriptorWriter writer;
+				writer.WriteBuffer(0, frame.SceneDataBuffer.Buffer, sizeof(GPUSceneData), 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+				writer.UpdateSet(m_Device, sceneSet);
+			}
+
+			VkCommandBufferInheritanceRenderingInfo inheritanceRendering = {};
+			inheritanceRendering.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+			inheritanceRendering.colorAttachmentCount = 1;
+			inheritanceRendering.pColorAttachmentFormats = &m_DrawImage.ImageFormat;
+			inheritanceRendering.depthAttachmentFormat = DEPTH_FORMAT;
+			inheritanceRendering.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+			secondaries = m_DrawRecorder.Record(m_FrameScheduler.GetSlot(m_CurrentFrameNumber), static_cast<uint32_t>(m_DrawChunks.size()), inheritanceRendering,
+				m_GpuProfiler.GetInheritedStatistics(), [this, sceneSet](uint32_t job, VkCommandBuffer chunkCmd) { RecordDrawChunk(m_DrawChunks[job], chunkCmd, sceneSet); });
+		}
+
+		uint32_t drawCount = 0;
+		for (const DrawChunk& recorded : m_DrawChunks)
+		{
+			drawCount += recorded.DrawCount;
+			m_DrawStats.Instances += recorded.DrawnInstances;
+			if (recorded.DrawCount > 0)
+			{
+				m_DrawStats.Draws++;
+				m_DrawStats.PipelineBinds++;
+				m_DrawStats.TextureBinds++;
+				m_DrawStats.IndexBufferBinds++;
+			}
+		}
+		m_DrawStats.SecondaryCommandBuffers = static_cast<uint32_t>(secondaries.size());
+		m_DrawStats.RecordWorkers = std::min(workerCount, m_DrawStats.SecondaryCommandBuffers);
+
+		// Camera matrices are the same for every draw
+		// reverse near and far plane because using reverse-Z depth
+		// https://developer.nvidia.com/blog/visualizing-depth-precision/
+		glm::mat4 projection = ReversedZPerspective(glm::radians(m_Camera->Zoom), (float)m_SwapchainExtent.width / (float)m_SwapchainExtent.height, 0.1f);
+		glm::mat4 viewProjection = projection * m_Camera->GetViewMatrix();
+
+		if (drawCount > 0)
+		{
+			// Chunks leave gaps between their draws, the gaps are zeroed with the rest and never drawn
+			const uint32_t drawRange = static_cast<uint32_t>(m_DrawKeys.size());
+
+			GPUSceneData& sceneData = *static_cast<GPUSceneData*>(frame.SceneDataBuffer.AllocationInfo.pMappedData);
+			sceneData.ViewProjection = viewProjection;
+
+			// Frustum planes from the view projection matrix (Gribb & Hartmann), glm is column major so rows are gathered by hand.
+			// Vulkan clip space has 0 <= z <= w, with reverse-Z and an infinite far plane one of the depth planes has no normal,
+			// those get a plane that always passes
+			auto row = [&viewProjection](int i) {
+				return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+			};
+
+			sceneData.FrustumPlanes[0] = row(3) + row(0);
+			sceneData.FrustumPlanes[1] = row(3) - row(0);
+			sceneData.FrustumPlanes[2] = row(3) + row(1);
+			sceneData.FrustumPlanes[3] = row(3) - row(1);
+			sceneData.FrustumPlanes[4] = row(2);
+			sceneData.FrustumPlanes[5] = row(3) - row(2);
+			for (glm::vec4& plane : sceneData.FrustumPlanes)
+			{
+				float length = glm::length(glm::vec3(plane));
+				plane = length > 1e-6f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			}
+
+			sceneData.InstanceBuffer = GetBufferDeviceAddress(frame.InstanceBuffer.Buffer);
+			sceneData.DrawBuffer = GetBufferDeviceAddress(frame.DrawBuffer.Buffer);
+			sceneData.DrawCommandBuffer = GetBufferDeviceAddress(frame.DrawCommandBuffer.Buffer);
+			sceneData.VisibleInstanceBuffer = GetBufferDeviceAddress(frame.VisibleInstanceBuffer.Buffer);
+			sceneData.VertexBuffer = m_MeshArena.GetVertexBufferAddress();
+
+			VK_CHECK(vmaFlushAllocation(m_Allocator, frame.SceneDataBuffer.Allocation, 0, sizeof(GPUSceneData)));
+			VK_CHECK(vmaFlushAllocation(m_Allocator, frame.InstanceBuffer.Allocation, 0, frame.InstanceCount * sizeof(GPUInstanceData)));
+			VK_CHECK(vmaFlushAllocation(m_Allocator, frame.DrawBuffer.Allocation, 0, drawRange * sizeof(GPUDrawData)));
+
+			// The GPU finished the slot's last frame before this one started, so both buffers start out untouched.
+			// Host writes need no barrier, the submission makes them visible
+			const VkDeviceSize commandRange = drawRange * sizeof(VkDrawIndexedIndirectCommand);
+			ResourceState commandState;
+			ResourceState visibleState;
+
+			const uint32_t cullZone = m_GpuProfiler.BeginZone(cmd, "Cull");
+
+			// Commands start out empty, the culling pass counts the visible instances into them
+			m_Barriers.Buffer(frame.DrawCommandBuffer.Buffer, commandState, ResourceUsage::TransferDst, ResourceAccess::Overwrite, 0, commandRange);
+			vkCmdFillBuffer(cmd, frame.DrawCommandBuffer.Buffer, 0, commandRange, 0);
+
+			m_Barriers.Buffer(frame.DrawCommandBuffer.Buffer, commandState, ResourceUsage::ComputeStorage, ResourceAccess::ReadWrite, 0, commandRange);
+			m_Barriers.Buffer(frame.VisibleInstanceBuffer.Buffer, visibleState, ResourceUsage::ComputeStorage, ResourceAccess::Overwrite);
+			m_Barriers.Flush(cmd);
+
+			GPUCullPushConstants cullConstants{};
+			cullConstants.SceneData = GetBufferDeviceAddress(frame.SceneDataBuffer.Buffer);
+			cullConstants.InstanceCount = frame.InstanceCount;
+
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipeline);
+			vkCmdPushConstants(cmd, m_CullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullPushConstants), &cullConstants);
+			vkCmdDispatch(cmd, (frame.InstanceCount + 63) / 64, 1, 1);
+			m_GpuProfiler.EndZone(cmd, cullZone);
+
+			m_Barriers.Buffer(frame.DrawCommandBuffer.Buffer, commandState, ResourceUsage::IndirectCommands, ResourceAccess::Read, 0, commandRange);
+			m_Barriers.Buffer(frame.VisibleInstanceBuffer.Buffer, visibleState, ResourceUsage::VertexStorage, ResourceAccess::Read);
+			m_Barriers.Flush(cmd);
+		}
+
+		// One pass for the whole frame, it also clears the draw image when nothing was submitted.
+		// The draws are all in the secondaries, the primary only stitches them together
+		VkClearValue clearValue = {0.0f, 0.0f, 0.0f, 1.0f};
+		VkRenderingAttachmentInfo colorAttachment = VkInit::BuildRenderingAttachmentInfo(m_DrawImage.ImageView, &clearValue, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		VkRenderingAttachmentInfo depthAttachment = VkInit::BuildDepthAttachment(depthView, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+		VkRenderingInfo renderInfo = VkInit::BuildRenderingInfo(m_DrawExtent, &colorAttachment, &depthAttachment);
+		if (!secondaries.empty())
+			renderInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+		vkCmdBeginRendering(cmd, &renderInfo);
+
+		if (!secondaries.empty())
+			vkCmdExecuteCommands(cmd, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+
+		vkCmdEndRendering(cmd);
+
+		m_DrawStats.RecordTimeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+		ClearDrawList();
+	}
+
+	void VkGraphicsDevice::RecordDrawChunk(DrawChunk& chunk, VkCommandBuffer cmd, VkDescriptorSet sceneSet)
+	{
+		constexpr uint32_t INVALID_DRAW = UINT32_MAX;
+
+		FrameData& frame = GetCurrentFrameData();
+
+		// Sorted records with the same mesh merge into one draw, textures are picked per instance.
+		// Every draw owns a range of the visible list as big as its instance count, the culling pass fills it
+		GPUInstanceData* instances = static_cast<GPUInstanceData*>(frame.InstanceBuffer.AllocationInfo.pMappedData);
+		GPUDrawData* draws = static_cast<GPUDrawData*>(frame.DrawBuffer.AllocationInfo.pMappedData) + chunk.FirstKey;
+		uint32_t drawCount = 0;
+		uint32_t drawnInstances = 0;
+		uint32_t visibleCount = chunk.FirstVisible;
+		MeshHandle drawMesh = {};
+
+		for (uint32_t i = chunk.FirstKey; i < chunk.FirstKey + chunk.KeyCount; i++)
+		{
+			const DrawRecord& record = m_DrawRecords[m_DrawKeys[i].RecordIndex];
+
+			// The mesh may have been destroyed after it was submitted, its instances are skipped by the culling pass
+			const GPUMeshBuffer* meshBuffer = m_MeshPool.Get(record.Mesh);
+			if (!meshBuffer)
+			{
+				for (uint32_t j = 0; j < record.InstanceCount; j++)
+					instances[record.FirstInstance + j].DrawIndex = INVALID_DRAW;
+				continue;
+			}
+
+			const GPUTexture* texture = m_TexturePool.Get(record.Texture);
+			const uint32_t textureIndex = texture && texture->BindlessIndex != VkBindlessTextures::INVALID_INDEX ? texture->BindlessIndex : m_ErrorCheckerboardIndex;
+
+			if (drawCount == 0 || !(record.Mesh == drawMesh))
+			{
+				GPUDrawData& draw = draws[drawCount++];
+				draw.BoundingSphere = meshBuffer->BoundingSphere;
+				draw.FirstIndex = meshBuffer->FirstIndex;
+				draw.VertexOffset = static_cast<int32_t>(meshBuffer->VertexOffset);
+				draw.IndexCount = meshBuffer->IndexCount;
+				draw.FirstVisible = visibleCount;
+
+				drawMesh = record.Mesh;
+			}
+
+			const uint32_t drawIndex = chunk.FirstKey + drawCount - 1;
+			for (uint32_t j = 0; j < record.InstanceCount; j++)
+			{
+				instances[record.FirstInstance + j].DrawIndex = drawIndex;
+				instances[record.FirstInstance + j].TextureIndex = textureIndex;
+			}
+
+			visibleCount += record.InstanceCount;
+			drawnInstances += record.InstanceCount;
+		}
+
+		chunk.DrawCount = drawCount;
+		chunk.DrawnInstances = drawnInstances;
+		if (drawCount == 0)
+			return;
+
+		// Secondaries inherit nothing but the attachments, every chunk sets up its own state
+		VkViewport viewport = {};
+		viewport.x = 0;
+		viewport.y = 0;
+		viewport.width = m_DrawExtent.width;
+		viewport.height = m_DrawExtent.height;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+		VkRect2D scissor = {};
+		scissor.offset.x = 0;
+		scissor.offset.y = 0;
+		scissor.extent.width = m_DrawExtent.width;
+		scissor.extent.height = m_DrawExtent.height;
+
+		vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_IndirectMeshPipeline);
+
+		// Textures are indexed per instance, so the table is bound once and the whole chunk is one indirect call
+		std::array<VkDescriptorSet, 2> sets = { m_BindlessTextures.GetSet(), sceneSet };
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_IndirectMeshPipelineLayout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
+
+		// Every mesh is in the arena, one index buffer bind covers the whole chunk
+		vkCmdBindIndexBuffer(cmd, m_MeshArena.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+		// Draws whose instances were all culled have an instanceCount of 0
+		vkCmdDrawIndexedIndirect(cmd, frame.DrawCommandBuffer.Buffer, chunk.FirstKey * sizeof(VkDrawIndexedIndirectCommand), drawCount, sizeof(VkDrawIndexedIndirectCommand));
+	}
+
+	void VkGraphicsDevice::ClearDrawList()
+	{
+		// Keep the capacity, steady state frames do not allocate
+		m_DrawRecords.clear();
+		m_DrawKeys.clear();
+		GetCurrentFrameData().InstanceCount = 0;
+	}
+
+	void VkGraphicsDevice::EnsureInstanceCapacity(FrameData& frame, uint32_t instanceCount)
+	{
+		if (instanceCount <= frame.InstanceCapacity)
+			return;
+
+		const uint32_t capacity = std::bit_ceil(std::max(instanceCount, 256u));
+		AllocatedBuffer instanceBuffer = AllocateBuffer(capacity * sizeof(GPUInstanceData),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+		AllocatedBuffer visibleInstanceBuffer = AllocateBuffer(capacity * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		if (frame.InstanceCapacity > 0)
+		{
+			// Called while the frame is being filled, keep what was submitted so far
+			std::memcpy(instanceBuffer.AllocationInfo.pMappedData, frame.InstanceBuffer.AllocationInfo.pMappedData, frame.InstanceCount * sizeof(GPUInstanceData));
+			DeferDestroyBuffer(frame.InstanceBuffer);
+			DeferDestroyBuffer(frame.VisibleInstanceBuffer);
+		}
+
+		frame.InstanceBuffer = instanceBuffer;
+		frame.VisibleInstanceBuffer = visibleInstanceBuffer;
+		frame.InstanceCapacity = capacity;
+	}
+
+	void VkGraphicsDevice::EnsureDrawCapacity(FrameData& frame, uint32_t drawCount)
+	{
+		if (drawCount <= frame.DrawCapacity)
+			return;
+
+		if (frame.DrawCapacity > 0)
+		{
+			DeferDestroyBuffer(frame.DrawBuffer);
+			DeferDestroyBuffer(frame.DrawCommandBuffer);
+		}
+
+		frame.DrawCapacity = std::bit_ceil(std::max(drawCount, 64u));
+		frame.DrawBuffer = AllocateBuffer(frame.DrawCapacity * sizeof(GPUDrawData),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+		frame.DrawCommandBuffer = AllocateBuffer(frame.DrawCapacity * sizeof(VkDrawIndexedIndirectCommand),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VMA_MEMORY_USAGE_GPU_ONLY);
+	}
+
+	VkDeviceAddress VkGraphicsDevice::GetBufferDeviceAddress(VkBuffer buffer) const
+	{
+		VkBufferDeviceAddressInfo addressInfo{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+			.buffer = buffer,
+		};
+		return vkGetBufferDeviceAddress(m_Device, &addressInfo);
+	}
+
 	void VkGraphicsDevice::DrawBackground(VkCommandBuffer commandBuffer)
 	{
 		//make a clear-color from frame number. This will flash with a 120 frame period.
@@ -980,6 +1815,15 @@ namespace QE
 
 		bufferInfo.usage = usage;
 
+		// Shared with the transfer queue so uploads need no ownership transfers
+		std::array<uint32_t, 2> queueFamilies = { m_QueueFamilyIndices.graphicsFamily.value(), m_QueueFamilyIndices.transferFamily.value_or(0) };
+		if (m_QueueFamilyIndices.transferFamily.has_value())
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+		}
+
 		VmaAllocationCreateInfo vmaallocInfo = {};
 		vmaallocInfo.usage = memoryUsage;
 		vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
@@ -993,25 +1837,9 @@ namespace QE
 		return newBuffer;
 	}
 
-	void VkGraphicsDevice::UploadDataToBuffer(AllocatedBuffer &buffer, void *data, size_t dataSize)
+	UploadToken VkGraphicsDevice::UploadDataToBuffer(AllocatedBuffer &buffer, const void *data, size_t dataSize)
 	{
-		AllocatedBuffer staging = AllocateBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-		void* mappedData;
-		vmaMapMemory(m_Allocator, staging.Allocation, &mappedData);
-
-		// copy data into the staging buffer
-		memcpy(mappedData, data, dataSize);
-
-		ImmediateCommandSubmit([&](VkCommandBuffer cmd) {
-			VkBufferCopy buffCopy{ 0 };
-			buffCopy.dstOffset = 0;
-			buffCopy.srcOffset = 0;
-			buffCopy.size = dataSize;
-
-			vkCmdCopyBuffer(cmd, staging.Buffer, buffer.Buffer, 1, &buffCopy);
-		});
-
-		DestroyBuffer(staging);
+		return m_UploadQueue.UploadBuffer(buffer.Buffer, ByteView(data, dataSize));
 	}
 
 	void VkGraphicsDevice::DestroyBuffer(const AllocatedBuffer& buffer)
@@ -1030,6 +1858,15 @@ namespace QE
 		if (mipmapped)
 			imgInfo.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(size.width, size.height)))) + 1;
 
+		// Shared with the transfer queue so uploads need no ownership transfers
+		std::array<uint32_t, 2> queueFamilies = { m_QueueFamilyIndices.graphicsFamily.value(), m_QueueFamilyIndices.transferFamily.value_or(0) };
+		if (m_QueueFamilyIndices.transferFamily.has_value())
+		{
+			imgInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			imgInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+			imgInfo.pQueueFamilyIndices = queueFamilies.data();
+		}
+
 		VmaAllocationCreateInfo allocInfo = {};
 		allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
 		allocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
@@ -1051,39 +1888,13 @@ namespace QE
 		return newImage;
 	}
 
-	AllocatedImage VkGraphicsDevice::CreateImage(void *data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage,
+	AllocatedImage VkGraphicsDevice::CreateImage(const void *data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage,
 		bool mipmapped)
 	{
 		size_t data_size = size.depth * size.width * size.height * 4; // 4 is the channel components i believe
-		AllocatedBuffer uploadbuffer = AllocateBuffer(data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-		memcpy(uploadbuffer.AllocationInfo.pMappedData, data, data_size);
 
 		AllocatedImage new_image = CreateImage(size, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, mipmapped);
-
-		ImmediateCommandSubmit([&](VkCommandBuffer cmd) {
-			VkInit::TransitionImage(cmd, new_image.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-			VkBufferImageCopy copyRegion = {};
-			copyRegion.bufferOffset = 0;
-			copyRegion.bufferRowLength = 0;
-			copyRegion.bufferImageHeight = 0;
-
-			copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			copyRegion.imageSubresource.mipLevel = 0;
-			copyRegion.imageSubresource.baseArrayLayer = 0;
-			copyRegion.imageSubresource.layerCount = 1;
-			copyRegion.imageExtent = size;
-
-			// copy the buffer into the image
-			vkCmdCopyBufferToImage(cmd, uploadbuffer.Buffer, new_image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-				&copyRegion);
-
-			VkInit::TransitionImage(cmd, new_image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-			});
-
-		DestroyBuffer(uploadbuffer);
+		m_UploadQueue.UploadImage(new_image.Image, size, ByteView(data, data_size));
 
 		return new_image;
 	}
@@ -1093,4 +1904,60 @@ namespace QE
 		vkDestroyImageView(m_Device, image.ImageView, nullptr);
 		vmaDestroyImage(m_Allocator, image.Image, image.Allocation);
 	}
+
+	void VkGraphicsDevice::DeferDestroyBuffer(const AllocatedBuffer& buffer)
+	{
+		m_FrameDeletionQueue.Push(buffer.Buffer, buffer.Allocation, m_CurrentFrameNumber);
+	}
+
+	void VkGraphicsDevice::DeferDestroyImage(const AllocatedImage& image)
+	{
+		m_FrameDeletionQueue.Push(image.ImageView, m_CurrentFrameNumber);
+		m_FrameDeletionQueue.Push(image.Image, image.Allocation, m_CurrentFrameNumber);
+	}
+
+	void VkGraphicsDevice::RecordFrameCapture(VkCommandBuffer cmd)
+	{
+		// Runs as a render graph pass that reads the draw image as a transfer source, only the part the frame rendered to is read back
+		PendingCapture capture;
+		capture.Frame = m_CurrentFrameNumber;
+		capture.Extent = m_DrawExtent;
+		capture.Path = std::move(m_CaptureRequest);
+		capture.Buffer = AllocateBuffer(static_cast<size_t>(m_DrawExtent.width) * m_DrawExtent.height * 4 * sizeof(uint16_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+		m_CaptureRequest.clear();
+
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { m_DrawExtent.width, m_DrawExtent.height, 1 };
+		ResourceState bufferState;
+		m_Barriers.Buffer(capture.Buffer.Buffer, bufferState, ResourceUsage::TransferDst, ResourceAccess::Overwrite);
+		vkCmdCopyImageToBuffer(cmd, m_DrawImage.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, capture.Buffer.Buffer, 1, &region);
+
+		// Make the copy visible to the host once the frame's timeline value is reached
+		m_Barriers.Buffer(capture.Buffer.Buffer, bufferState, ResourceUsage::HostRead, ResourceAccess::Read);
+		m_Barriers.Flush(cmd);
+
+		m_PendingCaptures.push_back(std::move(capture));
+	}
+
+	void VkGraphicsDevice::WriteCompletedCaptures(uint32_t completedFrame)
+	{
+		// Captures are recorded in frame order
+		size_t written = 0;
+		for (; written < m_PendingCaptures.size() && m_PendingCaptures[written].Frame <= completedFrame; written++)
+		{
+			PendingCapture& capture = m_PendingCaptures[written];
+			vmaInvalidateAllocation(m_Allocator, capture.Buffer.Allocation, 0, VK_WHOLE_SIZE);
+
+			if (WritePPM(capture.Path, static_cast<const uint16_t*>(capture.Buffer.AllocationInfo.pMappedData), capture.Extent))
+				LOG_INFO_TAG("VkGraphicsDevice", "Captured frame {} to {}", capture.Frame, capture.Path);
+			else
+				LOG_ERROR_TAG("VkGraphicsDevice", "Failed to write frame capture {}", capture.Path);
+
+			DestroyBuffer(capture.Buffer);
+		}
+
+		m_PendingCaptures.erase(m_PendingCaptures.begin(), m_PendingCaptures.begin() + written);
+	}
 }
@@ -1,17 +1,36 @@
 #include "RHI/GraphicsDevice.h"
+#include "RHI/DrawChunks.h"
 
 #include <vector>
+#include <memory_resource>
 #include <cstdint>
+#include <string>
+#include <mutex>
 
 #include <vulkan/vulkan.h>
 #include <vma/vk_mem_alloc.h>
 #include "VkInit.h"
 #include "VkTypes.h"
 #include "VkDescriptors.h"
+#include "VkDeletionQueue.h"
+#include "VkFrameScheduler.h"
+#include "VkGpuProfiler.h"
+#include "VkBarrierBatcher.h"
+#include "VkParallelRecorder.h"
+#include "VkRenderGraph.h"
+#include "VkUploadQueue.h"
+#include "VkMeshArena.h"
+#include "VkBindlessTextures.h"
+#include "VkPersistentPipelineCache.h"
+#include "VkShaderCompiler.h"
+
+#include "Platform/FileWatcher.h"
 
 #include "Renderer/TestCamera.h"
 
+#include "Core/Allocators/TLSFAllocator.h"
 #include "Core/Containers/DeletionQueue.h"
+#include "Core/Containers/HandlePool.h"
 
 namespace QE
 {
@@ -22,10 +41,18 @@ namespace QE
 
 		VkSemaphore SwapchainSemaphore;
 		VkSemaphore RenderSemaphore;
-		VkFence RenderFence;
 
-		DeletionQueue CleanupQueue;
 		DescriptorAllocatorGrowable FrameDescriptors{};
+
+		// GPU-driven drawing, rewritten every frame so each frame in flight owns its own copy
+		AllocatedBuffer SceneDataBuffer{};
+		AllocatedBuffer InstanceBuffer{}; // persistently mapped, instances are written as they are submitted
+		AllocatedBuffer VisibleInstanceBuffer{};
+		AllocatedBuffer DrawBuffer{};
+		AllocatedBuffer DrawCommandBuffer{};
+		uint32_t InstanceCount = 0;
+		uint32_t InstanceCapacity = 0;
+		uint32_t DrawCapacity = 0;
 	};
 
 	struct ComputePushConstants
@@ -46,7 +73,16 @@ namespace QE
 		ComputePushConstants Data;
 	};
 
-	constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 2;
+	// Slots that are allocated, how many of them are used is set at runtime
+	constexpr unsigned int MAX_FRAMES_IN_FLIGHT = VkFrameScheduler::MAX_FRAMES_IN_FLIGHT;
+	constexpr unsigned int DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+	// CPU memory of the draw list, enough for a couple hundred thousand draws
+	constexpr std::size_t DRAW_LIST_MEMORY_SIZE = 16 * 1024 * 1024;
+
+	constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT; // good format for reverse Z
+	// Stages that may touch the acquired swapchain image first, the submission waits for the acquire there
+	constexpr VkPipelineStageFlags2 SWAPCHAIN_ACQUIRE_STAGES = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 
 	class VkGraphicsDevice : public GraphicsDevice
 	{
@@ -59,16 +95,39 @@ namespace QE
 		void PresentFrame() override;
 
 		void UpdateWindowSize(uint32_t width, uint32_t height) override;
+		void SetRenderScale(float scale) override;
+		float GetRenderScale() const override;
+		void SetFramesInFlight(uint32_t count) override;
+		uint32_t GetFramesInFlight() const override;
+		const FramePacingStats& GetFramePacingStats() const override;
+		uint32_t GetFrameNumber() const override { return m_CurrentFrameNumber; }
+		const GpuFrameProfile& GetGpuFrameProfile() const override;
+		void SetConservativeBarriers(bool conservative) override;
+		bool GetConservativeBarriers() const override;
+		const RenderGraphStats& GetRenderGraphStats() const override;
+		void CaptureFrame(const std::string& path) override;
 
 		std::unique_ptr<GraphicsContext> CreateGraphicsContext() override;
 		void WaitForDeviceIdle() override;
 
-		BufferHandle CreateBuffer(BufferDescription desc) override;
-		TextureHandle CreateTexture(TextureDescription desc) override;
+		BufferHandle CreateBuffer(const BufferDescription& desc) override;
+		TextureHandle CreateTexture(const TextureDescription& desc) override;
 		MeshHandle CreateMesh(std::span<Vertex> vertices,  std::span<uint32_t> indices) override;
 
+		void DestroyBuffer(BufferHandle buffer) override;
+		void DestroyTexture(TextureHandle texture) override;
+		void DestroyMesh(MeshHandle mesh) override;
+
+		void SubmitDraw(const DrawPacket& packet) override;
+		void DrawMeshInstanced(MeshHandle mesh, TextureHandle texture, std::span<const glm::mat4> transforms) override;
+		const DrawStats& GetDrawStats() const override;
+		void SetRecordThreads(uint32_t count) override;
+		uint32_t GetRecordThreads() const override;
+		uint32_t GetMaxRecordThreads() const override;
 		void DrawMesh(MeshHandle mesh, TextureHandle* texture = nullptr) override;
 		void SetCamera(TestCamera* camera) override;
+		void RegisterAllocators(MemoryRegistry& registry) override;
+		void UnregisterAllocators(MemoryRegistry& registry) override;
 
 		VkInstance GetVkInstance() const { return m_Instance; }
 		VkPhysicalDevice GetVkPhysicalDevice() const { return m_PhysicalDevice; }
@@ -79,9 +138,10 @@ namespace QE
 		uint32_t GetCurrentFrameNumber() const { return m_CurrentFrameNumber; }
 		FrameData& GetCurrentFrameData();
 
-		AllocatedBuffer GetBufferFromHandle(BufferHandle handle);
-		AllocatedImage GetTextureFromHandle(TextureHandle handle);
-		GPUMeshBuffer GetMeshFromHandle(MeshHandle handle);
+		// nullptr if the handle is stale
+		AllocatedBuffer* GetBufferFromHandle(BufferHandle handle);
+		AllocatedImage* GetTextureFromHandle(TextureHandle handle);
+		GPUMeshBuffer* GetMeshFromHandle(MeshHandle handle);
 
 	private:
 		Window* m_Window;
@@ -95,12 +155,16 @@ namespace QE
 		VkInit::QueueFamilyIndices m_QueueFamilyIndices;
 		VkQueue m_GraphicsQueue;
 		VkQueue m_PresentQueue;
+		VkQueue m_TransferQueue; // same as the graphics queue when there is no dedicated transfer family
 
-		VkSurfaceKHR m_Surface;
+		VkSurfaceKHR m_Surface = VK_NULL_HANDLE; // stays VK_NULL_HANDLE when headless
 		VkExtent2D m_WindowExtent; // window size
+		bool m_Headless = false; // no surface or swapchain, frames end in the draw image
 
-		bool m_ResizeRequested = false;
-		VkSwapchainKHR m_Swapchain;
+		bool m_ResizeRequested = false; // set by resize events and out of date results, handled in BeginFrame
+		bool m_FrameSkipped = false; // no swapchain image was acquired, nothing is submitted or presented
+		float m_RenderScale = 1.0f;
+		VkSwapchainKHR m_Swapchain = VK_NULL_HANDLE; // stays VK_NULL_HANDLE when headless
 		VkExtent2D m_SwapchainExtent;
 		VkFormat m_SwapchainImageFormat;
 		std::vector<VkImage> m_SwapchainImages;
@@ -110,14 +174,48 @@ namespace QE
 		// Frame data
 		FrameData m_FrameData[MAX_FRAMES_IN_FLIGHT];
 		uint32_t m_CurrentFrameNumber = 0;
+		VkFrameScheduler m_FrameScheduler;
+		VkGpuProfiler m_GpuProfiler; // one query range per frame slot
+		uint32_t m_PendingFramesInFlight = 0; // applied at the start of the next frame, 0 when nothing changes
+		bool m_FrameRecording = false; // the frame has waited for its slot and begun its command buffer
 
 		VmaAllocator m_Allocator;
-		DeletionQueue m_CleanupQueue;
+		DeletionQueue m_CleanupQueue; // device lifetime teardown that needs more than destroying an object
+		VkDeletionQueue m_LifetimeDeletionQueue; // device lifetime objects, only flushed on shutdown
+		VkDeletionQueue m_FrameDeletionQueue; // objects retired at runtime, destroyed once the frames that used them are done
+		VkUploadQueue m_UploadQueue;
+		VkMeshArena m_MeshArena; // vertex and index data of every mesh
+		VkBindlessTextures m_BindlessTextures; // every texture, sampled by slot index
+
+		// RHI resources
+		HandlePool<AllocatedBuffer, BufferHandle> m_BufferPool;
+		HandlePool<GPUTexture, TextureHandle> m_TexturePool;
+		HandlePool<GPUMeshBuffer, MeshHandle> m_MeshPool;
+
+		// Draw list, filled during the frame and flushed by EndFrame
+		struct DrawRecord
+		{
+			MeshHandle Mesh;
+			TextureHandle Texture;
+			uint32_t FirstInstance; // in the frame's instance buffer
+			uint32_t InstanceCount;
+		};
+		// The lists keep their capacity between frames, so their heap only grows with the scene
+		std::unique_ptr<std::byte[]> m_DrawListMemory = std::make_unique_for_overwrite<std::byte[]>(DRAW_LIST_MEMORY_SIZE);
+		TLSFAllocator m_DrawListAllocator{ DRAW_LIST_MEMORY_SIZE, m_DrawListMemory.get() };
+		TLSFMemoryResource m_DrawListResource{ m_DrawListAllocator };
+		std::pmr::vector<DrawRecord> m_DrawRecords{ &m_DrawListResource };
+		std::pmr::vector<DrawKey> m_DrawKeys{ &m_DrawListResource };
+		std::pmr::vector<DrawChunk> m_DrawChunks{ &m_DrawListResource };
+		VkParallelRecorder m_DrawRecorder;
+		DrawStats m_DrawStats;
 
 		// Drawing resources
 		AllocatedImage m_DrawImage;
-		AllocatedImage m_DepthImage;
+		ResourceState m_DrawImageState; // where the last frame's render graph left the draw image
 		VkExtent2D m_DrawExtent;
+		VkRenderGraph m_RenderGraph;
+		VkBarrierBatcher m_Barriers; // buffer barriers recorded outside the render graph
 
 		DescriptorAllocator m_DescriptorAllocator;
 		VkDescriptorSet m_DrawImageDescriptors;
@@ -126,6 +224,30 @@ namespace QE
 		// Pipeline stuff
 		VkPipeline m_GradientPipeline;
 		VkPipelineLayout m_GradientPipelineLayout;
+		VkPersistentPipelineCache m_PipelineCache;
+		VkShaderCompiler m_ShaderCompiler;
+
+		// Pipelines rebuilt when one of their shaders changes on disk, Build only creates the pipeline, the layout stays
+		struct ReloadablePipeline
+		{
+			std::vector<std::string> Shaders;
+			VkPipeline* Pipeline;
+			VkPipeline (VkGraphicsDevice::*Build)();
+		};
+		std::vector<ReloadablePipeline> m_ReloadablePipelines;
+		FileWatcher m_ShaderWatcher;
+		std::mutex m_PipelineInitMutex; // pipelines are initialized in parallel, guards the containers they add to
+
+		// Frame readback, the buffer is written to disk once the GPU has finished the frame
+		struct PendingCapture
+		{
+			uint32_t Frame;
+			VkExtent2D Extent;
+			AllocatedBuffer Buffer; // RGBA16F pixels, tightly packed
+			std::string Path;
+		};
+		std::string m_CaptureRequest; // for the frame being recorded, empty when nothing is captured
+		std::vector<PendingCapture> m_PendingCaptures; // in frame order
 
 		// ImGui stuff (refactor later)
 		VkFence m_ImGuiFence;
@@ -136,16 +258,19 @@ namespace QE
 		std::vector<ComputeEffect> m_BackgroundEffects;
 		int m_CurrentBackgroundEffect = 0;
 
-		// Mesh
-		VkPipelineLayout m_MeshPipelineLayout;
-		VkPipeline m_MeshPipeline;
+		// GPU-driven drawing
+		VkPipelineLayout m_CullPipelineLayout;
+		VkPipeline m_CullPipeline;
+		VkPipelineLayout m_IndirectMeshPipelineLayout;
+		VkPipeline m_IndirectMeshPipeline;
 
-		VkDescriptorSetLayout m_SingleImageDescriptorLayout;
+		VkDescriptorSetLayout m_SceneDataDescriptorLayout;
 
 		AllocatedImage m_WhiteImage;
 		AllocatedImage m_BlackImage;
 		AllocatedImage m_GreyImage;
 		AllocatedImage m_ErrorCheckerboardImage;
+		uint32_t m_ErrorCheckerboardIndex; // bindless slot, drawn in place of missing textures
 
 		VkSampler m_DefaultSamplerLinear;
 		VkSampler m_DefaultSamplerNearest;
@@ -153,13 +278,29 @@ namespace QE
 		// Initialize Vulkan Resources
 		void InitSwapchain(VkExtent2D windowExtent);
 		void CreateSwapchain(VkExtent2D windowExtent);
-		void RecreateSwapchain();
+		// Returns false while the window has no area, the request stays pending
+		bool RecreateSwapchain();
+		void CreateDrawTargets(VkExtent2D extent);
+		// The draw image is destroyed once the frames in flight are done with it
+		void RetireDrawTargets();
 		void DestroySwapchain();
 		void InitializeFrameData();
+		// Waits for the frame's slot and starts recording, called the first time the frame needs GPU resources
+		void BeginFrameRecording();
+		// Releases what was retired by frames the GPU has finished, does not block
+		void ReclaimCompletedFrames();
+		// Packs the mesh arena once unloads have left its free space split up, called before anything is drawn
+		void CompactMeshArena();
 		void InitializeDescriptors();
 		void InitializePipelines();
 		void InitializeBackgroundPipelines();
-		void InitializeMeshPipeline();
+		void InitializeCullPipeline();
+		void InitializeIndirectMeshPipeline();
+		VkPipeline BuildCullPipeline();
+		VkPipeline BuildIndirectMeshPipeline();
+		// Builds the pipeline now and again whenever one of the shaders changes
+		void RegisterReloadablePipeline(std::vector<std::string> shaders, VkPipeline* pipeline, VkPipeline (VkGraphicsDevice::*build)());
+		void ReloadChangedShaders();
 		void InitializeImGui();
 		void InitializeDefaultData();
 
@@ -167,13 +308,30 @@ namespace QE
 
 		// REFACTOR LATER
 		void DrawBackground(VkCommandBuffer cmd);
+		// Runs as the mesh pass of the render graph
+		void FlushDrawList(VkCommandBuffer cmd, VkImageView depthView);
+		// Runs on a recording worker, fills the chunk's draws and instances and records its indirect draw
+		void RecordDrawChunk(DrawChunk& chunk, VkCommandBuffer cmd, VkDescriptorSet sceneSet);
+		void ClearDrawList();
+		// Grow the frame's draw buffers, the old ones are destroyed once the GPU is done with them.
+		// Instances already written to the frame are carried over
+		void EnsureInstanceCapacity(FrameData& frame, uint32_t instanceCount);
+		void EnsureDrawCapacity(FrameData& frame, uint32_t drawCount);
+		VkDeviceAddress GetBufferDeviceAddress(VkBuffer buffer) const;
 		void ImmediateCommandSubmit(std::function<void(VkCommandBuffer cmd)>&& function);
 		void DrawImGui(VkCommandBuffer cmd, VkImageView targetImageView);
 		AllocatedBuffer AllocateBuffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
-		void UploadDataToBuffer(AllocatedBuffer& buffer, void* data, size_t dataSize);
+		// Asynchronous, the data is copied out before returning and the frame waits for the upload on the GPU
+		UploadToken UploadDataToBuffer(AllocatedBuffer& buffer, const void* data, size_t dataSize);
 		void DestroyBuffer(const AllocatedBuffer& buffer);
 		AllocatedImage CreateImage(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped = false);
-		AllocatedImage CreateImage(void* data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped = false);
+		AllocatedImage CreateImage(const void* data, VkExtent3D size, VkFormat format, VkImageUsageFlags usage, bool mipmapped = false);
 		void DestroyImage(const AllocatedImage& image);
+		// Queue for destruction once every frame in flight that may still use it has finished
+		void DeferDestroyBuffer(const AllocatedBuffer& buffer);
+		void DeferDestroyImage(const AllocatedImage& image);
+		// Copies the draw image into a readback buffer, written out by WriteCompletedCaptures
+		void RecordFrameCapture(VkCommandBuffer cmd);
+		void WriteCompletedCaptures(uint32_t completedFrame);
 	};
 }
\ No newline at end of file
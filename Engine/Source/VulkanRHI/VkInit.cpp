@@ -3,6 +3,7 @@
 
 #include <GLFW/glfw3.h>
 #include <set>
+#include <cstring>
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
@@ -25,6 +26,16 @@ namespace VkInit
 		VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
 	};
 
+	// Headless devices have no surface and never present, so they do not need the swapchain extension
+	static std::vector<const char*> GetDeviceExtensions(VkSurfaceKHR surface)
+	{
+		std::vector<const char*> extensions = s_DeviceExtensions;
+		if (surface == VK_NULL_HANDLE)
+			std::erase_if(extensions, [](const char* extension) { return std::strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0; });
+
+		return extensions;
+	}
+
 	// Debug messenger
 	static VKAPI_ATTR VkBool32 VKAPI_CALL s_VkDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
 	{
@@ -56,7 +67,7 @@ namespace VkInit
 		}
 	}
 
-	static bool CheckDeviceExtensionSupport(VkPhysicalDevice device)
+	static bool CheckDeviceExtensionSupport(VkPhysicalDevice device, VkSurfaceKHR surface)
 	{
 		uint32_t extensionCount;
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -64,7 +75,8 @@ namespace VkInit
 		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-		std::set<std::string> requiredExtensions(s_DeviceExtensions.begin(), s_DeviceExtensions.end());
+		const std::vector<const char*> deviceExtensions = GetDeviceExtensions(surface);
+		std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 		for (const auto& extension : availableExtensions)
 		{
 			requiredExtensions.erase(extension.extensionName);
@@ -107,10 +119,11 @@ namespace VkInit
 	{
 		QueueFamilyIndices indices = FindQueueFamilies(device, surface);
 
-		bool extensionsSupported = CheckDeviceExtensionSupport(device);
+		bool extensionsSupported = CheckDeviceExtensionSupport(device, surface);
 
-		bool swapChainAdequate = false;
-		if (extensionsSupported)
+		// Nothing to present to without a surface
+		bool swapChainAdequate = surface == VK_NULL_HANDLE;
+		if (extensionsSupported && !swapChainAdequate)
 		{
 			SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device, surface);
 			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -419,7 +432,7 @@ namespace VkInit
 	}
 
 	// Vulkan object builders
-	VkInstance CreateInstance()
+	VkInstance CreateInstance(bool headless)
 	{
 		VkApplicationInfo appInfo{};
 		appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -433,7 +446,7 @@ namespace VkInit
 		instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 		instanceCreateInfo.pApplicationInfo = &appInfo;
 
-		auto extensions = GetRequiredExtensions();
+		auto extensions = GetRequiredExtensions(headless);
 		instanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 		instanceCreateInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -514,7 +527,7 @@ namespace VkInit
 		return physicalDevice;
 	}
 
-	VkDevice CreateLogicalDevice(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkQueue* graphicsQueue, VkQueue* presentQueue)
+	VkDevice CreateLogicalDevice(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkQueue* graphicsQueue, VkQueue* presentQueue, VkQueue* transferQueue)
 	{
 		QueueFamilyIndices indices = FindQueueFamilies(physicalDevice, surface);
 
@@ -523,6 +536,8 @@ namespace VkInit
 			indices.graphicsFamily.value(),
 			indices.presentFamily.value()
 		};
+		if (indices.transferFamily.has_value())
+			uniqueQueueFamilies.insert(indices.transferFamily.value());
 
 		float queuePriority = 1.0f;
 		for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -536,6 +551,17 @@ namespace VkInit
 		}
 
 		VkPhysicalDeviceFeatures deviceFeatures{};
+		deviceFeatures.multiDrawIndirect = VK_TRUE; // indirect draws with more than one command
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE; // GPU culling points each draw at its visible instances through firstInstance
+
+		// Pipeline statistics for the GPU profiler, only when zones around secondary command buffers can inherit them
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+		if (supportedFeatures.pipelineStatisticsQuery && supportedFeatures.inheritedQueries)
+		{
+			deviceFeatures.pipelineStatisticsQuery = VK_TRUE;
+			deviceFeatures.inheritedQueries = VK_TRUE;
+		}
 
 		VkDeviceCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -545,28 +571,32 @@ namespace VkInit
 
 		createInfo.pEnabledFeatures = &deviceFeatures;
 
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(s_DeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = s_DeviceExtensions.data();
-
-		// Synchronization 2 extension
-		VkPhysicalDeviceSynchronization2Features sync2Features = {};
-		sync2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
-		sync2Features.pNext = nullptr;
-		sync2Features.synchronization2 = VK_TRUE;
-
-		// Buffer Device Address extension
-		VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures = {};
-		bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-		bufferDeviceAddressFeatures.pNext = &sync2Features;
-		bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
-
-		// Dynamic Rendering extension
-		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
-		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
-		dynamicRenderingFeatures.pNext = &bufferDeviceAddressFeatures;
-		dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
-
-		createInfo.pNext = &dynamicRenderingFeatures;
+		const std::vector<const char*> deviceExtensions = GetDeviceExtensions(surface);
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+		// 1.3 features, Synchronization 2 and Dynamic Rendering
+		VkPhysicalDeviceVulkan13Features features13 = {};
+		features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		features13.pNext = nullptr;
+		features13.synchronization2 = VK_TRUE;
+		features13.dynamicRendering = VK_TRUE;
+
+		// 1.2 features, these can't be chained as their own structs once the 1.2 struct is used
+		VkPhysicalDeviceVulkan12Features features12 = {};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features12.pNext = &features13;
+		features12.bufferDeviceAddress = VK_TRUE;
+		features12.timelineSemaphore = VK_TRUE; // used to track uploads
+		// Bindless textures
+		features12.descriptorIndexing = VK_TRUE;
+		features12.runtimeDescriptorArray = VK_TRUE;
+		features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		features12.descriptorBindingPartiallyBound = VK_TRUE;
+		features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+		createInfo.pNext = &features12;
 		
 		VkDevice device = VK_NULL_HANDLE;
 
@@ -577,11 +607,12 @@ namespace VkInit
 
 		vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, graphicsQueue);
 		vkGetDeviceQueue(device, indices.presentFamily.value(), 0, presentQueue);
+		vkGetDeviceQueue(device, indices.transferFamily.value_or(indices.graphicsFamily.value()), 0, transferQueue);
 
 		return device;
 	}
 
-	VkSwapchainKHR CreateSwapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, VkExtent2D windowSize, std::vector<VkImage>* swapchainImages, VkFormat* swapchainImageFormat, VkExtent2D* swapchainExtent)
+	VkSwapchainKHR CreateSwapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, VkExtent2D windowSize, std::vector<VkImage>* swapchainImages, VkFormat* swapchainImageFormat, VkExtent2D* swapchainExtent, VkSwapchainKHR oldSwapchain)
 	{
 		SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(physicalDevice, surface);
 
@@ -627,7 +658,8 @@ namespace VkInit
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;
 
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		// Lets the driver hand over resources and keep presenting the old images while the new ones come up
+		createInfo.oldSwapchain = oldSwapchain;
 
 		VkSwapchainKHR swapchain = VK_NULL_HANDLE;
 
@@ -824,6 +856,26 @@ namespace VkInit
 		return semaphore;
 	}
 
+	VkSemaphore CreateTimelineSemaphore(VkDevice device, uint64_t initialValue)
+	{
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.pNext = nullptr;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = initialValue;
+
+		VkSemaphoreCreateInfo semaphoreInfo = VkInit::BuildSemaphoreCreateInfo();
+		semaphoreInfo.pNext = &typeInfo;
+
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create timeline semaphore");
+		}
+
+		return semaphore;
+	}
+
 	// Extra helpers
 	uint32_t GetVulkanExtensionCount()
 	{
@@ -885,12 +937,16 @@ namespace VkInit
 		return true;
 	}
 
-	std::vector<const char*> GetRequiredExtensions()
+	std::vector<const char*> GetRequiredExtensions(bool headless)
 	{
-		uint32_t glfwExtensionsCount = 0;
-		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionsCount);
-
-		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionsCount);
+		// GLFW is never initialized in headless runs, there is no window system to ask
+		std::vector<const char*> extensions;
+		if (!headless)
+		{
+			uint32_t glfwExtensionsCount = 0;
+			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionsCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionsCount);
+		}
 
 		if (s_EnableValidationLayers)
 			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -913,6 +969,17 @@ namespace VkInit
 		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
 		vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
+		// Prefer a family that can only transfer, those map to the copy engines on discrete GPUs
+		for (uint32_t family = 0; family < queueFamilyCount; family++)
+		{
+			const VkQueueFlags flags = queueFamilies[family].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			{
+				indices.transferFamily = family;
+				break;
+			}
+		}
+
 		int i = 0;
 		for (const auto& queueFamily : queueFamilies)
 		{
@@ -921,8 +988,12 @@ namespace VkInit
 				indices.graphicsFamily = i;
 			}
 
+			// Headless devices never present, the graphics queue stands in so the rest of the setup is the same
 			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			if (surface != VK_NULL_HANDLE)
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			else
+				presentSupport = indices.graphicsFamily == static_cast<uint32_t>(i);
 
 			if (presentSupport)
 			{
@@ -972,31 +1043,24 @@ namespace VkInit
 		return subImage;
 	}
 
-	void TransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout)
+	void GlobalBarrier(VkCommandBuffer cmdBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
 	{
-		VkImageMemoryBarrier2 imageBarrier = {};
-		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-		imageBarrier.pNext = nullptr;
-
-		imageBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-		imageBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-		imageBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-		imageBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT;
+		VkMemoryBarrier2 memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		memoryBarrier.pNext = nullptr;
 
-		imageBarrier.oldLayout = oldLayout;
-		imageBarrier.newLayout = newLayout;
+		memoryBarrier.srcStageMask = srcStage;
+		memoryBarrier.srcAccessMask = srcAccess;
+		memoryBarrier.dstStageMask = dstStage;
+		memoryBarrier.dstAccessMask = dstAccess;
 
-		VkImageAspectFlags aspectMask = (newLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-		imageBarrier.subresourceRange = GetImageSubresourceRange(aspectMask);
-		imageBarrier.image = image;
-	
 		VkDependencyInfo depInfo {};
 		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
 		depInfo.pNext = nullptr;
-	
-		depInfo.imageMemoryBarrierCount = 1;
-		depInfo.pImageMemoryBarriers = &imageBarrier;
-	
+
+		depInfo.memoryBarrierCount = 1;
+		depInfo.pMemoryBarriers = &memoryBarrier;
+
 		vkCmdPipelineBarrier2(cmdBuffer, &depInfo);
 	}
 
@@ -1070,4 +1134,20 @@ namespace VkInit
 
 		return shaderModule;
 	}
+
+	VkShaderModule CreateShaderModule(VkDevice device, std::span<const uint32_t> spirv)
+	{
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = spirv.size_bytes();
+		createInfo.pCode = spirv.data();
+
+		VkShaderModule shaderModule;
+		if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create shader module");
+		}
+
+		return shaderModule;
+	}
 }
\ No newline at end of file
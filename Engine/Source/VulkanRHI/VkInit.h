@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <vector>
 #include <optional>
+#include <span>
 #include <vulkan/vulkan.h>
 
 // Initializer helper functions for Vulkan to abstract away the tedium
@@ -22,6 +23,7 @@ namespace VkInit
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		std::optional<uint32_t> transferFamily; // only set when the device has a transfer-only family
 
 		bool IsComplete()
 		{
@@ -57,12 +59,15 @@ namespace VkInit
 	VkPipelineShaderStageCreateInfo BuildShaderStageCreateInfo(VkShaderStageFlagBits stage, VkShaderModule shaderModule, const char* entryPoint = "main");
 
 	// Vulkan initialization functions - use these in order
-	VkInstance CreateInstance();
+	// Headless instances skip the window system extensions, the surface passed to the functions after is then VK_NULL_HANDLE
+	VkInstance CreateInstance(bool headless = false);
 	VkDebugUtilsMessengerEXT CreateDebugMessenger(VkInstance instance, VkDebugUtilsMessengerCreateInfoEXT createInfo);
 	VkPhysicalDevice PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface);
-	VkDevice CreateLogicalDevice(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkQueue* graphicsQueue, VkQueue* presentQueue);
+	// transferQueue is the graphics queue when the device has no dedicated transfer family
+	VkDevice CreateLogicalDevice(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkQueue* graphicsQueue, VkQueue* presentQueue, VkQueue* transferQueue);
+	// oldSwapchain is retired by the new one but still has to be destroyed by the caller
 	VkSwapchainKHR CreateSwapchain(VkPhysicalDevice physicalDevice, VkDevice device, VkSurfaceKHR surface, VkExtent2D windowSize, 
-		std::vector<VkImage>* swapchainImages, VkFormat* swapchainImageFormat, VkExtent2D* swapchainExtent);
+		std::vector<VkImage>* swapchainImages, VkFormat* swapchainImageFormat, VkExtent2D* swapchainExtent, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
 	void CreateSwapchainImageViews(VkDevice device, std::vector<VkImage>* swapchainImages, VkFormat swapchainImageFormat, std::vector<VkImageView>* swapchainImageViews);
 	void CreateGraphicsPipeline(VkDevice device, VkFormat swapchainImageFormat, VkPipelineLayout* pipelineLayout);
 
@@ -71,6 +76,7 @@ namespace VkInit
 
 	VkFence CreateFence(VkDevice device, VkFenceCreateFlags flags = 0);
 	VkSemaphore CreateSemaphore(VkDevice device, VkSemaphoreCreateFlags flags = 0);
+	VkSemaphore CreateTimelineSemaphore(VkDevice device, uint64_t initialValue = 0);
 
 	// Extra helpers
 	uint32_t GetVulkanExtensionCount();
@@ -79,7 +85,7 @@ namespace VkInit
 	uint32_t GetValidationLayerCount();
 	std::vector<VkLayerProperties> GetValidationLayerProps();
 	bool CheckValidationLayerSupport();
-	std::vector<const char*> GetRequiredExtensions();
+	std::vector<const char*> GetRequiredExtensions(bool headless = false);
 
 	void DestroyDebugMessenger(VkInstance* instance, VkDebugUtilsMessengerEXT* messenger, const VkAllocationCallbacks* allocator = nullptr);
 
@@ -91,9 +97,11 @@ namespace VkInit
 	VkImageSubresourceRange GetImageSubresourceRange(VkImageAspectFlags aspectMask);
 	
 	// Next 3 are generally more helpers than initialization functions
-	void TransitionImage(VkCommandBuffer cmdBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout);
+	// Execution and memory dependency that is not tied to a resource
+	void GlobalBarrier(VkCommandBuffer cmdBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess);
 	void CopyImageToImage(VkCommandBuffer cmd, VkImage source, VkImage destination,VkExtent2D srcSize, VkExtent2D dstSize);
 
 	VkShaderModule CreateShaderModule(VkDevice device, const std::string_view& filename);
 	VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& shaderCode);
+	VkShaderModule CreateShaderModule(VkDevice device, std::span<const uint32_t> spirv);
 }
\ No newline at end of file
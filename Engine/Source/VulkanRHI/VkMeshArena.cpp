@@ -0,0 +1,221 @@
+#include "VkMeshArena.h"
+#include "VkCommon.h"
+#include "VkUploadQueue.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace QE
+{
+    namespace
+    {
+        constexpr VkBufferUsageFlags VERTEX_BUFFER_USAGE = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        constexpr VkBufferUsageFlags INDEX_BUFFER_USAGE = VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+            | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        // Compact when at least a quarter of the buffer is free and the largest free range holds under half of it
+        constexpr std::uint32_t COMPACTION_FREE_FRACTION = 4;
+        constexpr std::uint32_t COMPACTION_LARGEST_RANGE_FRACTION = 2;
+
+        bool IsFragmented(const OffsetAllocator& allocator)
+        {
+            const std::uint32_t freeSize = allocator.GetFreeSize();
+            return allocator.GetFreeRangeCount() > 1
+                && freeSize >= allocator.GetTotalSize() / COMPACTION_FREE_FRACTION
+                && allocator.GetLargestFreeRange() < freeSize / COMPACTION_LARGEST_RANGE_FRACTION;
+        }
+    }
+
+    void VkMeshArena::Init(VkDevice device, VmaAllocator allocator, VkUploadQueue* uploadQueue, std::span<const std::uint32_t> queueFamilies,
+        std::uint32_t vertexCapacity, std::uint32_t indexCapacity)
+    {
+        m_Device = device;
+        m_Allocator = allocator;
+        m_UploadQueue = uploadQueue;
+        m_QueueFamilies.assign(queueFamilies.begin(), queueFamilies.end());
+
+        m_VertexBuffer = CreateBuffer(vertexCapacity * sizeof(Vertex), VERTEX_BUFFER_USAGE);
+        m_IndexBuffer = CreateBuffer(indexCapacity * sizeof(std::uint32_t), INDEX_BUFFER_USAGE);
+        m_VertexAllocator = OffsetAllocator(vertexCapacity);
+        m_IndexAllocator = OffsetAllocator(indexCapacity);
+        UpdateVertexBufferAddress();
+
+        LOG_DEBUG_TAG("VkMeshArena", "Created mesh arena for {} vertices and {} indices", vertexCapacity, indexCapacity);
+    }
+
+    void VkMeshArena::Destroy()
+    {
+        m_RetiredBuffers.FlushAll(m_Device, m_Allocator);
+        m_PendingFrees.clear();
+
+        vmaDestroyBuffer(m_Allocator, m_VertexBuffer.Buffer, m_VertexBuffer.Allocation);
+        vmaDestroyBuffer(m_Allocator, m_IndexBuffer.Buffer, m_IndexBuffer.Allocation);
+        m_VertexBuffer = {};
+        m_IndexBuffer = {};
+        m_VertexBufferAddress = 0;
+
+        m_VertexAllocator = OffsetAllocator();
+        m_IndexAllocator = OffsetAllocator();
+    }
+
+    MeshRange VkMeshArena::Allocate(std::span<const Vertex> vertices, std::span<const std::uint32_t> indices, std::uint32_t frame)
+    {
+        if (vertices.empty() || indices.empty())
+        {
+            LOG_ERROR_TAG("VkMeshArena", "Meshes need at least one vertex and one index, got {} and {}", vertices.size(), indices.size());
+            return {};
+        }
+
+        const std::uint32_t vertexCount = static_cast<std::uint32_t>(vertices.size());
+        const std::uint32_t indexCount = static_cast<std::uint32_t>(indices.size());
+
+        MeshRange range;
+        range.Vertices = m_VertexAllocator.Allocate(vertexCount);
+        if (!range.Vertices.IsValid())
+        {
+            GrowVertexBuffer(vertexCount, frame);
+            range.Vertices = m_VertexAllocator.Allocate(vertexCount);
+        }
+
+        range.Indices = m_IndexAllocator.Allocate(indexCount);
+        if (!range.Indices.IsValid())
+        {
+            GrowIndexBuffer(indexCount, frame);
+            range.Indices = m_IndexAllocator.Allocate(indexCount);
+        }
+
+        QE_ASSERT(range.IsValid());
+
+        // Indices stay relative to the mesh, the draw's vertexOffset points them at the mesh's vertices
+        m_UploadQueue->UploadBuffer(m_VertexBuffer.Buffer, ByteView(vertices), range.Vertices.Offset * sizeof(Vertex));
+        m_UploadQueue->UploadBuffer(m_IndexBuffer.Buffer, ByteView(indices), range.Indices.Offset * sizeof(std::uint32_t));
+
+        return range;
+    }
+
+    void VkMeshArena::Free(const MeshRange& range, std::uint32_t frame)
+    {
+        m_PendingFrees.push_back({ range, frame });
+    }
+
+    void VkMeshArena::Update(std::uint32_t completedFrame)
+    {
+        auto firstPending = std::find_if(m_PendingFrees.begin(), m_PendingFrees.end(), [completedFrame](const PendingFree& pending) {
+            return pending.Frame > completedFrame;
+        });
+
+        for (auto it = m_PendingFrees.begin(); it != firstPending; ++it)
+        {
+            m_VertexAllocator.Free(it->Range.Vertices);
+            m_IndexAllocator.Free(it->Range.Indices);
+        }
+        m_PendingFrees.erase(m_PendingFrees.begin(), firstPending);
+
+        m_RetiredBuffers.Flush(m_Device, m_Allocator, completedFrame);
+    }
+
+    bool VkMeshArena::NeedsCompaction() const
+    {
+        return IsFragmented(m_VertexAllocator) || IsFragmented(m_IndexAllocator);
+    }
+
+    void VkMeshArena::Compact(std::span<MeshRange* const> ranges, std::uint32_t frame)
+    {
+        LOG_DEBUG_TAG("VkMeshArena", "Compacting mesh arena, {} meshes, {} free vertex ranges and {} free index ranges",
+            ranges.size(), m_VertexAllocator.GetFreeRangeCount(), m_IndexAllocator.GetFreeRangeCount());
+
+        std::vector<OffsetAllocator::Allocation*> vertices;
+        std::vector<OffsetAllocator::Allocation*> indices;
+        vertices.reserve(ranges.size());
+        indices.reserve(ranges.size());
+        for (MeshRange* range : ranges)
+        {
+            vertices.push_back(&range->Vertices);
+            indices.push_back(&range->Indices);
+        }
+
+        CompactBuffer(m_VertexBuffer, m_VertexAllocator, vertices, sizeof(Vertex), VERTEX_BUFFER_USAGE, frame);
+        CompactBuffer(m_IndexBuffer, m_IndexAllocator, indices, sizeof(std::uint32_t), INDEX_BUFFER_USAGE, frame);
+        UpdateVertexBufferAddress();
+
+        // Those ranges only exist in the retired buffers now
+        m_PendingFrees.clear();
+    }
+
+    AllocatedBuffer VkMeshArena::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage)
+    {
+        VkBufferCreateInfo bufferInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+
+        // Written by the transfer queue and read by the graphics queue
+        if (m_QueueFamilies.size() > 1)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = static_cast<std::uint32_t>(m_QueueFamilies.size());
+            bufferInfo.pQueueFamilyIndices = m_QueueFamilies.data();
+        }
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        AllocatedBuffer buffer{};
+        buffer.Size = size;
+        VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &buffer.Buffer, &buffer.Allocation, &buffer.AllocationInfo));
+        return buffer;
+    }
+
+    void VkMeshArena::GrowVertexBuffer(std::uint32_t requiredCount, std::uint32_t frame)
+    {
+        const std::uint64_t newCount = std::bit_ceil(static_cast<std::uint64_t>(m_VertexAllocator.GetTotalSize()) + requiredCount);
+        QE_ASSERT(newCount <= OffsetAllocator::INVALID_OFFSET);
+
+        Reallocate(m_VertexBuffer, m_VertexAllocator, static_cast<std::uint32_t>(newCount), sizeof(Vertex), VERTEX_BUFFER_USAGE, frame);
+        UpdateVertexBufferAddress();
+    }
+
+    void VkMeshArena::GrowIndexBuffer(std::uint32_t requiredCount, std::uint32_t frame)
+    {
+        const std::uint64_t newCount = std::bit_ceil(static_cast<std::uint64_t>(m_IndexAllocator.GetTotalSize()) + requiredCount);
+        QE_ASSERT(newCount <= OffsetAllocator::INVALID_OFFSET);
+
+        Reallocate(m_IndexBuffer, m_IndexAllocator, static_cast<std::uint32_t>(newCount), sizeof(std::uint32_t), INDEX_BUFFER_USAGE, frame);
+    }
+
+    void VkMeshArena::Reallocate(AllocatedBuffer& buffer, OffsetAllocator& allocator, std::uint32_t newCount, VkDeviceSize stride,
+        VkBufferUsageFlags usage, std::uint32_t frame)
+    {
+        LOG_DEBUG_TAG("VkMeshArena", "Growing mesh arena buffer from {} to {} elements", allocator.GetTotalSize(), newCount);
+
+        // Frames already recorded keep reading the old buffer, it goes away once they are done
+        AllocatedBuffer newBuffer = CreateBuffer(newCount * stride, usage);
+        m_UploadQueue->CopyBuffer(buffer.Buffer, newBuffer.Buffer, allocator.GetTotalSize() * stride);
+        m_RetiredBuffers.Push(buffer.Buffer, buffer.Allocation, frame);
+
+        buffer = newBuffer;
+        allocator.Grow(newCount);
+    }
+
+    void VkMeshArena::CompactBuffer(AllocatedBuffer& buffer, OffsetAllocator& allocator, std::span<OffsetAllocator::Allocation* const> allocations,
+        VkDeviceSize stride, VkBufferUsageFlags usage, std::uint32_t frame)
+    {
+        // Packed into a new buffer, copy regions within one buffer must not overlap and recorded frames still read the old one
+        std::vector<OffsetAllocator::Move> moves = allocator.Compact(allocations);
+        std::vector<VkBufferCopy> regions;
+        regions.reserve(moves.size());
+        for (const OffsetAllocator::Move& move : moves)
+            regions.push_back({ move.SourceOffset * stride, move.DestinationOffset * stride, move.Size * stride });
+
+        AllocatedBuffer newBuffer = CreateBuffer(buffer.Size, usage);
+        m_UploadQueue->CopyBufferRegions(buffer.Buffer, newBuffer.Buffer, regions);
+        m_RetiredBuffers.Push(buffer.Buffer, buffer.Allocation, frame);
+        buffer = newBuffer;
+    }
+
+    void VkMeshArena::UpdateVertexBufferAddress()
+    {
+        VkBufferDeviceAddressInfo addressInfo{ .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .buffer = m_VertexBuffer.Buffer };
+        m_VertexBufferAddress = vkGetBufferDeviceAddress(m_Device, &addressInfo);
+    }
+}
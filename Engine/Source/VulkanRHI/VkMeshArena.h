@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core/Allocators/OffsetAllocator.h"
+#include "RHI/ResourceTypes.h"
+#include "VkDeletionQueue.h"
+#include "VkTypes.h"
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace QE
+{
+    class VkUploadQueue;
+
+    // Where a mesh lives inside the arena, offsets and counts are in vertices and indices
+    struct MeshRange
+    {
+        OffsetAllocator::Allocation Vertices;
+        OffsetAllocator::Allocation Indices;
+
+        [[nodiscard]] bool IsValid() const { return Vertices.IsValid() && Indices.IsValid(); }
+    };
+
+    // Every mesh shares one vertex and one index buffer, each mesh is a range suballocated from them.
+    // A whole frame can then be drawn with a single index buffer bind and multi-draw indirect. When a
+    // buffer runs out of space it is reallocated at twice the size and the old contents are copied over
+    // on the upload queue. Freed ranges and replaced buffers are only released once the frames that may
+    // still read them have finished. Once loads and unloads leave the free space split between live meshes,
+    // Compact packs every mesh into fresh buffers the same way.
+    class VkMeshArena
+    {
+    public:
+        static constexpr std::uint32_t DEFAULT_VERTEX_CAPACITY = 256 * 1024;
+        static constexpr std::uint32_t DEFAULT_INDEX_CAPACITY = 1024 * 1024;
+
+        void Init(VkDevice device, VmaAllocator allocator, VkUploadQueue* uploadQueue, std::span<const std::uint32_t> queueFamilies,
+            std::uint32_t vertexCapacity = DEFAULT_VERTEX_CAPACITY, std::uint32_t indexCapacity = DEFAULT_INDEX_CAPACITY);
+        // Device has to be idle
+        void Destroy();
+
+        // Suballocates the mesh and queues the upload of its data, frame is the frame being recorded
+        MeshRange Allocate(std::span<const Vertex> vertices, std::span<const std::uint32_t> indices, std::uint32_t frame);
+        void Free(const MeshRange& range, std::uint32_t frame);
+        // Releases the ranges and buffers retired on or before completedFrame
+        void Update(std::uint32_t completedFrame);
+        // True when a buffer has plenty of free space but no single range holds a good share of it
+        [[nodiscard]] bool NeedsCompaction() const;
+        // Moves the meshes, which have to be every live mesh, to the start of new buffers and updates their ranges.
+        // Frames recorded before frame keep the old buffers, ranges freed but not released yet are dropped with them
+        void Compact(std::span<MeshRange* const> ranges, std::uint32_t frame);
+
+        [[nodiscard]] VkBuffer GetVertexBuffer() const { return m_VertexBuffer.Buffer; }
+        [[nodiscard]] VkBuffer GetIndexBuffer() const { return m_IndexBuffer.Buffer; }
+        [[nodiscard]] VkDeviceAddress GetVertexBufferAddress() const { return m_VertexBufferAddress; }
+
+        [[nodiscard]] const OffsetAllocator& GetVertexAllocator() const { return m_VertexAllocator; }
+        [[nodiscard]] const OffsetAllocator& GetIndexAllocator() const { return m_IndexAllocator; }
+    private:
+        struct PendingFree
+        {
+            MeshRange Range;
+            std::uint32_t Frame;
+        };
+
+        AllocatedBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+        // Doubles capacity until a range of the given size fits, the old buffer is retired at frame
+        void GrowVertexBuffer(std::uint32_t requiredCount, std::uint32_t frame);
+        void GrowIndexBuffer(std::uint32_t requiredCount, std::uint32_t frame);
+        void Reallocate(AllocatedBuffer& buffer, OffsetAllocator& allocator, std::uint32_t newCount, VkDeviceSize stride,
+            VkBufferUsageFlags usage, std::uint32_t frame);
+        void CompactBuffer(AllocatedBuffer& buffer, OffsetAllocator& allocator, std::span<OffsetAllocator::Allocation* const> allocations,
+            VkDeviceSize stride, VkBufferUsageFlags usage, std::uint32_t frame);
+        void UpdateVertexBufferAddress();
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VmaAllocator m_Allocator = VK_NULL_HANDLE;
+        VkUploadQueue* m_UploadQueue = nullptr;
+        std::vector<std::uint32_t> m_QueueFamilies;
+
+        AllocatedBuffer m_VertexBuffer{};
+        AllocatedBuffer m_IndexBuffer{};
+        VkDeviceAddress m_VertexBufferAddress = 0;
+
+        OffsetAllocator m_VertexAllocator;
+        OffsetAllocator m_IndexAllocator;
+
+        std::vector<PendingFree> m_PendingFrees; // in frame order
+        VkDeletionQueue m_RetiredBuffers{ 16 };
+    };
+}
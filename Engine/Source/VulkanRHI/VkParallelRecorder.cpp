@@ -0,0 +1,97 @@
+#include "VkParallelRecorder.h"
+#include "VkCommon.h"
+#include "VkInit.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace QE
+{
+    VkParallelRecorder::~VkParallelRecorder()
+    {
+        Destroy();
+    }
+
+    void VkParallelRecorder::Init(VkDevice device, std::uint32_t queueFamilyIndex, std::uint32_t slotCount)
+    {
+        m_Device = device;
+        m_Workers.Start(std::max(std::thread::hardware_concurrency(), 1u));
+
+        // Pools are only ever reset as a whole, buffers are not reset one by one
+        m_Pools.resize(slotCount);
+        for (std::vector<WorkerPool>& slotPools : m_Pools)
+        {
+            slotPools.resize(m_Workers.GetMaxWorkerCount());
+            for (WorkerPool& pool : slotPools)
+                pool.Pool = VkInit::CreateCommandPool(m_Device, queueFamilyIndex);
+        }
+    }
+
+    void VkParallelRecorder::Destroy()
+    {
+        m_Workers.Stop();
+
+        // Destroying a pool frees its buffers
+        for (std::vector<WorkerPool>& slotPools : m_Pools)
+        {
+            for (WorkerPool& pool : slotPools)
+                vkDestroyCommandPool(m_Device, pool.Pool, nullptr);
+        }
+        m_Pools.clear();
+    }
+
+    void VkParallelRecorder::ResetSlot(std::uint32_t slot)
+    {
+        for (WorkerPool& pool : m_Pools[slot])
+        {
+            if (pool.UsedBuffers == 0)
+                continue;
+
+            VK_CHECK(vkResetCommandPool(m_Device, pool.Pool, 0));
+            pool.UsedBuffers = 0;
+        }
+    }
+
+    std::span<const VkCommandBuffer> VkParallelRecorder::Record(std::uint32_t slot, std::uint32_t jobCount, const VkCommandBufferInheritanceRenderingInfo& rendering,
+        VkQueryPipelineStatisticFlags pipelineStatistics, const RecordFunction& record)
+    {
+        m_Recorded.assign(jobCount, VK_NULL_HANDLE);
+        if (jobCount == 0)
+            return m_Recorded;
+
+        // Dynamic rendering has no render pass, the attachment formats come from the rendering info
+        VkCommandBufferInheritanceInfo inheritance = {};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.pNext = &rendering;
+        inheritance.pipelineStatistics = pipelineStatistics;
+
+        std::vector<WorkerPool>& slotPools = m_Pools[slot];
+        m_Workers.Run(jobCount, [&](std::uint32_t worker, std::uint32_t job) {
+            VkCommandBuffer cmd = AcquireBuffer(slotPools[worker]);
+
+            VkCommandBufferBeginInfo beginInfo = VkInit::BuildCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+            beginInfo.pInheritanceInfo = &inheritance;
+            VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+            record(job, cmd);
+
+            VK_CHECK(vkEndCommandBuffer(cmd));
+            m_Recorded[job] = cmd;
+        });
+
+        return m_Recorded;
+    }
+
+    VkCommandBuffer VkParallelRecorder::AcquireBuffer(WorkerPool& pool)
+    {
+        if (pool.UsedBuffers == pool.Buffers.size())
+        {
+            VkCommandBufferAllocateInfo allocInfo = VkInit::BuildCommandBufferAllocateInfo(pool.Pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocInfo, &cmd));
+            pool.Buffers.push_back(cmd);
+        }
+
+        return pool.Buffers[pool.UsedBuffers++];
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core/WorkerThreads.h"
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace QE
+{
+    // Records the secondary command buffers of one rendering pass on several threads. Every worker owns a command
+    // pool per frame slot, so recording takes no locks and a slot's pools are reset together once the GPU is done
+    // with the slot. The jobs run on WorkerThreads, the calling thread is worker 0.
+    class VkParallelRecorder
+    {
+    public:
+        static constexpr std::uint32_t MAX_WORKERS = WorkerThreads::MAX_WORKERS;
+
+        // Records job into cmd, cmd is already begun and is ended afterwards
+        using RecordFunction = std::function<void(std::uint32_t job, VkCommandBuffer cmd)>;
+
+        VkParallelRecorder() = default;
+        ~VkParallelRecorder();
+
+        VkParallelRecorder(const VkParallelRecorder&) = delete;
+        VkParallelRecorder& operator=(const VkParallelRecorder&) = delete;
+
+        void Init(VkDevice device, std::uint32_t queueFamilyIndex, std::uint32_t slotCount);
+        // Device has to be idle
+        void Destroy();
+
+        // Recycles every buffer recorded for the slot, the GPU has to be done with it
+        void ResetSlot(std::uint32_t slot);
+
+        // Records jobCount secondary command buffers that continue a rendering pass with the given attachments,
+        // job j runs on worker j % worker count. Blocks until all are recorded and returns them in job order,
+        // they stay valid until the slot is reset. pipelineStatistics are the ones a query active around the
+        // pass may be counting
+        std::span<const VkCommandBuffer> Record(std::uint32_t slot, std::uint32_t jobCount, const VkCommandBufferInheritanceRenderingInfo& rendering,
+            VkQueryPipelineStatisticFlags pipelineStatistics, const RecordFunction& record);
+
+        [[nodiscard]] std::uint32_t GetWorkerCount() const { return m_Workers.GetWorkerCount(); }
+        // Limits the workers later passes use, clamped to the threads created at Init. Lets the scaling with
+        // core count be measured in one build, the idle threads keep sleeping
+        void SetActiveWorkers(std::uint32_t count) { m_Workers.SetActiveWorkers(count); }
+        [[nodiscard]] std::uint32_t GetMaxWorkerCount() const { return m_Workers.GetMaxWorkerCount(); }
+    private:
+        struct WorkerPool
+        {
+            VkCommandPool Pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> Buffers; // allocated on demand, reused once the pool is reset
+            std::uint32_t UsedBuffers = 0;
+        };
+
+        VkCommandBuffer AcquireBuffer(WorkerPool& pool);
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        WorkerThreads m_Workers;
+        std::vector<std::vector<WorkerPool>> m_Pools; // [slot][worker]
+        std::vector<VkCommandBuffer> m_Recorded; // of the current pass, every job writes its own entry
+    };
+}
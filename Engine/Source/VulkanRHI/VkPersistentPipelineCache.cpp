@@ -0,0 +1,155 @@
+#include "VkPersistentPipelineCache.h"
+#include "VkCommon.h"
+
+#include "Utility/Hash.h"
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+namespace QE
+{
+    namespace
+    {
+        std::uint64_t HashBlob(const std::vector<char>& data)
+        {
+            return Utils::djb2(std::string_view(data.data(), data.size()));
+        }
+    }
+
+    void VkPersistentPipelineCache::Init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path)
+    {
+        m_Device = device;
+        m_Path = path;
+
+        VkPhysicalDeviceVulkan11Properties properties11 = {};
+        properties11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &properties11;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+        m_DeviceHeader.Magic = FILE_MAGIC;
+        m_DeviceHeader.Version = FILE_VERSION;
+        m_DeviceHeader.VendorID = properties.properties.vendorID;
+        m_DeviceHeader.DeviceID = properties.properties.deviceID;
+        m_DeviceHeader.DriverVersion = properties.properties.driverVersion;
+        std::memcpy(m_DeviceHeader.DeviceUUID, properties11.deviceUUID, VK_UUID_SIZE);
+        std::memcpy(m_DeviceHeader.PipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        std::vector<char> data;
+        std::error_code error;
+        const std::uintmax_t fileSize = std::filesystem::file_size(m_Path, error);
+        std::ifstream file(m_Path, std::ios::binary);
+        if (!error && file.is_open())
+        {
+            FileHeader header{};
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+            if (!file || !IsCompatible(header))
+            {
+                LOG_INFO_TAG("VkPersistentPipelineCache", "Ignoring pipeline cache {}, it was written by another device or driver", m_Path.string());
+            }
+            else
+            {
+                // The size is checked against the file before allocating anything
+                if (header.DataSize == fileSize - sizeof(header))
+                {
+                    data.resize(header.DataSize);
+                    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                }
+
+                if (data.empty() || !file || HashBlob(data) != header.DataHash)
+                {
+                    LOG_WARN_TAG("VkPersistentPipelineCache", "Ignoring pipeline cache {}, the data is truncated or corrupt", m_Path.string());
+                    data.clear();
+                }
+                else
+                {
+                    m_SavedHash = header.DataHash;
+                    m_ColdBuildMs = header.ColdBuildMs;
+                }
+            }
+        }
+
+        // The driver still checks its own header inside the blob and treats a mismatch as an empty cache
+        VkPipelineCacheCreateInfo cacheInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+        VK_CHECK(vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache));
+
+        m_Warm = !data.empty();
+        LOG_DEBUG_TAG("VkPersistentPipelineCache", "Pipeline cache {}, loaded {} bytes from {}", m_Warm ? "warm" : "cold", data.size(), m_Path.string());
+    }
+
+    void VkPersistentPipelineCache::Destroy()
+    {
+        if (m_Cache == VK_NULL_HANDLE)
+            return;
+
+        Save();
+        vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+        m_Cache = VK_NULL_HANDLE;
+    }
+
+    void VkPersistentPipelineCache::Save()
+    {
+        std::size_t size = 0;
+        VK_CHECK(vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr));
+        std::vector<char> data(size);
+        VK_CHECK(vkGetPipelineCacheData(m_Device, m_Cache, &size, data.data()));
+        data.resize(size);
+
+        FileHeader header = m_DeviceHeader;
+        header.DataSize = data.size();
+        header.DataHash = HashBlob(data);
+        header.ColdBuildMs = m_ColdBuildMs;
+        if (header.DataHash == m_SavedHash)
+            return;
+
+        // Written next to the real file and renamed over it, a crash mid write must not leave a half blob behind
+        std::error_code error;
+        std::filesystem::create_directories(m_Path.parent_path(), error);
+
+        std::filesystem::path tempPath = m_Path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file)
+            {
+                LOG_WARN_TAG("VkPersistentPipelineCache", "Failed to write pipeline cache {}", tempPath.string());
+                return;
+            }
+        }
+
+        std::filesystem::rename(tempPath, m_Path, error);
+        if (error)
+        {
+            LOG_WARN_TAG("VkPersistentPipelineCache", "Failed to replace pipeline cache {}: {}", m_Path.string(), error.message());
+            return;
+        }
+
+        m_SavedHash = header.DataHash;
+        LOG_DEBUG_TAG("VkPersistentPipelineCache", "Saved {} bytes of pipeline cache to {}", data.size(), m_Path.string());
+    }
+
+    void VkPersistentPipelineCache::SetBuildTime(double milliseconds)
+    {
+        if (!m_Warm)
+            m_ColdBuildMs = milliseconds;
+    }
+
+    bool VkPersistentPipelineCache::IsCompatible(const FileHeader& header) const
+    {
+        return header.Magic == m_DeviceHeader.Magic
+            && header.Version == m_DeviceHeader.Version
+            && header.VendorID == m_DeviceHeader.VendorID
+            && header.DeviceID == m_DeviceHeader.DeviceID
+            && header.DriverVersion == m_DeviceHeader.DriverVersion
+            && std::memcmp(header.DeviceUUID, m_DeviceHeader.DeviceUUID, VK_UUID_SIZE) == 0
+            && std::memcmp(header.PipelineCacheUUID, m_DeviceHeader.PipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <filesystem>
+
+namespace QE
+{
+    // Pipeline cache that survives restarts. The driver's cache blob is written to disk behind our own header on
+    // shutdown and handed back to the driver on the next launch, so pipelines compiled once are only looked up
+    // afterwards. The blob is dropped when it was written by another device or driver version or when it fails
+    // its checksum, the cache then starts out empty.
+    class VkPersistentPipelineCache
+    {
+    public:
+        void Init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path);
+        // Saves first, pipelines created from the cache stay valid
+        void Destroy();
+
+        // Writes the current contents to disk, skipped when nothing changed since the last load or save
+        void Save();
+
+        [[nodiscard]] VkPipelineCache GetHandle() const { return m_Cache; }
+        // Whether a valid blob was found on disk, startup timings are only comparable between runs that agree on this
+        [[nodiscard]] bool IsWarm() const { return m_Warm; }
+        // Startup pipeline build time, saved with the blob when the cache was cold so warm runs can report both
+        void SetBuildTime(double milliseconds);
+        // Build time of the run that filled the cache, 0 when the cache is cold or the file predates it
+        [[nodiscard]] double GetColdBuildTime() const { return m_ColdBuildMs; }
+    private:
+        struct FileHeader
+        {
+            std::uint32_t Magic;
+            std::uint32_t Version;
+            std::uint32_t VendorID;
+            std::uint32_t DeviceID;
+            std::uint32_t DriverVersion;
+            std::uint8_t DeviceUUID[VK_UUID_SIZE];
+            std::uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+            std::uint64_t DataSize;
+            std::uint64_t DataHash;
+            double ColdBuildMs;
+        };
+
+        static constexpr std::uint32_t FILE_MAGIC = 0x43504551; // "QEPC"
+        static constexpr std::uint32_t FILE_VERSION = 2;
+
+        [[nodiscard]] bool IsCompatible(const FileHeader& header) const;
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VkPipelineCache m_Cache = VK_NULL_HANDLE;
+        std::filesystem::path m_Path;
+
+        FileHeader m_DeviceHeader{}; // identifies this device and driver, size and hash are filled in on save
+        std::uint64_t m_SavedHash = 0;
+        double m_ColdBuildMs = 0.0;
+        bool m_Warm = false;
+    };
+}
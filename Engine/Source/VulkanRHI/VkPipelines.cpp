@@ -70,7 +70,7 @@ namespace QE
 		ColorAttachmentFormat = VK_FORMAT_UNDEFINED;
 	}
 
-	VkPipeline PipelineBuilder::BuildPipeline(VkDevice device)
+	VkPipeline PipelineBuilder::BuildPipeline(VkDevice device, VkPipelineCache cache)
 	{
 		// make viewport state from our stored viewport and scissor.
 		// at the moment we wont support multiple viewports or scissors
@@ -125,7 +125,7 @@ namespace QE
 		// its easy to error out on create graphics pipeline, so we handle it a bit
 		// better than the common VK_CHECK case
 		VkPipeline newPipeline;
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo,
+		if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo,
 			nullptr, &newPipeline)
 			!= VK_SUCCESS)
 		{
@@ -23,7 +23,8 @@ namespace QE
 		PipelineBuilder();
 		void Clear();
 
-		VkPipeline BuildPipeline(VkDevice device);
+		// Safe to call from several threads at once with the same cache
+		VkPipeline BuildPipeline(VkDevice device, VkPipelineCache cache = VK_NULL_HANDLE);
 
 		void SetShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader);
 		void SetInputTopology(VkPrimitiveTopology topology);
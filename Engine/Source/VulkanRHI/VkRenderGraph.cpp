@@ -0,0 +1,354 @@
+#include "VkRenderGraph.h"
+#include "VkCommon.h"
+#include "VkInit.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace QE
+{
+    namespace
+    {
+        VkMemoryRequirements GetImageMemoryRequirements(VkDevice device, const RGImageDescription& description)
+        {
+            VkImageCreateInfo imageInfo = VkInit::BuildImageCreateInfo(description.Format, description.Usage, description.Extent);
+
+            VkDeviceImageMemoryRequirements requirementsInfo = {};
+            requirementsInfo.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+            requirementsInfo.pCreateInfo = &imageInfo;
+
+            VkMemoryRequirements2 requirements = {};
+            requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+            vkGetDeviceImageMemoryRequirements(device, &requirementsInfo, &requirements);
+            return requirements.memoryRequirements;
+        }
+    }
+
+    void VkRenderGraph::PassBuilder::Read(RGImage image, ResourceUsage usage)
+    {
+        m_Graph.AddAccess(m_Pass, image, usage, true, false);
+    }
+
+    void VkRenderGraph::PassBuilder::Write(RGImage image, ResourceUsage usage)
+    {
+        m_Graph.AddAccess(m_Pass, image, usage, true, true);
+    }
+
+    void VkRenderGraph::PassBuilder::Overwrite(RGImage image, ResourceUsage usage)
+    {
+        m_Graph.AddAccess(m_Pass, image, usage, false, true);
+    }
+
+    void VkRenderGraph::PassBuilder::SetSideEffect()
+    {
+        m_Graph.m_Passes[m_Pass].SideEffect = true;
+    }
+
+    void VkRenderGraph::Init(VkDevice device, VmaAllocator allocator, VkGpuProfiler* profiler)
+    {
+        m_Device = device;
+        m_Allocator = allocator;
+        m_Profiler = profiler;
+    }
+
+    void VkRenderGraph::Destroy()
+    {
+        for (const Placement& placement : m_Placements)
+        {
+            vkDestroyImageView(m_Device, placement.View, nullptr);
+            vkDestroyImage(m_Device, placement.Image, nullptr);
+        }
+        for (const MemoryBlock& block : m_Blocks)
+            vmaFreeMemory(m_Allocator, block.Allocation);
+
+        m_Placements.clear();
+        m_Blocks.clear();
+        Reset();
+    }
+
+    void VkRenderGraph::Reset()
+    {
+        m_Passes.clear();
+        m_Images.clear();
+    }
+
+    RGImage VkRenderGraph::ImportImage(const char* name, VkImage image, VkImageView view, VkImageAspectFlags aspect, ResourceState* state)
+    {
+        ImageResource& resource = m_Images.emplace_back();
+        resource.Name = name;
+        resource.Image = image;
+        resource.View = view;
+        resource.Aspect = aspect;
+        resource.ImportedState = state;
+        return { static_cast<std::uint32_t>(m_Images.size() - 1) };
+    }
+
+    RGImage VkRenderGraph::CreateImage(const char* name, const RGImageDescription& description)
+    {
+        ImageResource& resource = m_Images.emplace_back();
+        resource.Name = name;
+        resource.Aspect = description.Aspect;
+        resource.Description = description;
+        return { static_cast<std::uint32_t>(m_Images.size() - 1) };
+    }
+
+    void VkRenderGraph::AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute)
+    {
+        Pass& pass = m_Passes.emplace_back();
+        pass.Name = name;
+        pass.Execute = std::move(execute);
+
+        PassBuilder builder(*this, static_cast<std::uint32_t>(m_Passes.size() - 1));
+        setup(builder);
+    }
+
+    void VkRenderGraph::AddAccess(std::uint32_t pass, RGImage image, ResourceUsage usage, bool reads, bool writes)
+    {
+        QE_ASSERT(image.IsValid() && image.Index < m_Images.size());
+
+        // An image is in one layout for the whole pass, so a pass uses it in one way
+        for (ImageAccess& access : m_Passes[pass].Accesses)
+        {
+            if (access.Image != image.Index)
+                continue;
+
+            QE_ASSERT(access.Usage == usage);
+            access.Reads |= reads;
+            access.Writes |= writes;
+            return;
+        }
+
+        m_Passes[pass].Accesses.push_back({ image.Index, usage, reads, writes });
+    }
+
+    void VkRenderGraph::Execute(VkCommandBuffer cmd, VkDeletionQueue& deletionQueue, std::uint32_t frame)
+    {
+        m_Stats = {};
+        m_Stats.Passes = static_cast<std::uint32_t>(m_Passes.size());
+        m_Barriers.ResetStats();
+
+        CullPasses();
+        PlaceTransientImages(deletionQueue, frame);
+
+        for (ImageResource& image : m_Images)
+        {
+            if (image.ImportedState)
+                image.State = *image.ImportedState;
+        }
+
+        for (std::uint32_t passIndex = 0; passIndex < m_Passes.size(); passIndex++)
+        {
+            Pass& pass = m_Passes[passIndex];
+            if (pass.Culled)
+                continue;
+
+            // Transient images start out undefined, but the memory may still be in use by whoever had it before
+            for (const ImageAccess& access : pass.Accesses)
+            {
+                ImageResource& image = m_Images[access.Image];
+                if (!image.ImportedState && image.FirstPass == passIndex)
+                {
+                    const MemoryBlock& block = m_Blocks[m_Placements[image.Placement].Block];
+                    image.State = { VK_IMAGE_LAYOUT_UNDEFINED, block.LastUse.Stages, block.LastUse.Accesses };
+                }
+            }
+
+            // The zone covers the barriers too, waiting on earlier passes is part of what a pass costs
+            const std::uint32_t zone = m_Profiler ? m_Profiler->BeginZone(cmd, pass.Name) : 0;
+
+            // Everything the pass needs goes into one barrier call
+            for (const ImageAccess& access : pass.Accesses)
+            {
+                ImageResource& image = m_Images[access.Image];
+                const ResourceAccess resourceAccess = !access.Reads ? ResourceAccess::Overwrite
+                    : access.Writes ? ResourceAccess::ReadWrite : ResourceAccess::Read;
+                m_Barriers.Image(image.Image, image.Aspect, image.State, access.Usage, resourceAccess);
+            }
+            m_Barriers.Flush(cmd);
+
+            pass.Execute(cmd);
+
+            if (m_Profiler)
+                m_Profiler->EndZone(cmd, zone);
+
+            // The next image placed in the same memory has to wait for this one
+            for (const ImageAccess& access : pass.Accesses)
+            {
+                const ImageResource& image = m_Images[access.Image];
+                if (!image.ImportedState && image.LastPass == passIndex)
+                    m_Blocks[m_Placements[image.Placement].Block].LastUse = image.State;
+            }
+        }
+
+        for (const ImageResource& image : m_Images)
+        {
+            if (image.ImportedState)
+                *image.ImportedState = image.State;
+        }
+
+        const VkBarrierBatcher::Stats& barrierStats = m_Barriers.GetStats();
+        m_Stats.ImageBarriers = barrierStats.Barriers;
+        m_Stats.BarrierBatches = barrierStats.Flushes;
+        m_Stats.SkippedBarriers = barrierStats.Skipped;
+    }
+
+    void VkRenderGraph::CullPasses()
+    {
+        // Walk back from the end of the frame, where only imported images have contents anyone needs. A pass is
+        // kept when it writes contents that are needed, then the contents it reads are needed before it
+        std::vector<bool> needed(m_Images.size());
+        for (std::size_t i = 0; i < m_Images.size(); i++)
+            needed[i] = m_Images[i].ImportedState != nullptr;
+
+        for (std::size_t passIndex = m_Passes.size(); passIndex-- > 0;)
+        {
+            Pass& pass = m_Passes[passIndex];
+
+            bool keep = pass.SideEffect;
+            for (const ImageAccess& access : pass.Accesses)
+                keep |= access.Writes && needed[access.Image];
+
+            pass.Culled = !keep;
+            if (pass.Culled)
+            {
+                m_Stats.CulledPasses++;
+                continue;
+            }
+
+            for (const ImageAccess& access : pass.Accesses)
+            {
+                if (access.Writes && !access.Reads)
+                    needed[access.Image] = false;
+            }
+            for (const ImageAccess& access : pass.Accesses)
+            {
+                if (access.Reads)
+                    needed[access.Image] = true;
+            }
+        }
+    }
+
+    void VkRenderGraph::PlaceTransientImages(VkDeletionQueue& deletionQueue, std::uint32_t frame)
+    {
+        // Lifetimes over the passes that are recorded, transient images only used by culled passes get no memory
+        for (std::uint32_t passIndex = 0; passIndex < m_Passes.size(); passIndex++)
+        {
+            if (m_Passes[passIndex].Culled)
+                continue;
+
+            for (const ImageAccess& access : m_Passes[passIndex].Accesses)
+            {
+                ImageResource& image = m_Images[access.Image];
+                if (image.ImportedState)
+                    continue;
+
+                image.FirstPass = std::min(image.FirstPass, passIndex);
+                image.LastPass = std::max(image.LastPass, passIndex);
+            }
+        }
+
+        std::vector<std::uint32_t> order;
+        for (std::uint32_t i = 0; i < m_Images.size(); i++)
+        {
+            if (!m_Images[i].ImportedState && m_Images[i].FirstPass != UINT32_MAX)
+                order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return m_Images[a].FirstPass < m_Images[b].FirstPass;
+        });
+
+        // Greedy, in order of first use every image goes into the first block that is free by then and has a
+        // compatible memory type, the block grows to fit it
+        std::vector<MemoryBlock> blocks;
+        std::vector<Placement> placements;
+        VkDeviceSize imageMemory = 0;
+        for (std::uint32_t imageIndex : order)
+        {
+            ImageResource& image = m_Images[imageIndex];
+            const VkMemoryRequirements requirements = GetImageMemoryRequirements(m_Device, image.Description);
+            imageMemory += requirements.size;
+
+            auto block = std::find_if(blocks.begin(), blocks.end(), [&](const MemoryBlock& candidate) {
+                return candidate.AvailableAfter < image.FirstPass && (candidate.Requirements.memoryTypeBits & requirements.memoryTypeBits) != 0;
+            });
+            if (block == blocks.end())
+            {
+                block = blocks.insert(blocks.end(), MemoryBlock{});
+                block->Requirements = requirements;
+            }
+            else
+            {
+                block->Requirements.size = std::max(block->Requirements.size, requirements.size);
+                block->Requirements.alignment = std::max(block->Requirements.alignment, requirements.alignment);
+                block->Requirements.memoryTypeBits &= requirements.memoryTypeBits;
+            }
+            block->AvailableAfter = image.LastPass;
+
+            image.Placement = static_cast<std::uint32_t>(placements.size());
+            placements.push_back({ image.Description, static_cast<std::uint32_t>(block - blocks.begin()) });
+        }
+
+        // Frames usually look the same, the images and memory of the last one are kept while the placement holds
+        const bool samePlacement = std::equal(placements.begin(), placements.end(), m_Placements.begin(), m_Placements.end(),
+            [](const Placement& a, const Placement& b) { return a.Description == b.Description && a.Block == b.Block; });
+        if (!samePlacement)
+        {
+            RetireTransientMemory(deletionQueue, frame);
+            m_Blocks = std::move(blocks);
+            m_Placements = std::move(placements);
+            CreateTransientMemory();
+        }
+
+        // Handles are looked up after the placement may have been recreated
+        for (ImageResource& image : m_Images)
+        {
+            if (image.Placement == UINT32_MAX)
+                continue;
+
+            image.Image = m_Placements[image.Placement].Image;
+            image.View = m_Placements[image.Placement].View;
+        }
+
+        m_Stats.TransientImages = static_cast<std::uint32_t>(m_Placements.size());
+        m_Stats.TransientMemory = std::accumulate(m_Blocks.begin(), m_Blocks.end(), VkDeviceSize{ 0 },
+            [](VkDeviceSize total, const MemoryBlock& block) { return total + block.Requirements.size; });
+        m_Stats.AliasedMemory = imageMemory - m_Stats.TransientMemory;
+    }
+
+    void VkRenderGraph::RetireTransientMemory(VkDeletionQueue& deletionQueue, std::uint32_t frame)
+    {
+        // Frames in flight may still render into them, memory goes after the images bound to it
+        for (const Placement& placement : m_Placements)
+        {
+            deletionQueue.Push(placement.View, frame);
+            deletionQueue.Push(placement.Image, VK_NULL_HANDLE, frame);
+        }
+        for (const MemoryBlock& block : m_Blocks)
+            deletionQueue.Push(block.Allocation, frame);
+
+        m_Placements.clear();
+        m_Blocks.clear();
+    }
+
+    void VkRenderGraph::CreateTransientMemory()
+    {
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        allocInfo.requiredFlags = static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        for (MemoryBlock& block : m_Blocks)
+            VK_CHECK(vmaAllocateMemory(m_Allocator, &block.Requirements, &allocInfo, &block.Allocation, nullptr));
+
+        for (Placement& placement : m_Placements)
+        {
+            VkImageCreateInfo imageInfo = VkInit::BuildImageCreateInfo(placement.Description.Format, placement.Description.Usage, placement.Description.Extent);
+            VK_CHECK(vkCreateImage(m_Device, &imageInfo, nullptr, &placement.Image));
+            VK_CHECK(vmaBindImageMemory(m_Allocator, m_Blocks[placement.Block].Allocation, placement.Image));
+
+            VkImageViewCreateInfo viewInfo = VkInit::BuildImageViewCreateInfo(placement.Description.Format, placement.Image, placement.Description.Aspect);
+            VK_CHECK(vkCreateImageView(m_Device, &viewInfo, nullptr, &placement.View));
+        }
+
+        LOG_DEBUG_TAG("VkRenderGraph", "Placed {} transient images in {} memory blocks", m_Placements.size(), m_Blocks.size());
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "RHI/ResourceTypes.h"
+#include "VkBarrierBatcher.h"
+#include "VkDeletionQueue.h"
+#include "VkGpuProfiler.h"
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace QE
+{
+    struct RGImageDescription
+    {
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        VkExtent3D Extent = {};
+        VkImageUsageFlags Usage = 0;
+        VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+        bool operator==(const RGImageDescription& other) const
+        {
+            return Format == other.Format && Extent.width == other.Extent.width && Extent.height == other.Extent.height
+                && Extent.depth == other.Extent.depth && Usage == other.Usage && Aspect == other.Aspect;
+        }
+    };
+
+    struct RGImage
+    {
+        std::uint32_t Index = UINT32_MAX;
+
+        [[nodiscard]] bool IsValid() const { return Index != UINT32_MAX; }
+    };
+
+    // Frame graph rebuilt every frame. Passes declare how they use images, the graph then drops passes whose
+    // results nobody uses, records the rest in order with the image barriers each one needs batched in front of
+    // it, and places transient images so the ones that are never alive at the same time share memory.
+    // Imported images are owned outside and their contents are kept, transient ones only live for the frame.
+    class VkRenderGraph
+    {
+    public:
+        class PassBuilder
+        {
+        public:
+            // Uses the contents left by earlier passes
+            void Read(RGImage image, ResourceUsage usage);
+            // Reads and writes, the contents are kept (attachments that load)
+            void Write(RGImage image, ResourceUsage usage);
+            // Writes without reading, earlier contents are discarded (attachments that clear, full copies)
+            void Overwrite(RGImage image, ResourceUsage usage);
+            // The pass has effects outside the graph and is never culled
+            void SetSideEffect();
+        private:
+            friend class VkRenderGraph;
+            PassBuilder(VkRenderGraph& graph, std::uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+            VkRenderGraph& m_Graph;
+            std::uint32_t m_Pass;
+        };
+
+        using SetupFunction = std::function<void(PassBuilder& builder)>;
+        using ExecuteFunction = std::function<void(VkCommandBuffer cmd)>;
+
+        // Every pass is a zone on the profiler, when there is one
+        void Init(VkDevice device, VmaAllocator allocator, VkGpuProfiler* profiler = nullptr);
+        // Device has to be idle
+        void Destroy();
+
+        // Forgets the passes and images of the last frame, the memory of transient images is kept for the next one
+        void Reset();
+
+        // state is read when the graph first uses the image and is left where the last pass left the image
+        RGImage ImportImage(const char* name, VkImage image, VkImageView view, VkImageAspectFlags aspect, ResourceState* state);
+        RGImage CreateImage(const char* name, const RGImageDescription& description);
+
+        // setup runs right away, execute when the graph is executed
+        void AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute);
+
+        // Transient memory that is no longer needed is retired into deletionQueue at frame
+        void Execute(VkCommandBuffer cmd, VkDeletionQueue& deletionQueue, std::uint32_t frame);
+
+        // Transient images only have a handle while the graph executes
+        [[nodiscard]] VkImage GetImage(RGImage image) const { return m_Images[image.Index].Image; }
+        [[nodiscard]] VkImageView GetImageView(RGImage image) const { return m_Images[image.Index].View; }
+
+        [[nodiscard]] const RenderGraphStats& GetStats() const { return m_Stats; }
+    private:
+        struct ImageAccess
+        {
+            std::uint32_t Image;
+            ResourceUsage Usage;
+            bool Reads;
+            bool Writes;
+        };
+
+        struct Pass
+        {
+            std::string Name;
+            ExecuteFunction Execute;
+            std::vector<ImageAccess> Accesses;
+            bool SideEffect = false;
+            bool Culled = false;
+        };
+
+        struct ImageResource
+        {
+            std::string Name;
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+            VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            ResourceState* ImportedState = nullptr; // null for transient images
+            ResourceState State;
+
+            // Transient only
+            RGImageDescription Description;
+            std::uint32_t FirstPass = UINT32_MAX; // of the passes that are not culled
+            std::uint32_t LastPass = 0;
+            std::uint32_t Placement = UINT32_MAX; // in m_Placements
+        };
+
+        // Memory shared by transient images with disjoint lifetimes, kept across frames while the placement holds
+        struct MemoryBlock
+        {
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            VkMemoryRequirements Requirements = {};
+            std::uint32_t AvailableAfter = 0; // last pass of the image placed in it last, while placing
+            ResourceState LastUse; // stages and accesses of the image that used it last, layouts do not carry over
+        };
+
+        struct Placement
+        {
+            RGImageDescription Description;
+            std::uint32_t Block;
+            VkImage Image = VK_NULL_HANDLE;
+            VkImageView View = VK_NULL_HANDLE;
+        };
+
+        void AddAccess(std::uint32_t pass, RGImage image, ResourceUsage usage, bool reads, bool writes);
+        void CullPasses();
+        void PlaceTransientImages(VkDeletionQueue& deletionQueue, std::uint32_t frame);
+        void RetireTransientMemory(VkDeletionQueue& deletionQueue, std::uint32_t frame);
+        void CreateTransientMemory();
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VmaAllocator m_Allocator = VK_NULL_HANDLE;
+        VkGpuProfiler* m_Profiler = nullptr;
+
+        std::vector<Pass> m_Passes;
+        std::vector<ImageResource> m_Images;
+        std::vector<MemoryBlock> m_Blocks;
+        std::vector<Placement> m_Placements; // in order of first use
+        VkBarrierBatcher m_Barriers;
+        RenderGraphStats m_Stats;
+    };
+}
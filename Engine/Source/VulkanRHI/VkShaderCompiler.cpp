@@ -0,0 +1,246 @@
+#include "VkShaderCompiler.h"
+#include "VkCommon.h"
+#include "VkInit.h"
+
+#include "Utility/Hash.h"
+
+#include <shaderc/shaderc.hpp>
+#if __has_include(<glslang/build_info.h>)
+#include <glslang/build_info.h>
+#endif
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace QE
+{
+    namespace
+    {
+        // Bump when the options below change in a way the key does not capture
+        constexpr std::uint32_t CACHE_VERSION = 1;
+
+        // shaderc has no version query of its own, glslang does the GLSL to SPIR-V work and ships a version header
+        // with the SDK. Builds against an SDK without it still key on the SDK's header version
+#if defined(GLSLANG_VERSION_MAJOR)
+        constexpr std::uint32_t GLSLANG_VERSION = GLSLANG_VERSION_MAJOR * 1000000 + GLSLANG_VERSION_MINOR * 1000 + GLSLANG_VERSION_PATCH;
+#else
+        constexpr std::uint32_t GLSLANG_VERSION = 0;
+#endif
+
+        bool ReadTextFile(const std::filesystem::path& path, std::string& text)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open())
+                return false;
+
+            std::stringstream stream;
+            stream << file.rdbuf();
+            text = stream.str();
+            return true;
+        }
+
+        bool GetShaderKind(const std::filesystem::path& path, shaderc_shader_kind& kind, std::string& stageName)
+        {
+            const std::string extension = path.extension().string();
+            if (extension == ".vert")
+                kind = shaderc_vertex_shader;
+            else if (extension == ".frag")
+                kind = shaderc_fragment_shader;
+            else if (extension == ".comp")
+                kind = shaderc_compute_shader;
+            else if (extension == ".geom")
+                kind = shaderc_geometry_shader;
+            else if (extension == ".tesc")
+                kind = shaderc_tess_control_shader;
+            else if (extension == ".tese")
+                kind = shaderc_tess_evaluation_shader;
+            else
+                return false;
+
+            stageName = extension.substr(1);
+            return true;
+        }
+
+        // Resolves #include "file" next to the including file and #include <file> from the source folder
+        class FileIncluder : public shaderc::CompileOptions::IncluderInterface
+        {
+        public:
+            explicit FileIncluder(std::filesystem::path sourceFolder) : m_SourceFolder(std::move(sourceFolder)) {}
+
+            shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t) override
+            {
+                auto* include = new Include();
+
+                const std::filesystem::path folder = type == shaderc_include_type_relative
+                    ? std::filesystem::path(requestingSource).parent_path() : m_SourceFolder;
+                const std::filesystem::path path = folder / requestedSource;
+
+                if (ReadTextFile(path, include->Content))
+                {
+                    include->Name = path.string();
+                }
+                else
+                {
+                    // An empty name tells shaderc the include failed, the content is the error message
+                    include->Content = std::format("Cannot open include file {}", path.string());
+                }
+
+                include->Result.source_name = include->Name.data();
+                include->Result.source_name_length = include->Name.size();
+                include->Result.content = include->Content.data();
+                include->Result.content_length = include->Content.size();
+                include->Result.user_data = include;
+                return &include->Result;
+            }
+
+            void ReleaseInclude(shaderc_include_result* data) override
+            {
+                delete static_cast<Include*>(data->user_data);
+            }
+        private:
+            struct Include
+            {
+                shaderc_include_result Result{};
+                std::string Name;
+                std::string Content;
+            };
+
+            std::filesystem::path m_SourceFolder;
+        };
+    }
+
+    VkShaderCompiler::VkShaderCompiler() = default;
+    VkShaderCompiler::~VkShaderCompiler() = default;
+
+    void VkShaderCompiler::Init(const std::filesystem::path& sourceFolder, const std::filesystem::path& cacheFolder)
+    {
+        m_Compiler = std::make_unique<shaderc::Compiler>();
+        m_SourceFolder = sourceFolder;
+        m_CacheFolder = cacheFolder;
+
+        std::error_code error;
+        std::filesystem::create_directories(m_CacheFolder, error);
+        if (error)
+            LOG_WARN_TAG("VkShaderCompiler", "Cannot create shader cache folder {}: {}", m_CacheFolder.string(), error.message());
+    }
+
+    std::vector<std::uint32_t> VkShaderCompiler::Compile(const std::string& name, std::span<const ShaderDefine> defines)
+    {
+        const std::filesystem::path sourcePath = m_SourceFolder / name;
+
+        shaderc_shader_kind kind;
+        std::string stageName;
+        if (!GetShaderKind(sourcePath, kind, stageName))
+        {
+            LOG_ERROR_TAG("VkShaderCompiler", "Cannot tell the shader stage of {} from its extension", name);
+            m_Failures++;
+            return {};
+        }
+
+        std::string source;
+        if (!ReadTextFile(sourcePath, source))
+        {
+            LOG_ERROR_TAG("VkShaderCompiler", "Cannot open shader source {}", sourcePath.string());
+            m_Failures++;
+            return {};
+        }
+
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        options.SetIncluder(std::make_unique<FileIncluder>(m_SourceFolder));
+#ifdef QE_DEBUG_MODE
+        options.SetGenerateDebugInfo();
+        options.SetOptimizationLevel(shaderc_optimization_level_zero);
+        constexpr std::string_view optionsKey = "vulkan1.3 debug";
+#else
+        options.SetOptimizationLevel(shaderc_optimization_level_performance);
+        constexpr std::string_view optionsKey = "vulkan1.3 performance";
+#endif
+        for (const ShaderDefine& define : defines)
+            options.AddMacroDefinition(define.Name, define.Value);
+
+        // Preprocessing pulls in the includes and applies the defines, so its output covers every input to the compile
+        shaderc::PreprocessedSourceCompilationResult preprocessed = m_Compiler->PreprocessGlsl(source, kind, sourcePath.string().c_str(), options);
+        if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            LOG_ERROR_TAG("VkShaderCompiler", "Failed to preprocess {}:\n{}", name, preprocessed.GetErrorMessage());
+            m_Failures++;
+            return {};
+        }
+
+        std::uint32_t spirvVersion = 0;
+        std::uint32_t spirvRevision = 0;
+        shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+
+        std::string key(preprocessed.cbegin(), preprocessed.cend());
+        key += std::format("\n{} {} {} {} {} {}", CACHE_VERSION, VK_HEADER_VERSION_COMPLETE, GLSLANG_VERSION, spirvVersion, spirvRevision, optionsKey);
+
+        const std::string stem = sourcePath.stem().string();
+        const std::filesystem::path cachePath = m_CacheFolder / std::format("{}-{}-{:016x}.spv", stem, stageName, Utils::djb2(key));
+
+        // Cache hit
+        std::string cached;
+        if (ReadTextFile(cachePath, cached) && !cached.empty() && cached.size() % sizeof(std::uint32_t) == 0)
+        {
+            std::vector<std::uint32_t> spirv(cached.size() / sizeof(std::uint32_t));
+            std::memcpy(spirv.data(), cached.data(), cached.size());
+            m_CacheHits++;
+            return spirv;
+        }
+
+        shaderc::SpvCompilationResult result = m_Compiler->CompileGlslToSpv(source, kind, sourcePath.string().c_str(), options);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            LOG_ERROR_TAG("VkShaderCompiler", "Failed to compile {}:\n{}", name, result.GetErrorMessage());
+            m_Failures++;
+            return {};
+        }
+
+        if (result.GetNumWarnings() > 0)
+            LOG_WARN_TAG("VkShaderCompiler", "{} compiled with warnings:\n{}", name, result.GetErrorMessage());
+
+        std::vector<std::uint32_t> spirv(result.cbegin(), result.cend());
+        m_Compiles++;
+        LOG_DEBUG_TAG("VkShaderCompiler", "Compiled {} to {}", name, cachePath.filename().string());
+
+        // Several threads may compile the same shader, each writes its own file and the rename settles it
+        std::filesystem::path tempPath = cachePath;
+        tempPath += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(std::uint32_t)));
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error)
+        {
+            LOG_WARN_TAG("VkShaderCompiler", "Cannot write shader cache {}: {}", cachePath.string(), error.message());
+            std::filesystem::remove(tempPath, error);
+        }
+
+        return spirv;
+    }
+
+    VkShaderModule VkShaderCompiler::CreateShaderModule(VkDevice device, const std::string& name, std::span<const ShaderDefine> defines)
+    {
+        std::vector<std::uint32_t> spirv = Compile(name, defines);
+        if (!spirv.empty())
+            return VkInit::CreateShaderModule(device, spirv);
+
+        shaderc_shader_kind kind;
+        std::string stageName;
+        if (!GetShaderKind(name, kind, stageName))
+            throw std::runtime_error("Failed to create shader module");
+
+        // Prebuilt shaders follow the CompileShaders.bat naming, mesh.vert is mesh-vert.spv
+        const std::string prebuiltName = std::filesystem::path(name).stem().string() + "-" + stageName + ".spv";
+        LOG_WARN_TAG("VkShaderCompiler", "Using prebuilt {} instead of {}", prebuiltName, name);
+        return VkInit::CreateShaderModule(device, std::string_view(prebuiltName));
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace shaderc
+{
+    class Compiler;
+}
+
+namespace QE
+{
+    struct ShaderDefine
+    {
+        std::string Name;
+        std::string Value;
+    };
+
+    // Compiles GLSL from the shader source folder at runtime. Each result is cached on disk under a hash of the
+    // preprocessed source, so edits to included files count, together with the defines, the compile options and the
+    // compiler version. A cache hit only costs the preprocessing and a file read. Compiling is thread safe, shaders
+    // used by pipelines that are built in parallel compile in parallel.
+    class VkShaderCompiler
+    {
+    public:
+        struct Stats
+        {
+            std::uint32_t CacheHits = 0;
+            std::uint32_t Compiles = 0;
+            std::uint32_t Failures = 0;
+        };
+
+        VkShaderCompiler();
+        ~VkShaderCompiler();
+
+        void Init(const std::filesystem::path& sourceFolder, const std::filesystem::path& cacheFolder);
+
+        // name is the file name in the source folder, the stage comes from its extension.
+        // Returns an empty vector when the shader does not compile, the errors are logged
+        std::vector<std::uint32_t> Compile(const std::string& name, std::span<const ShaderDefine> defines = {});
+
+        // Falls back to the prebuilt <name>-<stage>.spv in the ShaderCache folder when compiling fails
+        VkShaderModule CreateShaderModule(VkDevice device, const std::string& name, std::span<const ShaderDefine> defines = {});
+
+        [[nodiscard]] Stats GetStats() const { return { m_CacheHits.load(), m_Compiles.load(), m_Failures.load() }; }
+    private:
+        std::unique_ptr<shaderc::Compiler> m_Compiler;
+        std::filesystem::path m_SourceFolder;
+        std::filesystem::path m_CacheFolder;
+
+        std::atomic<std::uint32_t> m_CacheHits = 0;
+        std::atomic<std::uint32_t> m_Compiles = 0;
+        std::atomic<std::uint32_t> m_Failures = 0;
+    };
+}
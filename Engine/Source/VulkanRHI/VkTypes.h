@@ -27,15 +27,53 @@ namespace QE
 
 	struct GPUMeshBuffer
 	{
-		BufferHandle VertexBuffer;
-		BufferHandle IndexBuffer;
-		VkDeviceAddress VertexBufferAddress;
+		// Range in the mesh arena, in vertices and indices
+		uint32_t VertexOffset;
+		uint32_t VertexCount;
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		glm::vec4 BoundingSphere; // local space center and radius, used for culling
 	};
 
-	struct GPUDrawPushConstants
+	// GPU-driven drawing, layouts match cull.comp and mesh_indirect.vert
+	struct GPUInstanceData
 	{
-		ModelViewProjection MVP;
-		VkDeviceAddress MeshBufferAddress;
+		glm::mat4 Transform;
+		// Filled in when the draw list is flushed
+		uint32_t DrawIndex;
+		uint32_t TextureIndex; // slot in the bindless texture table
+		uint32_t Padding[2];
+	};
+	static_assert(sizeof(GPUInstanceData) == 80, "GPUInstanceData has to match the std430 layout in the shaders");
+
+	// One per run of sorted records with the same mesh, becomes one instanced indirect command. Textures are bindless,
+	// each instance carries its own TextureIndex so they never split a draw
+	struct GPUDrawData
+	{
+		glm::vec4 BoundingSphere;
+		uint32_t FirstIndex;
+		int32_t VertexOffset;
+		uint32_t IndexCount;
+		uint32_t FirstVisible; // first slot of the draw in the visible instance list
+	};
+	static_assert(sizeof(GPUDrawData) == 32, "GPUDrawData has to match the std430 layout in the shaders");
+
+	// Per frame uniform, the culling pass reads it through its device address
+	struct GPUSceneData
+	{
+		glm::mat4 ViewProjection;
+		glm::vec4 FrustumPlanes[6];
+		VkDeviceAddress InstanceBuffer;
+		VkDeviceAddress DrawBuffer;
+		VkDeviceAddress DrawCommandBuffer;
+		VkDeviceAddress VisibleInstanceBuffer;
+		VkDeviceAddress VertexBuffer; // mesh arena
+	};
+
+	struct GPUCullPushConstants
+	{
+		VkDeviceAddress SceneData;
+		uint32_t InstanceCount;
 	};
 
 	struct AllocatedImage 
@@ -46,5 +84,11 @@ namespace QE
 		VkExtent3D ImageExtent;
 		VkFormat ImageFormat;
 	};
+
+	struct GPUTexture
+	{
+		AllocatedImage Image;
+		uint32_t BindlessIndex;
+	};
 	
 }
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "VkUploadQueue.h"
+#include "VkCommon.h"
+#include "VkInit.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace QE
+{
+    void VkUploadQueue::Init(VkDevice device, VmaAllocator allocator, VkQueue queue, std::uint32_t queueFamily, std::size_t stagingSize)
+    {
+        m_Device = device;
+        m_Allocator = allocator;
+        m_Queue = queue;
+
+        m_CommandPool = VkInit::CreateCommandPool(m_Device, queueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        m_TimelineSemaphore = VkInit::CreateTimelineSemaphore(m_Device, 0);
+
+        VkBufferCreateInfo bufferInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size = stagingSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo allocationInfo = {};
+        VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &m_StagingBuffer, &m_StagingAllocation, &allocationInfo));
+
+        m_StagingMapped = static_cast<std::uint8_t*>(allocationInfo.pMappedData);
+        m_StagingCapacity = stagingSize;
+        m_StagingHead = 0;
+        m_StagingTail = 0;
+
+        LOG_DEBUG_TAG("VkUploadQueue", "Created upload queue with a {} MiB staging ring", stagingSize / (1024 * 1024));
+    }
+
+    void VkUploadQueue::Destroy()
+    {
+        // Nothing is in use anymore, retire everything so the dedicated staging buffers are released
+        if (m_Recording.CommandBuffer != VK_NULL_HANDLE)
+            vkEndCommandBuffer(m_Recording.CommandBuffer);
+        RetireBatch(m_Recording);
+        for (Batch& batch : m_InFlight)
+            RetireBatch(batch);
+        m_InFlight.clear();
+        m_FreeCommandBuffers.clear();
+
+        vmaDestroyBuffer(m_Allocator, m_StagingBuffer, m_StagingAllocation);
+        vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+        vkDestroySemaphore(m_Device, m_TimelineSemaphore, nullptr);
+
+        m_StagingBuffer = VK_NULL_HANDLE;
+        m_StagingAllocation = VK_NULL_HANDLE;
+        m_StagingMapped = nullptr;
+        m_CommandPool = VK_NULL_HANDLE;
+        m_TimelineSemaphore = VK_NULL_HANDLE;
+    }
+
+    UploadToken VkUploadQueue::UploadBuffer(VkBuffer destination, ByteView data, VkDeviceSize destinationOffset)
+    {
+        if (data.Empty())
+            return GetLastSubmitted();
+
+        // Allocate before grabbing the command buffer, making room in the ring can submit the current batch
+        StagingAllocation staging = AllocateStaging(data.Size());
+        std::memcpy(staging.Mapped, data.Data(), data.Size());
+        FlushStaging(staging, data.Size());
+
+        VkBufferCopy copy = {};
+        copy.srcOffset = staging.Offset;
+        copy.dstOffset = destinationOffset;
+        copy.size = data.Size();
+        vkCmdCopyBuffer(GetRecordingCommandBuffer(), staging.Buffer, destination, 1, &copy);
+
+        return { m_LastSubmittedValue + 1 };
+    }
+
+    UploadToken VkUploadQueue::UploadImage(VkImage destination, VkExtent3D extent, ByteView data)
+    {
+        if (data.Empty())
+            return GetLastSubmitted();
+
+        StagingAllocation staging = AllocateStaging(data.Size());
+        std::memcpy(staging.Mapped, data.Data(), data.Size());
+        FlushStaging(staging, data.Size());
+
+        // Begins the batch's command buffer so Submit picks the copy up
+        GetRecordingCommandBuffer();
+        m_Recording.ImageCopies.push_back({ destination, extent, staging, {} });
+
+        return { m_LastSubmittedValue + 1 };
+    }
+
+    UploadToken VkUploadQueue::CopyBuffer(VkBuffer source, VkBuffer destination, VkDeviceSize size)
+    {
+        if (size == 0)
+            return GetLastSubmitted();
+
+        VkBufferCopy copy = {};
+        copy.srcOffset = 0;
+        copy.dstOffset = 0;
+        copy.size = size;
+        return CopyBufferRegions(source, destination, { &copy, 1 });
+    }
+
+    UploadToken VkUploadQueue::CopyBufferRegions(VkBuffer source, VkBuffer destination, std::span<const VkBufferCopy> regions)
+    {
+        if (regions.empty())
+            return GetLastSubmitted();
+
+        // Barriers also cover the batches submitted earlier on this queue
+        VkCommandBuffer cmd = GetRecordingCommandBuffer();
+        VkInit::GlobalBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+        vkCmdCopyBuffer(cmd, source, destination, static_cast<std::uint32_t>(regions.size()), regions.data());
+
+        VkInit::GlobalBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+        return { m_LastSubmittedValue + 1 };
+    }
+
+    UploadToken VkUploadQueue::Submit()
+    {
+        if (m_Recording.CommandBuffer == VK_NULL_HANDLE)
+            return GetLastSubmitted();
+
+        RecordImageCopies();
+        VK_CHECK(vkEndCommandBuffer(m_Recording.CommandBuffer));
+
+        m_Recording.TimelineValue = ++m_LastSubmittedValue;
+        m_Recording.StagingEnd = m_StagingHead;
+
+        VkCommandBufferSubmitInfo cmdSubmitInfo = VkInit::BuildCommandBufferSubmitInfo(m_Recording.CommandBuffer);
+        VkSemaphoreSubmitInfo signalInfo = VkInit::BuildSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_TimelineSemaphore);
+        signalInfo.value = m_Recording.TimelineValue;
+
+        VkSubmitInfo2 submitInfo = VkInit::BuildSubmitInfo2(&cmdSubmitInfo, &signalInfo, nullptr);
+        VK_CHECK(vkQueueSubmit2(m_Queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+        m_InFlight.push_back(std::move(m_Recording));
+        m_Recording = {};
+
+        return GetLastSubmitted();
+    }
+
+    void VkUploadQueue::Update()
+    {
+        if (m_InFlight.empty())
+            return;
+
+        std::uint64_t completedValue = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_TimelineSemaphore, &completedValue));
+
+        while (!m_InFlight.empty() && m_InFlight.front().TimelineValue <= completedValue)
+        {
+            RetireBatch(m_InFlight.front());
+            m_InFlight.pop_front();
+        }
+    }
+
+    bool VkUploadQueue::IsComplete(UploadToken token) const
+    {
+        if (token.Value > m_LastSubmittedValue)
+            return false;
+
+        std::uint64_t completedValue = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_TimelineSemaphore, &completedValue));
+        return completedValue >= token.Value;
+    }
+
+    void VkUploadQueue::Wait(UploadToken token)
+    {
+        if (token.Value > m_LastSubmittedValue)
+            Submit();
+
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_TimelineSemaphore;
+        waitInfo.pValues = &token.Value;
+        VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX));
+
+        Update();
+    }
+
+    VkUploadQueue::StagingAllocation VkUploadQueue::AllocateStaging(std::size_t size)
+    {
+        if (size > m_StagingCapacity)
+        {
+            LOG_WARN_TAG("VkUploadQueue", "Upload of {} bytes is bigger than the staging ring, using a dedicated staging buffer", size);
+            return AllocateDedicatedStaging(size);
+        }
+
+        StagingAllocation allocation;
+        while (!TryAllocateFromRing(size, allocation))
+        {
+            Update();
+            if (TryAllocateFromRing(size, allocation))
+                break;
+
+            // The ring is full of copies nobody has submitted yet, send them off so the space can come back
+            if (m_InFlight.empty())
+                Submit();
+
+            if (!m_InFlight.empty())
+                Wait({ m_InFlight.front().TimelineValue });
+        }
+
+        return allocation;
+    }
+
+    bool VkUploadQueue::TryAllocateFromRing(std::size_t size, StagingAllocation& allocation)
+    {
+        // Empty ring, restart at a wrap boundary so any size up to the capacity fits
+        if (m_StagingHead == m_StagingTail)
+        {
+            m_StagingHead = (m_StagingHead + m_StagingCapacity - 1) / m_StagingCapacity * m_StagingCapacity;
+            m_StagingTail = m_StagingHead;
+        }
+
+        std::uint64_t start = (m_StagingHead + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+        // A copy source has to be contiguous, skip the rest of the ring instead of wrapping around it
+        if (start % m_StagingCapacity + size > m_StagingCapacity)
+            start = (start / m_StagingCapacity + 1) * m_StagingCapacity;
+
+        if (start + size - m_StagingTail > m_StagingCapacity)
+            return false;
+
+        m_StagingHead = start + size;
+
+        const VkDeviceSize offset = start % m_StagingCapacity;
+        allocation = { m_StagingBuffer, offset, m_StagingMapped + offset };
+        return true;
+    }
+
+    VkUploadQueue::StagingAllocation VkUploadQueue::AllocateDedicatedStaging(std::size_t size)
+    {
+        VkBufferCreateInfo bufferInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size = size;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VmaAllocationInfo allocationInfo = {};
+        VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &buffer, &allocation, &allocationInfo));
+
+        m_Recording.DedicatedStaging.emplace_back(buffer, allocation);
+        return { buffer, 0, allocationInfo.pMappedData };
+    }
+
+    void VkUploadQueue::FlushStaging(const StagingAllocation& allocation, std::size_t size)
+    {
+        // No-op on host coherent memory
+        VmaAllocation vmaAllocation = allocation.Buffer == m_StagingBuffer ? m_StagingAllocation : m_Recording.DedicatedStaging.back().second;
+        VK_CHECK(vmaFlushAllocation(m_Allocator, vmaAllocation, allocation.Offset, size));
+    }
+
+    VkCommandBuffer VkUploadQueue::GetRecordingCommandBuffer()
+    {
+        if (m_Recording.CommandBuffer != VK_NULL_HANDLE)
+            return m_Recording.CommandBuffer;
+
+        if (!m_FreeCommandBuffers.empty())
+        {
+            m_Recording.CommandBuffer = m_FreeCommandBuffers.back();
+            m_FreeCommandBuffers.pop_back();
+        }
+        else
+        {
+            m_Recording.CommandBuffer = VkInit::CreateCommandBuffer(m_Device, m_CommandPool);
+        }
+
+        VkCommandBufferBeginInfo beginInfo = VkInit::BuildCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        VK_CHECK(vkBeginCommandBuffer(m_Recording.CommandBuffer, &beginInfo));
+
+        return m_Recording.CommandBuffer;
+    }
+
+    void VkUploadQueue::RecordImageCopies()
+    {
+        if (m_Recording.ImageCopies.empty())
+            return;
+
+        VkCommandBuffer cmd = m_Recording.CommandBuffer;
+
+        // Nothing in this batch touched the images yet, their old contents are discarded
+        for (ImageCopy& copy : m_Recording.ImageCopies)
+            m_Barriers.Image(copy.Image, VK_IMAGE_ASPECT_COLOR_BIT, copy.State, ResourceUsage::CopyDst, ResourceAccess::Overwrite);
+        m_Barriers.Flush(cmd);
+
+        for (const ImageCopy& copy : m_Recording.ImageCopies)
+        {
+            VkBufferImageCopy copyRegion = {};
+            copyRegion.bufferOffset = copy.Staging.Offset;
+            copyRegion.bufferRowLength = 0;
+            copyRegion.bufferImageHeight = 0;
+
+            copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copyRegion.imageSubresource.mipLevel = 0;
+            copyRegion.imageSubresource.baseArrayLayer = 0;
+            copyRegion.imageSubresource.layerCount = 1;
+            copyRegion.imageExtent = copy.Extent;
+
+            vkCmdCopyBufferToImage(cmd, copy.Staging.Buffer, copy.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+        }
+
+        // The graphics queue samples them after waiting on the timeline value this batch signals
+        for (ImageCopy& copy : m_Recording.ImageCopies)
+            m_Barriers.HandOffImage(copy.Image, VK_IMAGE_ASPECT_COLOR_BIT, copy.State, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        m_Barriers.Flush(cmd);
+
+        m_Recording.ImageCopies.clear();
+    }
+
+    void VkUploadQueue::RetireBatch(Batch& batch)
+    {
+        for (auto& [buffer, allocation] : batch.DedicatedStaging)
+            vmaDestroyBuffer(m_Allocator, buffer, allocation);
+        batch.DedicatedStaging.clear();
+
+        if (batch.CommandBuffer != VK_NULL_HANDLE)
+        {
+            VK_CHECK(vkResetCommandBuffer(batch.CommandBuffer, 0));
+            m_FreeCommandBuffers.push_back(batch.CommandBuffer);
+            batch.CommandBuffer = VK_NULL_HANDLE;
+        }
+
+        m_StagingTail = std::max(m_StagingTail, batch.StagingEnd);
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Core/Containers/ByteBuffer.h"
+#include "VkBarrierBatcher.h"
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace QE
+{
+    // Value the upload queue's timeline semaphore reaches once an upload has landed
+    struct UploadToken
+    {
+        std::uint64_t Value = 0;
+    };
+
+    // Streams data to the GPU without stalling the caller. Data is copied into a persistently mapped staging
+    // ring and the copy commands are batched until Submit, which is called once per frame. Each submitted batch
+    // signals the next value of a timeline semaphore, the graphics queue waits on it before using the resources
+    // and the staging memory is recycled once the value is reached. Uploads bigger than the ring get their own
+    // staging buffer that lives until the batch completes.
+    class VkUploadQueue
+    {
+    public:
+        static constexpr std::size_t DEFAULT_STAGING_SIZE = 64ull * 1024 * 1024;
+        static constexpr VkDeviceSize STAGING_ALIGNMENT = 16; // covers the texel size and copy offset rules for the formats we use
+
+        void Init(VkDevice device, VmaAllocator allocator, VkQueue queue, std::uint32_t queueFamily, std::size_t stagingSize = DEFAULT_STAGING_SIZE);
+        // Device has to be idle
+        void Destroy();
+
+        UploadToken UploadBuffer(VkBuffer destination, ByteView data, VkDeviceSize destinationOffset = 0);
+        // Copies into mip 0 and leaves the whole image in SHADER_READ_ONLY_OPTIMAL. Image copies are recorded at
+        // Submit, so the transitions of all images in a batch share two barrier calls
+        UploadToken UploadImage(VkImage destination, VkExtent3D extent, ByteView data);
+        // GPU side copy ordered after every upload recorded before it and before every upload recorded after it,
+        // used to move the contents of a buffer that is being reallocated
+        UploadToken CopyBuffer(VkBuffer source, VkBuffer destination, VkDeviceSize size);
+        // Same ordering as CopyBuffer for several ranges at once, used when the contents are packed while being moved
+        UploadToken CopyBufferRegions(VkBuffer source, VkBuffer destination, std::span<const VkBufferCopy> regions);
+
+        // Submits everything recorded since the last call, returns the token that covers all uploads so far
+        UploadToken Submit();
+        // Recycles the staging memory and command buffers of completed batches
+        void Update();
+
+        [[nodiscard]] bool IsComplete(UploadToken token) const;
+        // Submits first if the token belongs to the batch still being recorded
+        void Wait(UploadToken token);
+
+        [[nodiscard]] VkSemaphore GetTimelineSemaphore() const { return m_TimelineSemaphore; }
+        [[nodiscard]] UploadToken GetLastSubmitted() const { return { m_LastSubmittedValue }; }
+    private:
+        struct StagingAllocation
+        {
+            VkBuffer Buffer;
+            VkDeviceSize Offset;
+            void* Mapped;
+        };
+
+        struct ImageCopy
+        {
+            VkImage Image;
+            VkExtent3D Extent;
+            StagingAllocation Staging;
+            ResourceState State;
+        };
+
+        struct Batch
+        {
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            std::uint64_t TimelineValue = 0;
+            std::uint64_t StagingEnd = 0; // ring head when the batch was submitted
+            std::vector<std::pair<VkBuffer, VmaAllocation>> DedicatedStaging;
+            std::vector<ImageCopy> ImageCopies; // recorded at Submit
+        };
+
+        StagingAllocation AllocateStaging(std::size_t size);
+        bool TryAllocateFromRing(std::size_t size, StagingAllocation& allocation);
+        StagingAllocation AllocateDedicatedStaging(std::size_t size);
+        void FlushStaging(const StagingAllocation& allocation, std::size_t size);
+        VkCommandBuffer GetRecordingCommandBuffer();
+        void RecordImageCopies();
+        void RetireBatch(Batch& batch);
+
+        VkDevice m_Device = VK_NULL_HANDLE;
+        VmaAllocator m_Allocator = VK_NULL_HANDLE;
+        VkQueue m_Queue = VK_NULL_HANDLE;
+
+        VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> m_FreeCommandBuffers;
+
+        VkSemaphore m_TimelineSemaphore = VK_NULL_HANDLE;
+        std::uint64_t m_LastSubmittedValue = 0;
+
+        // Staging ring, head and tail only grow and are wrapped by the capacity when used as offsets
+        VkBuffer m_StagingBuffer = VK_NULL_HANDLE;
+        VmaAllocation m_StagingAllocation = VK_NULL_HANDLE;
+        std::uint8_t* m_StagingMapped = nullptr;
+        std::uint64_t m_StagingCapacity = 0;
+        std::uint64_t m_StagingHead = 0;
+        std::uint64_t m_StagingTail = 0;
+
+        Batch m_Recording;
+        VkBarrierBatcher m_Barriers;
+        std::deque<Batch> m_InFlight; // oldest first
+    };
+}
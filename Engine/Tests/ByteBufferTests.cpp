@@ -0,0 +1,132 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/TLSFAllocator.h"
+#include "Core/Containers/ByteBuffer.h"
+
+#include <array>
+#include <memory_resource>
+#include <utility>
+
+namespace QE
+{
+    namespace
+    {
+        // Remembers what is still allocated from it, so a test can check everything came back
+        class CountingResource : public std::pmr::memory_resource
+        {
+        public:
+            std::size_t LiveAllocations = 0;
+            std::size_t LiveBytes = 0;
+        protected:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                LiveAllocations++;
+                LiveBytes += bytes;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+            {
+                LiveAllocations--;
+                LiveBytes -= bytes;
+                std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+        };
+    }
+
+    QE_TEST(ByteBuffer, Move)
+    {
+        ByteBuffer first(64);
+        QE_REQUIRE(first);
+        first.Data()[0] = 42;
+        const std::uint8_t* data = first.Data();
+
+        // The bytes change owner, nothing is copied
+        ByteBuffer second(std::move(first));
+        QE_CHECK(second.Data() == data && second.Size() == 64 && second.Data()[0] == 42);
+        QE_CHECK(!first && first.Empty());
+
+        // Assigning over a buffer releases what it held
+        ByteBuffer third(16);
+        third = std::move(second);
+        QE_CHECK(third.Data() == data && third.Size() == 64);
+        QE_CHECK(!second);
+
+        third = std::move(third);
+        QE_CHECK(third.Data() == data);
+    }
+
+    QE_TEST(ByteBuffer, Release)
+    {
+        ByteBuffer buffer(128);
+        buffer.Release();
+        QE_CHECK(!buffer && buffer.Size() == 0);
+        // Releasing twice, or an empty buffer, does nothing
+        buffer.Release();
+        ByteBuffer empty(0);
+        QE_CHECK(!empty && empty.View().Empty());
+    }
+
+    QE_TEST(ByteBuffer, AllocatorRoundTrip)
+    {
+        alignas(16) static std::byte memory[64 * 1024];
+        TLSFAllocator allocator(sizeof(memory), memory);
+        {
+            ByteBuffer buffer(1000, &allocator);
+            QE_REQUIRE(buffer);
+            QE_CHECK(reinterpret_cast<std::uintptr_t>(buffer.Data()) % ByteBuffer::ALIGNMENT == 0);
+            QE_CHECK(allocator.GetNumberOfAllocations() == 1);
+
+            // The allocator moves with the bytes, the moved to buffer frees them
+            ByteBuffer moved(std::move(buffer));
+            QE_CHECK(allocator.GetNumberOfAllocations() == 1);
+
+            const std::array<std::uint8_t, 4> source = { 1, 2, 3, 4 };
+            ByteBuffer copy = ByteBuffer::Copy(ByteView(std::span(source)), &allocator);
+            QE_CHECK(copy.Size() == 4 && copy.Data()[3] == 4);
+            QE_CHECK(allocator.GetNumberOfAllocations() == 2);
+        }
+        // The small copy sits in this thread's cache until it is flushed
+        allocator.FlushThreadCaches();
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+        QE_CHECK(allocator.GetUsedSize() == 0);
+    }
+
+    QE_TEST(ByteBuffer, MemoryResourceRoundTrip)
+    {
+        CountingResource resource;
+        {
+            ByteBuffer buffer(300, &resource);
+            QE_CHECK(resource.LiveAllocations == 1 && resource.LiveBytes == 300);
+
+            ByteBuffer other(100, &resource);
+            other = std::move(buffer);
+            QE_CHECK(resource.LiveAllocations == 1 && resource.LiveBytes == 300);
+        }
+        // Handed back with the size it was allocated with
+        QE_CHECK(resource.LiveAllocations == 0 && resource.LiveBytes == 0);
+    }
+
+    QE_TEST(ByteBuffer, AllocatorOutOfMemory)
+    {
+        alignas(16) static std::byte memory[4096];
+        TLSFAllocator allocator(sizeof(memory), memory);
+
+        bool threw = false;
+        try
+        {
+            ByteBuffer buffer(1024 * 1024, &allocator);
+        }
+        catch (const std::bad_alloc&)
+        {
+            threw = true;
+        }
+        QE_CHECK(threw);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+    }
+}
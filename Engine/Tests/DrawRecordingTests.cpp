@@ -0,0 +1,200 @@
+#include "TestFramework.h"
+
+#include "Core/WorkerThreads.h"
+#include "RHI/DrawChunks.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace QE
+{
+    namespace
+    {
+        // Same layout as GPUInstanceData and GPUDrawData
+        struct InstanceData
+        {
+            float Transform[16];
+            std::uint32_t DrawIndex;
+            std::uint32_t TextureIndex;
+            std::uint32_t Padding[2];
+        };
+
+        struct DrawData
+        {
+            float BoundingSphere[4];
+            std::uint32_t FirstIndex;
+            std::int32_t VertexOffset;
+            std::uint32_t IndexCount;
+            std::uint32_t FirstVisible;
+        };
+
+        struct Record
+        {
+            std::uint32_t Mesh;
+            std::uint32_t Texture;
+            std::uint32_t FirstInstance;
+            std::uint32_t InstanceCount;
+        };
+
+        // Sorted keys over recordCount records, meshCount meshes in runs of consecutive keys
+        void BuildDrawList(std::uint32_t recordCount, std::uint32_t instancesPerRecord, std::uint32_t meshCount, std::vector<Record>& records, std::vector<DrawKey>& keys)
+        {
+            records.resize(recordCount);
+            keys.resize(recordCount);
+            for (std::uint32_t i = 0; i < recordCount; i++)
+            {
+                const std::uint32_t mesh = static_cast<std::uint32_t>(std::uint64_t(i) * meshCount / recordCount);
+                records[i] = { mesh, i % 16, i * instancesPerRecord, instancesPerRecord };
+                keys[i] = { mesh, i, instancesPerRecord };
+            }
+        }
+
+        // CPU side of VkGraphicsDevice::RecordDrawChunk without the pools or the command buffer: records of the same
+        // mesh merge into one draw, every instance gets its draw and texture index
+        void WriteChunk(DrawChunk& chunk, const std::vector<DrawKey>& keys, const std::vector<Record>& records, std::vector<InstanceData>& instances, std::vector<DrawData>& draws)
+        {
+            DrawData* chunkDraws = draws.data() + chunk.FirstKey;
+            std::uint32_t drawCount = 0;
+            std::uint32_t drawnInstances = 0;
+            std::uint32_t visibleCount = chunk.FirstVisible;
+            std::uint32_t drawMesh = 0;
+
+            for (std::uint32_t i = chunk.FirstKey; i < chunk.FirstKey + chunk.KeyCount; i++)
+            {
+                const Record& record = records[keys[i].RecordIndex];
+                if (drawCount == 0 || record.Mesh != drawMesh)
+                {
+                    DrawData& draw = chunkDraws[drawCount++];
+                    draw.FirstIndex = record.Mesh * 36;
+                    draw.VertexOffset = static_cast<std::int32_t>(record.Mesh * 24);
+                    draw.IndexCount = 36;
+                    draw.FirstVisible = visibleCount;
+                    drawMesh = record.Mesh;
+                }
+
+                const std::uint32_t drawIndex = chunk.FirstKey + drawCount - 1;
+                for (std::uint32_t j = 0; j < record.InstanceCount; j++)
+                {
+                    instances[record.FirstInstance + j].DrawIndex = drawIndex;
+                    instances[record.FirstInstance + j].TextureIndex = record.Texture;
+                }
+
+                visibleCount += record.InstanceCount;
+                drawnInstances += record.InstanceCount;
+            }
+
+            chunk.DrawCount = drawCount;
+            chunk.DrawnInstances = drawnInstances;
+        }
+    }
+
+    QE_TEST(DrawChunks, CoverEveryKey)
+    {
+        std::vector<Record> records;
+        std::vector<DrawKey> keys;
+        BuildDrawList(1000, 10, 64, records, keys);
+        std::pmr::vector<DrawChunk> chunks;
+
+        // About one chunk per worker, every key in exactly one chunk and the visible ranges back to back
+        SplitDrawChunks(keys, 10000, 4, chunks);
+        QE_CHECK(chunks.size() == 4);
+        std::uint32_t nextKey = 0;
+        std::uint32_t nextVisible = 0;
+        for (const DrawChunk& chunk : chunks)
+        {
+            QE_CHECK(chunk.FirstKey == nextKey);
+            QE_CHECK(chunk.FirstVisible == nextVisible);
+            nextKey += chunk.KeyCount;
+            nextVisible += chunk.KeyCount * 10;
+        }
+        QE_CHECK(nextKey == 1000);
+
+        // Small frames stay in one chunk whatever the worker count
+        SplitDrawChunks(keys, 10000, 8, chunks);
+        QE_CHECK(chunks.size() == 5);
+        SplitDrawChunks(std::span(keys).first(100), 1000, 8, chunks);
+        QE_CHECK(chunks.size() == 1 && chunks[0].KeyCount == 100);
+
+        SplitDrawChunks({}, 0, 8, chunks);
+        QE_CHECK(chunks.empty());
+    }
+
+    QE_TEST(DrawChunks, ThreadsWriteEveryInstance)
+    {
+        std::vector<Record> records;
+        std::vector<DrawKey> keys;
+        BuildDrawList(4000, 3, 64, records, keys);
+        std::vector<InstanceData> instances(12000);
+        std::vector<DrawData> draws(keys.size());
+        std::pmr::vector<DrawChunk> chunks;
+
+        WorkerThreads workers;
+        workers.Start(4);
+        SplitDrawChunks(keys, 12000, workers.GetWorkerCount(), chunks);
+        QE_REQUIRE(chunks.size() > 1);
+        workers.Run(static_cast<std::uint32_t>(chunks.size()), [&](std::uint32_t, std::uint32_t job) {
+            WriteChunk(chunks[job], keys, records, instances, draws);
+        });
+
+        // A mesh cut by a chunk border is drawn twice, nothing else adds draws
+        std::uint32_t drawCount = 0;
+        std::uint32_t drawnInstances = 0;
+        for (const DrawChunk& chunk : chunks)
+        {
+            drawCount += chunk.DrawCount;
+            drawnInstances += chunk.DrawnInstances;
+        }
+        QE_CHECK(drawnInstances == 12000);
+        QE_CHECK(drawCount >= 64 && drawCount < 64 + chunks.size());
+
+        for (const Record& record : records)
+        {
+            const InstanceData& instance = instances[record.FirstInstance];
+            QE_CHECK(instance.TextureIndex == record.Texture);
+            QE_CHECK(draws[instance.DrawIndex].FirstIndex == record.Mesh * 36);
+        }
+    }
+
+    QE_BENCHMARK(DrawRecording, ThreadScaling)
+    {
+        // The CPU side of recording the draw list: the engine's split and worker threads with the writes of
+        // RecordDrawChunk, without a device. Ten times the Sandbox's largest stress grid, once with a packet per
+        // copy and once with 1000 instances per draw
+        for (const std::uint32_t instancesPerRecord : { 1u, 1000u })
+        {
+            constexpr std::uint32_t INSTANCE_COUNT = 100 * 100 * 10;
+            const std::uint32_t recordCount = INSTANCE_COUNT / instancesPerRecord;
+
+            std::vector<Record> records;
+            std::vector<DrawKey> keys;
+            BuildDrawList(recordCount, instancesPerRecord, 64, records, keys);
+            std::vector<InstanceData> instances(INSTANCE_COUNT);
+            std::vector<DrawData> draws(recordCount);
+            std::pmr::vector<DrawChunk> chunks;
+
+            WorkerThreads workers;
+            workers.Start(WorkerThreads::MAX_WORKERS);
+
+            double singleThreadNs = 0.0;
+            for (const std::uint32_t workerCount : { 1u, 2u, 4u, 8u })
+            {
+                workers.SetActiveWorkers(workerCount);
+                const double ns = Tests::MeasureNanoseconds(200, [&]() {
+                    SplitDrawChunks(keys, INSTANCE_COUNT, workers.GetWorkerCount(), chunks);
+                    workers.Run(static_cast<std::uint32_t>(chunks.size()), [&](std::uint32_t, std::uint32_t job) {
+                        WriteChunk(chunks[job], keys, records, instances, draws);
+                    });
+                });
+                Tests::DoNotOptimize(instances.data());
+                if (workerCount == 1)
+                    singleThreadNs = ns;
+
+                LOG_INFO_TAG("Benchmark", "{} instances in {} records, {} chunks on {} workers: {:.1f} us per frame, {:.2f}x one worker ({} hardware threads)",
+                    INSTANCE_COUNT, recordCount, chunks.size(), workers.GetWorkerCount(), ns / 1000.0, singleThreadNs / ns, std::thread::hardware_concurrency());
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#include "TestFramework.h"
+
+#include "Core/Events/EngineEvents.h"
+#include "Core/Events/EventManager.h"
+
+#include <vector>
+
+namespace QE
+{
+    QE_TEST(EventManager, QueueKeepsOrderPastFirstPage)
+    {
+        EventManager events;
+        std::vector<float> fired;
+        events.Subscribe(EventType::MouseMoved, [&fired](const EventBase& event) {
+            fired.push_back(static_cast<const MouseMoveEvent&>(event).MouseX);
+        });
+
+        // More events than the first page holds, none of them may fire before Flush
+        constexpr std::size_t EVENT_COUNT = EventManager::EVENT_QUEUE_SIZE / EventManager::EVENT_BLOCK_SIZE + 100;
+        for (std::size_t i = 0; i < EVENT_COUNT; i++)
+        {
+            MouseMoveEvent event;
+            event.MouseX = static_cast<float>(i);
+            event.MouseY = 0.0f;
+            events.QueueEvent(event);
+        }
+        QE_CHECK(fired.empty());
+        QE_CHECK(events.GetEventAllocator().GetNumberOfAllocations() == EVENT_COUNT);
+        QE_CHECK(events.GetEventAllocator().GetPageCount() == 2);
+
+        events.Flush();
+        QE_REQUIRE(fired.size() == EVENT_COUNT);
+        for (std::size_t i = 0; i < EVENT_COUNT; i++)
+            QE_CHECK(fired[i] == static_cast<float>(i));
+        QE_CHECK(events.GetEventAllocator().GetUsedSize() == 0);
+    }
+
+    QE_TEST(EventManager, EventsQueuedWhileFlushing)
+    {
+        EventManager events;
+        std::vector<EventType> fired;
+        events.Subscribe(EventType::WindowMouseToggle, [&](const EventBase& event) {
+            fired.push_back(event.GetEventType());
+            events.QueueEvent(WindowCloseEvent{});
+        });
+        events.Subscribe(EventType::WindowClose, [&fired](const EventBase& event) { fired.push_back(event.GetEventType()); });
+
+        events.QueueEvent(WindowMouseToggleEvent{});
+        events.QueueEvent(WindowResizeEvent{});
+        events.Flush();
+
+        // Fired after the events that were already waiting
+        QE_REQUIRE(fired.size() == 2);
+        QE_CHECK(fired[0] == EventType::WindowMouseToggle);
+        QE_CHECK(fired[1] == EventType::WindowClose);
+        QE_CHECK(events.GetEventAllocator().GetNumberOfAllocations() == 0);
+    }
+}
@@ -0,0 +1,149 @@
+#include "TestFramework.h"
+
+#include "Core/Containers/HandlePool.h"
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace QE
+{
+    namespace
+    {
+        struct TestHandle
+        {
+            std::uint32_t Index = HandlePool<int, TestHandle>::INVALID_INDEX;
+            std::uint32_t Generation = 0;
+        };
+    }
+
+    QE_TEST(HandlePool, InsertAndGet)
+    {
+        HandlePool<int, TestHandle> pool;
+        const TestHandle first = pool.Insert(1);
+        const TestHandle second = pool.Insert(2);
+
+        QE_REQUIRE(pool.Get(first) && pool.Get(second));
+        QE_CHECK(*pool.Get(first) == 1);
+        QE_CHECK(*pool.Get(second) == 2);
+        QE_CHECK(pool.GetSize() == 2);
+        // Default constructed handles are never valid
+        QE_CHECK(pool.Get(TestHandle{}) == nullptr);
+    }
+
+    QE_TEST(HandlePool, StaleHandles)
+    {
+        HandlePool<int, TestHandle> pool;
+        const TestHandle removed = pool.Insert(1);
+        QE_CHECK(pool.Remove(removed));
+        QE_CHECK(!pool.Remove(removed));
+
+        // The slot is reused with a new generation, the old handle doesn't alias the new object
+        const TestHandle reused = pool.Insert(2);
+        QE_CHECK(reused.Index == removed.Index);
+        QE_CHECK(reused.Generation != removed.Generation);
+        QE_CHECK(pool.Get(removed) == nullptr);
+        QE_CHECK(*pool.Get(reused) == 2);
+
+        pool.Clear();
+        QE_CHECK(pool.Get(reused) == nullptr);
+        QE_CHECK(pool.IsEmpty());
+    }
+
+    QE_TEST(HandlePool, StaysPacked)
+    {
+        HandlePool<int, TestHandle> pool;
+        std::vector<TestHandle> handles;
+        for (int i = 0; i < 8; i++)
+            handles.push_back(pool.Insert(i));
+
+        pool.Remove(handles[0]);
+        pool.Remove(handles[3]);
+
+        // The last objects moved into the holes, their handles still find them
+        QE_CHECK(pool.GetObjects().size() == 6);
+        for (int i : { 1, 2, 4, 5, 6, 7 })
+            QE_CHECK(pool.Get(handles[i]) && *pool.Get(handles[i]) == i);
+    }
+
+    // Lookup cost per draw: the old device did a hash lookup for the vertex buffer, index buffer and texture of every
+    // draw and copied the structs out, the pools return pointers after two array reads
+    namespace
+    {
+        // About the size of an AllocatedBuffer
+        struct Resource
+        {
+            std::array<std::uint64_t, 8> Data;
+        };
+
+        struct Draw
+        {
+            TestHandle VertexBuffer;
+            TestHandle IndexBuffer;
+            TestHandle Texture;
+            std::uint32_t VertexBufferID;
+            std::uint32_t IndexBufferID;
+            std::uint32_t TextureID;
+        };
+    }
+
+    QE_BENCHMARK(HandlePool, LookupPerDraw)
+    {
+        constexpr std::uint32_t RESOURCE_COUNT = 4096;
+        constexpr std::uint32_t DRAW_COUNT = 10000;
+
+        HandlePool<Resource, TestHandle> pool(RESOURCE_COUNT);
+        std::unordered_map<std::uint32_t, Resource> map;
+        std::vector<TestHandle> handles;
+        for (std::uint32_t i = 0; i < RESOURCE_COUNT; i++)
+        {
+            const Resource resource{ { i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7 } };
+            handles.push_back(pool.Insert(resource));
+            map.emplace(i, resource);
+        }
+
+        // Scattered like a sorted draw list referencing many meshes and textures
+        std::vector<Draw> draws(DRAW_COUNT);
+        std::uint32_t state = 12345;
+        auto next = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return (state >> 8) % RESOURCE_COUNT;
+        };
+        for (Draw& draw : draws)
+        {
+            draw.VertexBufferID = next();
+            draw.IndexBufferID = next();
+            draw.TextureID = next();
+            draw.VertexBuffer = handles[draw.VertexBufferID];
+            draw.IndexBuffer = handles[draw.IndexBufferID];
+            draw.Texture = handles[draw.TextureID];
+        }
+
+        std::uint64_t sum = 0;
+        const double poolNs = Tests::MeasureNanoseconds(200, [&]() {
+            for (const Draw& draw : draws)
+            {
+                const Resource* vertexBuffer = pool.Get(draw.VertexBuffer);
+                const Resource* indexBuffer = pool.Get(draw.IndexBuffer);
+                const Resource* texture = pool.Get(draw.Texture);
+                if (vertexBuffer && indexBuffer && texture)
+                    sum += vertexBuffer->Data[0] + indexBuffer->Data[1] + texture->Data[2];
+            }
+            Tests::DoNotOptimize(&sum);
+        }) / DRAW_COUNT;
+
+        const double mapNs = Tests::MeasureNanoseconds(200, [&]() {
+            for (const Draw& draw : draws)
+            {
+                const Resource vertexBuffer = map.at(draw.VertexBufferID);
+                const Resource indexBuffer = map.at(draw.IndexBufferID);
+                const Resource texture = map.at(draw.TextureID);
+                sum += vertexBuffer.Data[0] + indexBuffer.Data[1] + texture.Data[2];
+            }
+            Tests::DoNotOptimize(&sum);
+        }) / DRAW_COUNT;
+
+        LOG_INFO_TAG("Benchmark", "{} draws over {} resources, ns per draw for three lookups: HandlePool {:.1f}, unordered_map by value {:.1f}",
+            DRAW_COUNT, RESOURCE_COUNT, poolNs, mapNs);
+    }
+}
@@ -0,0 +1,172 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/AllocatorUtility.h"
+#include "Core/Allocators/FrameAllocator.h"
+#include "Core/Allocators/LinearAllocator.h"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace QE
+{
+    namespace
+    {
+        bool IsAligned(const void* ptr, std::size_t alignment)
+        {
+            return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+        }
+    }
+
+    QE_TEST(AllocatorUtility, AlignForwardAdjustment)
+    {
+        alignas(64) std::byte buffer[128];
+
+        for (std::size_t alignment = 1; alignment <= 64; alignment *= 2)
+        {
+            for (std::size_t offset = 0; offset < 64; offset++)
+            {
+                const std::size_t adjustment = align_forward_adjustment(buffer + offset, alignment);
+                QE_CHECK(adjustment < alignment);
+                QE_CHECK(IsAligned(buffer + offset + adjustment, alignment));
+            }
+        }
+
+        // Already aligned addresses stay put
+        QE_CHECK(align_forward_adjustment(buffer, 64) == 0);
+        QE_CHECK(align_forward_adjustment(buffer + 16, 16) == 0);
+        QE_CHECK(is_power_of_two(1) && is_power_of_two(64) && !is_power_of_two(0) && !is_power_of_two(48));
+    }
+
+    QE_TEST(LinearAllocator, Alignment)
+    {
+        alignas(256) std::byte buffer[4096];
+        LinearAllocator allocator(sizeof(buffer), buffer);
+
+        // Odd sizes leave the pointer misaligned for the next allocation
+        for (std::size_t alignment = 1; alignment <= 256; alignment *= 2)
+        {
+            void* ptr = allocator.Allocate(3, alignment);
+            QE_REQUIRE(ptr != nullptr);
+            QE_CHECK(IsAligned(ptr, alignment));
+        }
+
+        QE_CHECK(allocator.GetNumberOfAllocations() == 9);
+        // Padding counts as used
+        QE_CHECK(allocator.GetUsedSize() == ptr_diff(buffer, allocator.GetCurrentPointer()));
+    }
+
+    QE_TEST(LinearAllocator, OutOfMemory)
+    {
+        alignas(16) std::byte buffer[64];
+        LinearAllocator allocator(sizeof(buffer), buffer);
+
+        QE_CHECK(allocator.Allocate(48, 16) != nullptr);
+        QE_CHECK(allocator.Allocate(32, 16) == nullptr);
+        // The failed allocation leaves the allocator as it was
+        QE_CHECK(allocator.GetUsedSize() == 48);
+        QE_CHECK(allocator.Allocate(16, 16) != nullptr);
+        QE_CHECK(allocator.GetFreeSize() == 0);
+    }
+
+    QE_TEST(LinearAllocator, RewindAndClear)
+    {
+        alignas(16) std::byte buffer[1024];
+        LinearAllocator allocator(sizeof(buffer), buffer);
+
+        void* first = allocator.Allocate(100, 16);
+        void* mark = allocator.GetCurrentPointer();
+        const std::size_t usedAtMark = allocator.GetUsedSize();
+
+        void* second = allocator.Allocate(200, 16);
+        QE_CHECK(second != nullptr && second != first);
+
+        allocator.Rewind(mark);
+        QE_CHECK(allocator.GetUsedSize() == usedAtMark);
+        // Memory after the mark is handed out again
+        QE_CHECK(allocator.Allocate(200, 16) == second);
+
+        allocator.Clear();
+        QE_CHECK(allocator.GetUsedSize() == 0);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+        QE_CHECK(allocator.Allocate(100, 16) == first);
+    }
+
+    QE_TEST(FrameAllocator, KeepsLastFrame)
+    {
+        FrameAllocator allocator(1024);
+
+        allocator.BeginFrame();
+        int* lastFrame = allocator.New<int>(42);
+        QE_REQUIRE(lastFrame != nullptr);
+        const std::uint32_t lastBuffer = allocator.GetCurrentBufferIndex();
+
+        // One frame later the value is still there and new allocations come from the other buffer
+        allocator.BeginFrame();
+        QE_CHECK(allocator.GetCurrentBufferIndex() != lastBuffer);
+        int* thisFrame = allocator.New<int>(7);
+        QE_CHECK(*lastFrame == 42);
+        QE_CHECK(thisFrame != lastFrame);
+
+        // Two frames later its buffer is reused
+        allocator.BeginFrame();
+        QE_CHECK(allocator.GetCurrentBufferIndex() == lastBuffer);
+        QE_CHECK(allocator.New<int>(0) == lastFrame);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 2);
+    }
+
+    QE_TEST(FrameAllocator, ArrayAlignment)
+    {
+        struct alignas(64) CacheLine
+        {
+            float Values[16];
+        };
+
+        FrameAllocator allocator(4096);
+        allocator.BeginFrame();
+        allocator.Allocate(1, 1);
+        CacheLine* lines = allocator.AllocateArray<CacheLine>(8);
+        QE_REQUIRE(lines != nullptr);
+        QE_CHECK(IsAligned(lines, alignof(CacheLine)));
+    }
+
+    // A frame's worth of short lived allocations of mixed sizes, the pattern FrameAllocator replaces
+    namespace
+    {
+        constexpr std::uint32_t FRAME_ALLOCATIONS = 1000;
+        constexpr std::size_t FRAME_SIZES[] = { 16, 48, 64, 200, 24, 512, 32, 96 };
+    }
+
+    QE_BENCHMARK(FrameAllocator, VersusNewAndMalloc)
+    {
+        constexpr std::uint32_t FRAMES = 2000;
+        std::vector<void*> pointers(FRAME_ALLOCATIONS);
+
+        FrameAllocator frameAllocator(1024 * 1024);
+        const double frameNs = Tests::MeasureNanoseconds(FRAMES, [&]() {
+            frameAllocator.BeginFrame();
+            for (std::uint32_t i = 0; i < FRAME_ALLOCATIONS; i++)
+                pointers[i] = frameAllocator.Allocate(FRAME_SIZES[i % std::size(FRAME_SIZES)], 16);
+            Tests::DoNotOptimize(pointers.data());
+        });
+
+        const double mallocNs = Tests::MeasureNanoseconds(FRAMES, [&]() {
+            for (std::uint32_t i = 0; i < FRAME_ALLOCATIONS; i++)
+                pointers[i] = std::malloc(FRAME_SIZES[i % std::size(FRAME_SIZES)]);
+            Tests::DoNotOptimize(pointers.data());
+            for (void* ptr : pointers)
+                std::free(ptr);
+        });
+
+        const double newNs = Tests::MeasureNanoseconds(FRAMES, [&]() {
+            for (std::uint32_t i = 0; i < FRAME_ALLOCATIONS; i++)
+                pointers[i] = new std::byte[FRAME_SIZES[i % std::size(FRAME_SIZES)]];
+            Tests::DoNotOptimize(pointers.data());
+            for (void* ptr : pointers)
+                delete[] static_cast<std::byte*>(ptr);
+        });
+
+        LOG_INFO_TAG("Benchmark", "{} allocations per frame, ns per allocation: FrameAllocator {:.1f}, malloc/free {:.1f}, new/delete {:.1f}",
+            FRAME_ALLOCATIONS, frameNs / FRAME_ALLOCATIONS, mallocNs / FRAME_ALLOCATIONS, newNs / FRAME_ALLOCATIONS);
+    }
+}
@@ -0,0 +1,59 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/LinearAllocator.h"
+#include "Core/Allocators/MemoryRegistry.h"
+
+namespace QE
+{
+    QE_TEST(MemoryRegistry, AllocationsPerFrame)
+    {
+        alignas(16) std::byte buffer[1024];
+        LinearAllocator allocator(sizeof(buffer), buffer);
+        allocator.Allocate(64, 16);
+
+        MemoryRegistry registry;
+        registry.RegisterAllocator(&allocator, "Test", MemoryTag::Core);
+
+        // Allocations made before registering are not counted
+        allocator.Allocate(64, 16);
+        allocator.Allocate(64, 16);
+        registry.Update();
+        QE_CHECK(registry.GetTagStats(MemoryTag::Core).AllocationsPerFrame == 2);
+
+        // Clearing keeps the running total, the next frame only counts its own allocations
+        allocator.Clear();
+        allocator.Allocate(64, 16);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 1);
+        QE_CHECK(allocator.GetTotalAllocations() == 4);
+        registry.Update();
+
+        const MemoryTagStats stats = registry.GetTagStats(MemoryTag::Core);
+        QE_CHECK(stats.AllocationsPerFrame == 1);
+        QE_CHECK(stats.UsedBytes == 64);
+        QE_CHECK(stats.PeakBytes == 192);
+
+        registry.UnregisterAllocator(&allocator);
+    }
+
+    QE_TEST(MemoryRegistry, Budget)
+    {
+        alignas(16) std::byte buffer[1024];
+        LinearAllocator allocator(sizeof(buffer), buffer);
+
+        MemoryRegistry registry;
+        registry.RegisterAllocator(&allocator, "Test", MemoryTag::Game);
+        registry.SetBudget(MemoryTag::Game, 256);
+
+        allocator.Allocate(128, 16);
+        registry.Update();
+        QE_CHECK(!registry.GetTagStats(MemoryTag::Game).OverBudget);
+
+        allocator.Allocate(256, 16);
+        registry.Update();
+        QE_CHECK(registry.GetTagStats(MemoryTag::Game).OverBudget);
+        // Other tags are not affected
+        QE_CHECK(!registry.GetTagStats(MemoryTag::Core).OverBudget);
+
+        registry.UnregisterAllocator(&allocator);
+    }
+}
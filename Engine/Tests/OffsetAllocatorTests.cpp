@@ -0,0 +1,140 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/OffsetAllocator.h"
+
+#include <vector>
+
+namespace QE
+{
+    QE_TEST(OffsetAllocator, AllocateAndFree)
+    {
+        OffsetAllocator allocator(1000);
+        const OffsetAllocator::Allocation first = allocator.Allocate(100);
+        const OffsetAllocator::Allocation second = allocator.Allocate(200);
+
+        QE_REQUIRE(first.IsValid() && second.IsValid());
+        QE_CHECK(first.Offset + first.Size <= second.Offset || second.Offset + second.Size <= first.Offset);
+        QE_CHECK(allocator.GetUsedSize() == 300);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 2);
+
+        // Too big and empty requests fail without changing anything
+        QE_CHECK(!allocator.Allocate(701).IsValid());
+        QE_CHECK(!allocator.Allocate(0).IsValid());
+        QE_CHECK(allocator.Allocate(700).IsValid());
+        QE_CHECK(allocator.GetFreeSize() == 0);
+
+        allocator.Reset();
+        QE_CHECK(allocator.GetFreeSize() == 1000);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+    }
+
+    QE_TEST(OffsetAllocator, BestFit)
+    {
+        OffsetAllocator allocator(1000);
+        std::vector<OffsetAllocator::Allocation> allocations;
+        for (int i = 0; i < 10; i++)
+            allocations.push_back(allocator.Allocate(100));
+
+        // Holes of 100 and 200, the smaller request goes into the hole that fits it best
+        allocator.Free(allocations[1]);
+        allocator.Free(allocations[4]);
+        allocator.Free(allocations[5]);
+
+        const OffsetAllocator::Allocation small = allocator.Allocate(100);
+        QE_CHECK(small.Offset == allocations[1].Offset);
+        const OffsetAllocator::Allocation large = allocator.Allocate(200);
+        QE_CHECK(large.Offset == allocations[4].Offset);
+    }
+
+    QE_TEST(OffsetAllocator, CoalesceNeighbours)
+    {
+        OffsetAllocator allocator(400);
+        const OffsetAllocator::Allocation a = allocator.Allocate(100);
+        const OffsetAllocator::Allocation b = allocator.Allocate(100);
+        const OffsetAllocator::Allocation c = allocator.Allocate(100);
+        const OffsetAllocator::Allocation d = allocator.Allocate(100);
+
+        allocator.Free(a);
+        allocator.Free(c);
+        QE_CHECK(allocator.GetFreeRangeCount() == 2);
+        QE_CHECK(allocator.GetLargestFreeRange() == 100);
+
+        // Merges with the free range before and after it
+        allocator.Free(b);
+        QE_CHECK(allocator.GetFreeRangeCount() == 1);
+        QE_CHECK(allocator.GetLargestFreeRange() == 300);
+
+        allocator.Free(d);
+        QE_CHECK(allocator.GetFreeRangeCount() == 1);
+        QE_CHECK(allocator.GetLargestFreeRange() == 400);
+
+        // Growing extends a free range that runs up to the old end
+        allocator.Grow(1000);
+        QE_CHECK(allocator.GetFreeRangeCount() == 1);
+        QE_CHECK(allocator.GetLargestFreeRange() == 1000);
+    }
+
+    QE_TEST(OffsetAllocator, CompactFragmentation)
+    {
+        OffsetAllocator allocator(1000);
+        std::vector<OffsetAllocator::Allocation> allocations;
+        for (int i = 0; i < 10; i++)
+            allocations.push_back(allocator.Allocate(100));
+
+        // Every other allocation freed, half the space is free but nothing over 100 fits
+        std::vector<OffsetAllocator::Allocation*> live;
+        for (int i = 0; i < 10; i++)
+        {
+            if (i % 2 == 0)
+                allocator.Free(allocations[i]);
+            else
+                live.push_back(&allocations[i]);
+        }
+        QE_CHECK(allocator.GetFreeSize() == 500);
+        QE_CHECK(allocator.GetFreeRangeCount() == 5);
+        QE_CHECK(!allocator.Allocate(200).IsValid());
+
+        const std::vector<OffsetAllocator::Move> moves = allocator.Compact(live);
+        QE_REQUIRE(moves.size() == 5);
+        for (std::size_t i = 0; i < moves.size(); i++)
+        {
+            QE_CHECK(moves[i].SourceOffset == 100 * (2 * i + 1));
+            QE_CHECK(moves[i].DestinationOffset == 100 * i);
+            QE_CHECK(live[i]->Offset == 100 * i);
+        }
+
+        QE_CHECK(allocator.GetFreeRangeCount() == 1);
+        QE_CHECK(allocator.GetLargestFreeRange() == 500);
+        QE_CHECK(allocator.GetUsedSize() == 500);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 5);
+
+        const OffsetAllocator::Allocation large = allocator.Allocate(500);
+        QE_CHECK(large.IsValid() && large.Offset == 500);
+
+        // The packed allocations free back into one range
+        for (OffsetAllocator::Allocation* allocation : live)
+            allocator.Free(*allocation);
+        allocator.Free(large);
+        QE_CHECK(allocator.GetFreeRangeCount() == 1);
+        QE_CHECK(allocator.GetFreeSize() == 1000);
+    }
+
+    QE_TEST(OffsetAllocator, CompactDropsUnlisted)
+    {
+        OffsetAllocator allocator(300);
+        OffsetAllocator::Allocation kept = allocator.Allocate(100);
+        const OffsetAllocator::Allocation dropped = allocator.Allocate(100);
+        OffsetAllocator::Allocation moved = allocator.Allocate(100);
+        (void)dropped;
+
+        // Allocations left out are released, like ranges still waiting on the GPU when the arena is compacted
+        OffsetAllocator::Allocation* live[] = { &moved, &kept };
+        const std::vector<OffsetAllocator::Move> moves = allocator.Compact(live);
+        QE_REQUIRE(moves.size() == 2);
+        QE_CHECK(moves[0].SourceOffset == 0 && moves[0].DestinationOffset == 0);
+        QE_CHECK(moves[1].SourceOffset == 200 && moves[1].DestinationOffset == 100);
+        QE_CHECK(moved.Offset == 100);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 2);
+        QE_CHECK(allocator.GetLargestFreeRange() == 100);
+    }
+}
@@ -0,0 +1,161 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/AllocatorUtility.h"
+#include "Core/Allocators/PoolAllocator.h"
+
+#include <list>
+#include <memory_resource>
+#include <vector>
+
+namespace QE
+{
+    namespace
+    {
+        bool IsAligned(const void* ptr, std::size_t alignment)
+        {
+            return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+        }
+
+        // Counts what reaches the upstream resource of a PoolMemoryResource
+        class CountingResource : public std::pmr::memory_resource
+        {
+        public:
+            std::size_t Allocations = 0;
+            std::size_t Deallocations = 0;
+        protected:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                Allocations++;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+            {
+                Deallocations++;
+                std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+        };
+    }
+
+    QE_TEST(PoolAllocator, FreeListReuse)
+    {
+        alignas(16) std::byte buffer[256];
+        PoolAllocator pool(sizeof(buffer), buffer, 32, 16);
+
+        void* first = pool.Allocate(32, 16);
+        void* second = pool.Allocate(32, 16);
+        QE_REQUIRE(first && second);
+        // Handed out in address order, one block apart
+        QE_CHECK(second == ptr_add(first, 32));
+        QE_CHECK(pool.GetNumberOfAllocations() == 2);
+        QE_CHECK(pool.GetUsedSize() == 64);
+
+        // The last freed block is the next one handed out
+        pool.Free(first);
+        pool.Free(second);
+        QE_CHECK(pool.Allocate(32, 16) == second);
+        QE_CHECK(pool.Allocate(32, 16) == first);
+        QE_CHECK(pool.GetNumberOfAllocations() == 2);
+        QE_CHECK(pool.GetTotalAllocations() == 4);
+    }
+
+    QE_TEST(PoolAllocator, OutOfBlocks)
+    {
+        alignas(16) std::byte buffer[128];
+        PoolAllocator pool(sizeof(buffer), buffer, 32, 16);
+        QE_CHECK(pool.GetTotalSize() == 128);
+
+        std::vector<void*> blocks;
+        for (std::size_t i = 0; i < 4; i++)
+            blocks.push_back(pool.Allocate(32, 16));
+        QE_CHECK(pool.GetFreeSize() == 0);
+
+        // Without growth a full pool fails and stays as it was
+        QE_CHECK(pool.Allocate(32, 16) == nullptr);
+        QE_CHECK(pool.GetNumberOfAllocations() == 4);
+        QE_CHECK(pool.GetPageCount() == 1);
+
+        pool.Free(blocks.back());
+        QE_CHECK(pool.Allocate(32, 16) == blocks.back());
+    }
+
+    QE_TEST(PoolAllocator, Growth)
+    {
+        alignas(16) std::byte buffer[128];
+        PoolAllocator pool(sizeof(buffer), buffer, 32, 16, true);
+
+        std::vector<void*> blocks;
+        for (std::size_t i = 0; i < 10; i++)
+        {
+            void* block = pool.Allocate(32, 16);
+            QE_REQUIRE(block != nullptr);
+            QE_CHECK(IsAligned(block, 16));
+            blocks.push_back(block);
+        }
+
+        // Four blocks per page, so two more pages were chained
+        QE_CHECK(pool.GetPageCount() == 3);
+        QE_CHECK(pool.GetTotalSize() == 3 * 128);
+        QE_CHECK(pool.GetNumberOfAllocations() == 10);
+
+        // Blocks of grown pages go back on the same free list
+        for (void* block : blocks)
+            pool.Free(block);
+        QE_CHECK(pool.GetUsedSize() == 0);
+        for (std::size_t i = 0; i < 12; i++)
+            QE_CHECK(pool.Allocate(32, 16) != nullptr);
+        QE_CHECK(pool.GetPageCount() == 3);
+    }
+
+    QE_TEST(PoolAllocator, BlockSizeAndAlignment)
+    {
+        alignas(64) std::byte buffer[1024];
+
+        // Blocks smaller than the free list pointer still hold it, and the stride keeps every block aligned
+        PoolAllocator small(sizeof(buffer), buffer, 1, 1);
+        QE_CHECK(small.GetBlockAlignment() == alignof(void*));
+        void* a = small.Allocate(1, 1);
+        void* b = small.Allocate(1, 1);
+        QE_CHECK(ptr_diff(a, b) == sizeof(void*));
+
+        // A misaligned buffer loses its head to the alignment instead of handing out a misaligned block
+        PoolAllocator aligned(sizeof(buffer) - 8, buffer + 8, 48, 64);
+        QE_CHECK(aligned.GetTotalSize() == 15 * 64);
+        for (std::size_t i = 0; i < 15; i++)
+            QE_CHECK(IsAligned(aligned.Allocate(48, 64), 64));
+    }
+
+    QE_TEST(PoolMemoryResource, RoutesBySize)
+    {
+        alignas(16) std::byte buffer[4096];
+        PoolAllocator pool(sizeof(buffer), buffer, 64, 16);
+        CountingResource upstream;
+        PoolMemoryResource resource(pool, &upstream);
+
+        // List nodes fit in a block, the vector's array does not
+        {
+            std::pmr::list<int> list(&resource);
+            for (int i = 0; i < 20; i++)
+                list.push_back(i);
+            QE_CHECK(pool.GetNumberOfAllocations() == 20);
+            QE_CHECK(upstream.Allocations == 0);
+
+            std::pmr::vector<std::byte> bytes(256, std::byte{}, &resource);
+            QE_CHECK(upstream.Allocations == 1);
+
+            // Over aligned requests go upstream even when they are small
+            void* overAligned = resource.allocate(16, 64);
+            QE_CHECK(upstream.Allocations == 2);
+            resource.deallocate(overAligned, 16, 64);
+        }
+
+        QE_CHECK(pool.GetNumberOfAllocations() == 0);
+        QE_CHECK(upstream.Deallocations == upstream.Allocations);
+        QE_CHECK(resource.is_equal(resource));
+    }
+}
@@ -0,0 +1,98 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/AllocatorUtility.h"
+#include "Core/Allocators/DoubleEndedStackAllocator.h"
+#include "Core/Allocators/StackAllocator.h"
+
+namespace QE
+{
+    namespace
+    {
+        bool IsAligned(const void* ptr, std::size_t alignment)
+        {
+            return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+        }
+    }
+
+    QE_TEST(AllocatorUtility, AlignForwardAdjustmentWithHeader)
+    {
+        alignas(64) std::byte buffer[256];
+
+        for (std::size_t alignment = 1; alignment <= 64; alignment *= 2)
+        {
+            for (std::size_t headerSize : { 1u, 4u, 8u, 24u })
+            {
+                for (std::size_t offset = 0; offset < 64; offset++)
+                {
+                    const std::size_t adjustment = align_forward_adjustment_with_header(buffer + offset, alignment, headerSize);
+                    QE_CHECK(adjustment >= headerSize);
+                    QE_CHECK(IsAligned(buffer + offset + adjustment, alignment));
+                    // No more than the header rounded up to the alignment on top of the plain adjustment
+                    QE_CHECK(adjustment < headerSize + alignment);
+                }
+            }
+        }
+    }
+
+    QE_TEST(AllocatorUtility, AlignBackward)
+    {
+        alignas(64) std::byte buffer[128];
+        QE_CHECK(align_backward(buffer + 63, 64) == buffer);
+        QE_CHECK(align_backward(buffer + 64, 64) == buffer + 64);
+        QE_CHECK(align_backward(buffer + 17, 8) == buffer + 16);
+    }
+
+    QE_TEST(StackAllocator, FreeInReverseOrder)
+    {
+        alignas(16) std::byte buffer[1024];
+        StackAllocator allocator(sizeof(buffer), buffer);
+
+        void* first = allocator.Allocate(64, 16);
+        void* second = allocator.Allocate(32, 16);
+        QE_REQUIRE(first && second);
+        QE_CHECK(reinterpret_cast<std::uintptr_t>(second) % 16 == 0);
+
+        allocator.Free(second);
+        allocator.Free(first);
+        QE_CHECK(allocator.GetUsedSize() == 0);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+        QE_CHECK(allocator.Allocate(64, 16) == first);
+    }
+
+    QE_TEST(DoubleEndedStackAllocator, BothEnds)
+    {
+        alignas(16) std::byte buffer[1024];
+        DoubleEndedStackAllocator allocator(sizeof(buffer), buffer);
+
+        void* bottom = allocator.AllocateBottom(100, 16);
+        const StackMarker topMarker = allocator.GetTopMarker();
+        void* top = allocator.AllocateTop(100, 16);
+        QE_REQUIRE(bottom && top);
+        QE_CHECK(bottom < top);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 2);
+
+        allocator.FreeTopToMarker(topMarker);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 1);
+        // The bottom is untouched by the top unwinding
+        allocator.FreeBottom(bottom);
+        QE_CHECK(allocator.GetUsedSize() == 0);
+    }
+
+    QE_TEST(DoubleEndedStackAllocator, TryAllocateWhenFull)
+    {
+        alignas(16) std::byte buffer[256];
+        DoubleEndedStackAllocator allocator(sizeof(buffer), buffer);
+
+        void* bottom = allocator.TryAllocateBottom(128, 16);
+        QE_REQUIRE(bottom != nullptr);
+        const std::size_t used = allocator.GetUsedSize();
+
+        // Neither end fits, nothing changes and the caller falls back
+        QE_CHECK(allocator.TryAllocateTop(200, 16) == nullptr);
+        QE_CHECK(allocator.TryAllocateBottom(200, 16) == nullptr);
+        QE_CHECK(allocator.GetUsedSize() == used);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 1);
+
+        QE_CHECK(allocator.TryAllocateTop(64, 16) != nullptr);
+    }
+}
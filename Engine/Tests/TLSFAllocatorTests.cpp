@@ -0,0 +1,324 @@
+#include "TestFramework.h"
+
+#include "Core/Allocators/TLSFAllocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace QE
+{
+    namespace
+    {
+        constexpr std::size_t TEST_HEAP_SIZE = 1024 * 1024;
+
+        struct TestHeap
+        {
+            TestHeap(std::size_t size = TEST_HEAP_SIZE)
+                : Size(size), Memory(std::make_unique<std::byte[]>(size)), Allocator(size, Memory.get())
+            {
+            }
+
+            bool Owns(const void* ptr) const
+            {
+                return ptr >= Memory.get() && ptr < Memory.get() + Size;
+            }
+
+            std::size_t Size;
+            std::unique_ptr<std::byte[]> Memory;
+            TLSFAllocator Allocator;
+        };
+    }
+
+    QE_TEST(TLSFAllocator, AllocateAndFree)
+    {
+        TestHeap heap;
+        TLSFAllocator& allocator = heap.Allocator;
+        const std::size_t freeSize = allocator.GetFreeSize();
+
+        std::vector<void*> pointers;
+        for (std::size_t alignment = 1; alignment <= 256; alignment *= 2)
+        {
+            for (std::size_t size : { 1u, 24u, 300u, 5000u })
+            {
+                void* ptr = allocator.Allocate(size, alignment);
+                QE_REQUIRE(ptr != nullptr);
+                QE_CHECK(reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0);
+                QE_CHECK(allocator.GetAllocationSize(ptr) >= size);
+                std::memset(ptr, 0xAB, size);
+                pointers.push_back(ptr);
+            }
+        }
+        QE_CHECK(allocator.GetNumberOfAllocations() == pointers.size());
+
+        for (void* ptr : pointers)
+            allocator.Free(ptr);
+        allocator.FlushThreadCaches();
+
+        // Everything merged back into the one block it started as
+        QE_CHECK(allocator.GetUsedSize() == 0);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+        QE_CHECK(allocator.GetLargestFreeBlock() == freeSize);
+        QE_CHECK(allocator.GetTotalAllocations() == pointers.size());
+    }
+
+    QE_TEST(TLSFAllocator, ThreadCacheReuse)
+    {
+        TestHeap heap;
+        TLSFAllocator& allocator = heap.Allocator;
+
+        void* small = allocator.Allocate(48);
+        allocator.Free(small);
+        // The block stays in this thread's cache and comes straight back
+        QE_CHECK(allocator.GetUsedSize() > 0);
+        QE_CHECK(allocator.Allocate(48) == small);
+        allocator.Free(small);
+
+        allocator.FlushThreadCaches();
+        QE_CHECK(allocator.GetUsedSize() == 0);
+        QE_CHECK(allocator.GetTotalAllocations() == 2);
+    }
+
+    QE_TEST(TLSFAllocator, ThreadExitFlushesCache)
+    {
+        TestHeap heap;
+        TLSFAllocator& allocator = heap.Allocator;
+
+        std::thread worker([&allocator]() {
+            std::vector<void*> pointers;
+            for (std::uint32_t i = 0; i < 256; i++)
+                pointers.push_back(allocator.Allocate(16 + i % 16 * 16));
+            for (void* ptr : pointers)
+                allocator.Free(ptr);
+        });
+        worker.join();
+
+        QE_CHECK(allocator.GetUsedSize() == 0);
+        QE_CHECK(allocator.GetNumberOfAllocations() == 0);
+        QE_CHECK(allocator.GetTotalAllocations() == 256);
+    }
+
+    QE_TEST(TLSFAllocator, CacheOutlivesAllocator)
+    {
+        // The first heap leaves blocks in this thread's cache, none of them may be handed out by the second
+        {
+            TestHeap first;
+            first.Allocator.Free(first.Allocator.Allocate(32));
+        }
+
+        TestHeap second;
+        void* ptr = second.Allocator.Allocate(32);
+        QE_CHECK(second.Owns(ptr));
+        QE_CHECK(second.Allocator.GetNumberOfAllocations() == 1);
+    }
+
+    QE_TEST(TLSFAllocator, Reallocate)
+    {
+        TestHeap heap;
+        TLSFAllocator& allocator = heap.Allocator;
+
+        auto* values = static_cast<std::uint32_t*>(allocator.Allocate(1024 * sizeof(std::uint32_t)));
+        QE_REQUIRE(values != nullptr);
+        for (std::uint32_t i = 0; i < 1024; i++)
+            values[i] = i;
+
+        // Nothing follows it, so it grows in place
+        auto* grown = static_cast<std::uint32_t*>(allocator.Reallocate(values, 4096 * sizeof(std::uint32_t)));
+        QE_CHECK(grown == values);
+
+        // A block in the way forces a move, the data comes along
+        void* blocker = allocator.Allocate(1024);
+        auto* moved = static_cast<std::uint32_t*>(allocator.Reallocate(grown, 64 * 1024 * sizeof(std::uint32_t)));
+        QE_REQUIRE(moved != nullptr);
+        QE_CHECK(moved != values);
+        bool intact = true;
+        for (std::uint32_t i = 0; i < 1024; i++)
+            intact &= moved[i] == i;
+        QE_CHECK(intact);
+
+        allocator.Free(blocker);
+        allocator.Free(moved);
+        allocator.FlushThreadCaches();
+        QE_CHECK(allocator.GetUsedSize() == 0);
+    }
+
+    QE_TEST(TLSFAllocator, OutOfMemory)
+    {
+        TestHeap heap(64 * 1024);
+        TLSFAllocator& allocator = heap.Allocator;
+
+        void* most = allocator.Allocate(48 * 1024);
+        QE_REQUIRE(most != nullptr);
+        QE_CHECK(allocator.Allocate(32 * 1024) == nullptr);
+        allocator.Free(most);
+        QE_CHECK(allocator.Allocate(32 * 1024) != nullptr);
+    }
+
+    QE_TEST(TLSFMemoryResource, FallsBackUpstream)
+    {
+        TestHeap heap(64 * 1024);
+        TLSFMemoryResource resource(heap.Allocator);
+
+        std::pmr::vector<std::uint32_t> values(&resource);
+        values.resize(1024);
+        QE_CHECK(heap.Owns(values.data()));
+
+        // Too big for the heap, the vector moves to the upstream resource and gives the heap its memory back
+        values.resize(64 * 1024);
+        QE_CHECK(!heap.Owns(values.data()));
+        heap.Allocator.FlushThreadCaches();
+        QE_CHECK(heap.Allocator.GetUsedSize() == 0);
+    }
+
+    namespace
+    {
+        // Small deterministic generator so both allocators see the same sequence
+        struct Random
+        {
+            std::uint32_t Next()
+            {
+                State = State * 1664525u + 1013904223u;
+                return State >> 8;
+            }
+
+            std::uint32_t State = 12345;
+        };
+
+        constexpr std::size_t BENCHMARK_HEAP_SIZE = 256 * 1024 * 1024;
+
+        struct MallocInterface
+        {
+            void* Allocate(std::size_t size) { return std::malloc(size); }
+            void Free(void* ptr) { std::free(ptr); }
+        };
+
+        struct TLSFInterface
+        {
+            void* Allocate(std::size_t size) { return Allocator.Allocate(size); }
+            void Free(void* ptr) { Allocator.Free(ptr); }
+
+            TLSFAllocator& Allocator;
+        };
+
+        // Allocates a batch of small objects and frees them again, what gameplay code does every frame
+        template<typename Interface>
+        double SmallObjects(Interface allocator)
+        {
+            constexpr std::uint32_t COUNT = 4096;
+            std::vector<void*> pointers(COUNT);
+            return Tests::MeasureNanoseconds(200, [&]() {
+                for (std::uint32_t i = 0; i < COUNT; i++)
+                    pointers[i] = allocator.Allocate(16 + i % 16 * 16);
+                Tests::DoNotOptimize(pointers.data());
+                for (void* ptr : pointers)
+                    allocator.Free(ptr);
+            }) / COUNT;
+        }
+
+        // A burst of large buffers, like a level load, freed in a different order than allocated
+        template<typename Interface>
+        double LargeBursts(Interface allocator)
+        {
+            constexpr std::uint32_t COUNT = 64;
+            std::vector<void*> pointers(COUNT);
+            return Tests::MeasureNanoseconds(200, [&]() {
+                for (std::uint32_t i = 0; i < COUNT; i++)
+                    pointers[i] = allocator.Allocate(64 * 1024 + i * 16 * 1024);
+                Tests::DoNotOptimize(pointers.data());
+                for (std::uint32_t i = 0; i < COUNT; i += 2)
+                    allocator.Free(pointers[i]);
+                for (std::uint32_t i = 1; i < COUNT; i += 2)
+                    allocator.Free(pointers[i]);
+            }) / COUNT;
+        }
+
+        // Long lived objects of random sizes replaced at random, the pattern that fragments a heap
+        template<typename Interface>
+        double MixedFrees(Interface allocator, std::vector<void*>& live)
+        {
+            constexpr std::uint32_t REPLACEMENTS = 200000;
+            Random random;
+            for (void*& ptr : live)
+                ptr = allocator.Allocate(16 + random.Next() % 4096);
+
+            const double ns = Tests::MeasureNanoseconds(1, [&]() {
+                for (std::uint32_t i = 0; i < REPLACEMENTS; i++)
+                {
+                    void*& ptr = live[random.Next() % live.size()];
+                    allocator.Free(ptr);
+                    ptr = allocator.Allocate(16 + random.Next() % 4096);
+                }
+            }) / REPLACEMENTS;
+            return ns;
+        }
+
+        // Several threads allocating and freeing their own small objects at once
+        template<typename Interface>
+        double Threaded(Interface allocator, std::uint32_t threadCount)
+        {
+            constexpr std::uint32_t COUNT = 1024;
+            constexpr std::uint32_t ROUNDS = 200;
+            return Tests::MeasureNanoseconds(1, [&]() {
+                std::vector<std::thread> threads;
+                for (std::uint32_t t = 0; t < threadCount; t++)
+                {
+                    threads.emplace_back([&allocator]() {
+                        std::vector<void*> pointers(COUNT);
+                        for (std::uint32_t round = 0; round < ROUNDS; round++)
+                        {
+                            for (std::uint32_t i = 0; i < COUNT; i++)
+                                pointers[i] = allocator.Allocate(16 + i % 16 * 16);
+                            Tests::DoNotOptimize(pointers.data());
+                            for (void* ptr : pointers)
+                                allocator.Free(ptr);
+                        }
+                    });
+                }
+                for (std::thread& thread : threads)
+                    thread.join();
+            }) / (COUNT * ROUNDS * threadCount);
+        }
+    }
+
+    QE_BENCHMARK(TLSFAllocator, VersusMalloc)
+    {
+        auto memory = std::make_unique<std::byte[]>(BENCHMARK_HEAP_SIZE);
+        TLSFAllocator tlsf(BENCHMARK_HEAP_SIZE, memory.get());
+
+        LOG_INFO_TAG("Benchmark", "ns per allocation and free, TLSF vs malloc");
+        LOG_INFO_TAG("Benchmark", "  small objects: {:.1f} vs {:.1f}", SmallObjects(TLSFInterface{ tlsf }), SmallObjects(MallocInterface{}));
+        LOG_INFO_TAG("Benchmark", "  large bursts: {:.1f} vs {:.1f}", LargeBursts(TLSFInterface{ tlsf }), LargeBursts(MallocInterface{}));
+
+        const std::uint32_t threadCount = std::max(4u, std::thread::hardware_concurrency());
+        LOG_INFO_TAG("Benchmark", "  {} threads: {:.1f} vs {:.1f}", threadCount,
+            Threaded(TLSFInterface{ tlsf }, threadCount), Threaded(MallocInterface{}, threadCount));
+
+        std::vector<void*> tlsfLive(16 * 1024);
+        std::vector<void*> mallocLive(16 * 1024);
+        LOG_INFO_TAG("Benchmark", "  mixed frees: {:.1f} vs {:.1f}",
+            MixedFrees(TLSFInterface{ tlsf }, tlsfLive), MixedFrees(MallocInterface{}, mallocLive));
+
+        // Fragmentation with the mixed set still alive: how much of the free memory a single allocation can use
+        tlsf.FlushThreadCaches();
+        const std::size_t largest = tlsf.GetLargestFreeBlock();
+        LOG_INFO_TAG("Benchmark", "TLSF fragmentation: {} KiB used, {} KiB free, largest free block is {:.1f}% of it",
+            tlsf.GetUsedSize() / 1024, tlsf.GetFreeSize() / 1024, 100.0 * largest / tlsf.GetFreeSize());
+#if defined(__GLIBC__)
+        const struct mallinfo2 info = mallinfo2();
+        LOG_INFO_TAG("Benchmark", "malloc fragmentation: {} KiB in use, {} KiB free inside the heap, top chunk {} KiB",
+            info.uordblks / 1024, info.fordblks / 1024, info.keepcost / 1024);
+#endif
+
+        for (void* ptr : tlsfLive)
+            tlsf.Free(ptr);
+        for (void* ptr : mallocLive)
+            std::free(ptr);
+    }
+}
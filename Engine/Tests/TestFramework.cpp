@@ -0,0 +1,96 @@
+#include "TestFramework.h"
+
+#include "Core/Log.h"
+
+#include <string>
+#include <vector>
+
+namespace QE::Tests
+{
+    namespace
+    {
+        struct TestCase
+        {
+            std::string_view Suite;
+            std::string_view Name;
+            TestKind Kind;
+            TestFunction Function;
+        };
+
+        // Function local so registrars in other files can run first
+        std::vector<TestCase>& GetTests()
+        {
+            static std::vector<TestCase> tests;
+            return tests;
+        }
+
+        std::uint32_t s_Failures = 0; // of the running test
+        volatile const void* s_Sink = nullptr;
+    }
+
+    TestRegistrar::TestRegistrar(std::string_view suite, std::string_view name, TestKind kind, TestFunction function)
+    {
+        GetTests().push_back({ suite, name, kind, function });
+    }
+
+    void ReportFailure(const char* expression, const char* file, int line)
+    {
+        LOG_ERROR_TAG("Tests", "Check failed: {} at {}:{}", expression, file, line);
+        s_Failures++;
+    }
+
+    void DoNotOptimize(const void* value)
+    {
+        s_Sink = value;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace QE;
+    using namespace QE::Tests;
+
+    Log::Init();
+
+    TestKind kind = TestKind::Test;
+    std::string_view filter;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "--run-benchmarks")
+            kind = TestKind::Benchmark;
+        else if (argument != "--run-tests")
+            filter = argument;
+    }
+
+    std::uint32_t run = 0;
+    std::uint32_t failed = 0;
+    for (const TestCase& test : GetTests())
+    {
+        const std::string fullName = std::string(test.Suite) + "." + std::string(test.Name);
+        if (test.Kind != kind || !fullName.starts_with(filter))
+            continue;
+
+        s_Failures = 0;
+        test.Function();
+        run++;
+
+        if (s_Failures > 0)
+        {
+            failed++;
+            LOG_ERROR_TAG("Tests", "FAILED {}", fullName);
+        }
+        else
+        {
+            LOG_INFO_TAG("Tests", "passed {}", fullName);
+        }
+    }
+
+    if (failed > 0)
+        LOG_ERROR_TAG("Tests", "{} of {} failed", failed, run);
+    else
+        LOG_INFO_TAG("Tests", "All {} passed", run);
+
+    Log::FlushAllLoggers();
+    return failed > 0 ? 1 : 0;
+}
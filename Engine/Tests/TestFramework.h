@@ -0,0 +1,68 @@
+#pragma once
+#include "Core/Core.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+// Tests and benchmarks build into QuestEngineTests, which links the engine library and can only reach what it
+// exports. QuestEngineTests --run-tests runs the tests, --run-benchmarks the benchmarks, both take an optional filter
+// that matches the start of "Suite.Name".
+
+namespace QE::Tests
+{
+    enum class TestKind
+    {
+        Test, Benchmark
+    };
+
+    using TestFunction = void(*)();
+
+    // Adds a test to the list main goes through, one is created for every QE_TEST and QE_BENCHMARK
+    struct TestRegistrar
+    {
+        TestRegistrar(std::string_view suite, std::string_view name, TestKind kind, TestFunction function);
+    };
+
+    // Marks the running test as failed, it keeps running unless the check was a QE_REQUIRE
+    void ReportFailure(const char* expression, const char* file, int line);
+
+    // Keeps the optimizer from dropping work whose result is otherwise unused
+    void DoNotOptimize(const void* value);
+
+    using BenchmarkClock = std::chrono::steady_clock;
+
+    // Average time of one of iterations calls in nanoseconds, after a warm up call that is not counted
+    template<typename Function>
+    double MeasureNanoseconds(std::uint32_t iterations, Function&& function)
+    {
+        function();
+        const BenchmarkClock::time_point start = BenchmarkClock::now();
+        for (std::uint32_t i = 0; i < iterations; i++)
+            function();
+        return std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count() / iterations;
+    }
+}
+
+#define QE_TEST_REGISTER(suite, name, kind) \
+    static void suite##_##name(); \
+    static const ::QE::Tests::TestRegistrar suite##_##name##_Registrar(#suite, #name, kind, &suite##_##name); \
+    static void suite##_##name()
+
+#define QE_TEST(suite, name) QE_TEST_REGISTER(suite, name, ::QE::Tests::TestKind::Test)
+#define QE_BENCHMARK(suite, name) QE_TEST_REGISTER(suite, name, ::QE::Tests::TestKind::Benchmark)
+
+#define QE_CHECK(expr) \
+    do { \
+        if (!(expr)) \
+            ::QE::Tests::ReportFailure(#expr, __FILE__, __LINE__); \
+    } while (0)
+
+// Stops the test on failure, for checks the rest of it depends on
+#define QE_REQUIRE(expr) \
+    do { \
+        if (!(expr)) { \
+            ::QE::Tests::ReportFailure(#expr, __FILE__, __LINE__); \
+            return; \
+        } \
+    } while (0)
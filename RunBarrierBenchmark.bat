@@ -0,0 +1,24 @@
+@echo off
+rem Renders the Sandbox draw list stress test headless twice, once with the batched barriers and once with every barrier
+rem recorded on its own with full pipeline masks as VkInit::TransitionImage did, and prints the average GPU frame time
+rem of each from the frame timestamps. Runs on the default GPU, set VK_DRIVER_FILES to a driver json to pick another.
+rem Usage: RunBarrierBenchmark.bat [runtime folder] [stress grid size]
+
+setlocal
+set RUNTIME_DIR=%~1
+if "%RUNTIME_DIR%"=="" set RUNTIME_DIR=%~dp0Output\Build\windows-msvc-release-user-mode\Runtime
+set GRID=%~2
+if "%GRID%"=="" set GRID=50
+set FRAMES=600
+
+pushd "%RUNTIME_DIR%"
+for %%B in ("" "--conservative-barriers") do (
+    QuestRuntime.exe --headless --frames %FRAMES% -- --stress-grid %GRID% %%~B >nul
+    if errorlevel 1 (
+        echo Run failed, see %RUNTIME_DIR%\logs
+        popd
+        exit /b 1
+    )
+    findstr /C:"GPU frame:" logs\Game.txt
+)
+popd
@@ -0,0 +1,37 @@
+@echo off
+rem Renders the Sandbox draw list stress test headless at several grid sizes and prints, for each, the frame time of
+rem the whole run and the average CPU time spent sorting, writing and recording the draw list, then records the largest
+rem grid on 1, 2, 4 and 8 threads to show how recording scales with the core count.
+rem Pass --stress-packets to submit one draw packet per copy instead of one instanced draw, which stresses the sort
+rem and the batching of equal state. Runs on the default GPU, set VK_DRIVER_FILES to a driver json to pick another.
+rem Usage: RunDrawListBenchmark.bat [runtime folder] [--stress-packets]
+
+setlocal
+set RUNTIME_DIR=%~1
+if "%RUNTIME_DIR%"=="" set RUNTIME_DIR=%~dp0Output\Build\windows-msvc-release-user-mode\Runtime
+set PACKETS=%~2
+set FRAMES=600
+
+pushd "%RUNTIME_DIR%"
+for %%G in (0 10 25 50 100) do (
+    QuestRuntime.exe --headless --frames %FRAMES% -- --stress-grid %%G %PACKETS% >nul
+    if errorlevel 1 (
+        echo Run with a %%G grid failed, see %RUNTIME_DIR%\logs
+        popd
+        exit /b 1
+    )
+    findstr /C:"Draw list:" logs\Game.txt
+    findstr /C:"Rendered" logs\Engine.txt
+)
+
+rem Scaling with core count, the largest grid recorded on 1 to 8 threads. Counts above the core count are clamped
+for %%T in (1 2 4 8) do (
+    QuestRuntime.exe --headless --frames %FRAMES% -- --stress-grid 100 %PACKETS% --record-threads %%T >nul
+    if errorlevel 1 (
+        echo Run on %%T record threads failed, see %RUNTIME_DIR%\logs
+        popd
+        exit /b 1
+    )
+    findstr /C:"Draw list:" logs\Game.txt
+)
+popd
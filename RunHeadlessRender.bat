@@ -0,0 +1,50 @@
+@echo off
+rem Renders the Sandbox headless on lavapipe, Mesa's software Vulkan driver, for build machines without a GPU or
+rem display. Prints the frame time of the run and captures the last frame. When a reference image is given the capture
+rem has to match it byte for byte, the fixed time step makes every run render the same frames.
+rem Needs a lavapipe build, e.g. https://github.com/pal1000/mesa-dist-win
+rem Usage: RunHeadlessRender.bat [runtime folder] [lavapipe icd json] [reference ppm]
+
+setlocal
+set RUNTIME_DIR=%~1
+if "%RUNTIME_DIR%"=="" set RUNTIME_DIR=%~dp0Output\Build\windows-msvc-release-user-mode\Runtime
+set LAVAPIPE_ICD=%~2
+if "%LAVAPIPE_ICD%"=="" set LAVAPIPE_ICD=C:\mesa\x64\lvp_icd.x86_64.json
+set REFERENCE=%~f3
+set FRAMES=300
+
+if not exist "%LAVAPIPE_ICD%" (
+    echo Lavapipe driver not found at %LAVAPIPE_ICD%
+    exit /b 1
+)
+
+rem Only load lavapipe, older loaders read VK_ICD_FILENAMES instead of VK_DRIVER_FILES
+set VK_DRIVER_FILES=%LAVAPIPE_ICD%
+set VK_ICD_FILENAMES=%LAVAPIPE_ICD%
+
+pushd "%RUNTIME_DIR%"
+if exist captures rmdir /s /q captures
+QuestRuntime.exe --headless --frames %FRAMES% --width 1280 --height 720 --capture captures >nul
+if errorlevel 1 (
+    echo Headless run failed, see %RUNTIME_DIR%\logs
+    popd
+    exit /b 1
+)
+findstr /C:"Rendered" logs\Engine.txt
+
+rem Frames are numbered from 0 and padded to five digits, the last one is FRAMES - 1
+set /a LAST_FRAME=%FRAMES% - 1
+set CAPTURE=captures\frame_00%LAST_FRAME%.ppm
+set RESULT=0
+if not "%REFERENCE%"=="" (
+    fc /b "%CAPTURE%" "%REFERENCE%" >nul
+    if errorlevel 1 (
+        echo %CAPTURE% does not match %REFERENCE%
+        set RESULT=1
+    ) else (
+        echo %CAPTURE% matches %REFERENCE%
+    )
+)
+popd
+
+exit /b %RESULT%
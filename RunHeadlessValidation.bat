@@ -0,0 +1,37 @@
+@echo off
+rem Renders headless frames on lavapipe, Mesa's software Vulkan driver, with the validation layer and synchronization
+rem validation enabled, and fails on any validation error. The Sandbox model and texture go through the upload queue
+rem and every frame culls, records and reads back, so this checks the queue ownership transfers and timeline waits on
+rem machines without a GPU.
+rem Validation is only enabled in Debug and RelWithDebInfo builds. Needs the Vulkan SDK for the layer and a lavapipe
+rem build, e.g. https://github.com/pal1000/mesa-dist-win
+rem Usage: RunHeadlessValidation.bat [runtime folder] [lavapipe icd json]
+
+setlocal
+set RUNTIME_DIR=%~1
+if "%RUNTIME_DIR%"=="" set RUNTIME_DIR=%~dp0Output\Build\windows-msvc-debug-developer-mode\Runtime
+set LAVAPIPE_ICD=%~2
+if "%LAVAPIPE_ICD%"=="" set LAVAPIPE_ICD=C:\mesa\x64\lvp_icd.x86_64.json
+
+if not exist "%LAVAPIPE_ICD%" (
+    echo Lavapipe driver not found at %LAVAPIPE_ICD%
+    exit /b 1
+)
+
+rem Only load lavapipe, older loaders read VK_ICD_FILENAMES instead of VK_DRIVER_FILES
+set VK_DRIVER_FILES=%LAVAPIPE_ICD%
+set VK_ICD_FILENAMES=%LAVAPIPE_ICD%
+set VK_LAYER_ENABLES=VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT
+
+pushd "%RUNTIME_DIR%"
+QuestRuntime.exe --headless --frames 60 --width 640 --height 360
+set RESULT=%ERRORLEVEL%
+
+findstr /C:"Validation Error" logs\Engine.txt >nul
+if %ERRORLEVEL%==0 (
+    echo Validation errors reported, see %RUNTIME_DIR%\logs\Engine.txt
+    set RESULT=1
+)
+popd
+
+exit /b %RESULT%
@@ -11,7 +11,7 @@ using DeleteGameAppFn = void (*)(QE::GameApplication*);
 int main(int argc, char** argv)
 {
     // Initialize the engine
-    InitializeEngineEntrypoint();
+    InitializeEngineEntrypoint(argc, argv);
 
     // Load the Sandbox program dynamically
     HMODULE gameLibDLL = LoadLibrary("Sandbox.dll");
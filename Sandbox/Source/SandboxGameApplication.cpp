@@ -1,11 +1,14 @@
 #include "SandboxGameApplication.h"
 #include "Core/Log.h"
+#include "Core/Profiler.h"
 
 #include "Engine/Engine.h"
 
-#include "Core/Containers/RawBuffer.h"
-
 #include "imgui.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdlib>
 
 #include "Assets/AssetLoader.h"
 
@@ -13,6 +16,11 @@
 #include "Core/Events/EventManager.h"
 #include "Core/Events/EngineEvents.h"
 
+SandboxGameApplication::SandboxGameApplication()
+    : m_StressTransforms(QE::GetEngine()->GetGameMemoryResource())
+{
+}
+
 void SandboxGameApplication::Init()
 {
     using namespace QE;
@@ -48,10 +56,34 @@ void SandboxGameApplication::Init()
     auto tex = QE::LoadTexture("Textures/viking_room.png");
     //auto tex = QE::LoadTexture("Textures/texture.jpg");
     m_Texture = tex.value();
+
+    // --stress-grid N [--stress-packets] [--record-threads N] [--conservative-barriers] starts the draw list stress test,
+    // for headless benchmark runs
+    const std::vector<std::string>& arguments = engine->GetConfig().GameArguments;
+    for (std::size_t i = 0; i < arguments.size(); i++)
+    {
+        if (arguments[i] == "--stress-grid" && i + 1 < arguments.size())
+            m_StressGridSize = std::clamp(std::atoi(arguments[++i].c_str()), 0, 100);
+        else if (arguments[i] == "--stress-packets")
+            m_StressSeparatePackets = true;
+        else if (arguments[i] == "--record-threads" && i + 1 < arguments.size())
+            device->SetRecordThreads(static_cast<std::uint32_t>(std::max(std::atoi(arguments[++i].c_str()), 1)));
+        else if (arguments[i] == "--conservative-barriers")
+            device->SetConservativeBarriers(true);
+    }
 }
 
 void SandboxGameApplication::Shutdown()
 {
+    const QE::DrawStats& stats = QE::GetEngine()->GetGraphicsDevice().GetDrawStats();
+    if (m_RecordedFrames > 0)
+        LOG_INFO("Draw list: {0}x{0} stress grid{1}, {2} instances in {3} indirect draws, {4:.3f} ms average record time on {5} threads over {6} frames",
+            m_StressGridSize, m_StressSeparatePackets ? " of separate packets" : "", stats.Instances, stats.Draws,
+            m_TotalRecordTimeMs / m_RecordedFrames, QE::GetEngine()->GetGraphicsDevice().GetRecordThreads(), m_RecordedFrames);
+    if (m_GpuFrames > 0)
+        LOG_INFO("GPU frame: {:.3f} ms average over {} frames with {} barriers", m_TotalGpuTimeMs / m_GpuFrames, m_GpuFrames,
+            QE::GetEngine()->GetGraphicsDevice().GetConservativeBarriers() ? "conservative" : "batched");
+
     LOG_INFO("Sandbox Game Application Shutdown");
 }
 
@@ -66,6 +98,32 @@ void SandboxGameApplication::Update()
     //GetEngine()->GetGraphicsDevicePtr()->DrawMesh(m_RectangleMesh, &m_Texture);
     GetEngine()->GetGraphicsDevice().DrawMesh(m_Model.Meshes[0], &m_Texture);
 
+    // Draw list stress test, a grid of copies of the model drawn as one instanced draw per mesh, or as one
+    // packet per copy to stress sorting and batching
+    GraphicsDevice& device = GetEngine()->GetGraphicsDevice();
+    m_StressTransforms.clear();
+    for (int x = 0; x < m_StressGridSize; x++)
+    {
+        for (int z = 0; z < m_StressGridSize; z++)
+            m_StressTransforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(x * 2.5f, 0.0f, -z * 2.5f)));
+    }
+
+    if (!m_StressTransforms.empty())
+    {
+        for (MeshHandle mesh : m_Model.Meshes)
+        {
+            if (m_StressSeparatePackets)
+            {
+                for (const glm::mat4& transform : m_StressTransforms)
+                    device.SubmitDraw({ mesh, m_Texture, transform });
+            }
+            else
+            {
+                device.DrawMeshInstanced(mesh, m_Texture, m_StressTransforms);
+            }
+        }
+    }
+
     // Render ImGui
     // ImGui fps window
     {
@@ -73,4 +131,70 @@ void SandboxGameApplication::Update()
         ImGui::Text("FPS: %.2f", ImGui::GetIO().Framerate);
         ImGui::End();
     }
+
+    // Draw list stats for the previous frame
+    {
+        const DrawStats& stats = device.GetDrawStats();
+        m_TotalRecordTimeMs += stats.RecordTimeMs;
+        m_RecordedFrames++;
+        ImGui::Begin("Draw List");
+        ImGui::SliderInt("Stress grid", &m_StressGridSize, 0, 100);
+        ImGui::Checkbox("One packet per copy", &m_StressSeparatePackets);
+        int recordThreads = static_cast<int>(device.GetRecordThreads());
+        if (ImGui::SliderInt("Record threads", &recordThreads, 1, static_cast<int>(device.GetMaxRecordThreads())))
+            device.SetRecordThreads(static_cast<std::uint32_t>(recordThreads));
+        float renderScale = device.GetRenderScale();
+        if (ImGui::SliderFloat("Render scale", &renderScale, GraphicsDevice::MIN_RENDER_SCALE, 1.0f))
+            device.SetRenderScale(renderScale);
+        ImGui::Text("Instances: %u", stats.Instances);
+        ImGui::Text("Indirect draws: %u", stats.Draws);
+        ImGui::Text("Pipeline binds: %u", stats.PipelineBinds);
+        ImGui::Text("Texture binds: %u", stats.TextureBinds);
+        ImGui::Text("Index buffer binds: %u", stats.IndexBufferBinds);
+        ImGui::Text("Secondary command buffers: %u on %u threads", stats.SecondaryCommandBuffers, stats.RecordWorkers);
+        ImGui::Text("Record time: %.3f ms", stats.RecordTimeMs);
+        ImGui::End();
+    }
+
+    // CPU and GPU overlap of the previous frame
+    {
+        const FramePacingStats& pacing = device.GetFramePacingStats();
+        const GpuFrameProfile& gpuFrame = device.GetGpuFrameProfile();
+        if (gpuFrame.Frame != UINT32_MAX && gpuFrame.Frame != m_LastGpuFrame)
+        {
+            m_TotalGpuTimeMs += gpuFrame.DurationMs;
+            m_GpuFrames++;
+            m_LastGpuFrame = gpuFrame.Frame;
+        }
+        ImGui::Begin("Frame Pacing");
+        int framesInFlight = static_cast<int>(device.GetFramesInFlight());
+        if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, 4))
+            device.SetFramesInFlight(static_cast<uint32_t>(framesInFlight));
+        ImGui::Text("Queued frames: %u", pacing.QueuedFrames);
+        ImGui::Text("CPU: %.2f ms", pacing.CpuTimeMs);
+        ImGui::Text("Waiting on GPU: %.2f ms", pacing.WaitTimeMs);
+        ImGui::Text("GPU: %.2f ms", gpuFrame.DurationMs);
+        ImGui::Text("Frame: %.2f ms", pacing.FrameTimeMs);
+        ImGui::End();
+    }
+
+    // Passes, barriers and transient memory of the previous frame
+    {
+        const RenderGraphStats& graph = device.GetRenderGraphStats();
+        ImGui::Begin("Render Graph");
+        bool conservativeBarriers = device.GetConservativeBarriers();
+        if (ImGui::Checkbox("Conservative barriers", &conservativeBarriers))
+            device.SetConservativeBarriers(conservativeBarriers);
+        ImGui::Text("Passes: %u (%u culled)", graph.Passes, graph.CulledPasses);
+        ImGui::Text("Image barriers: %u in %u batches (%u skipped)", graph.ImageBarriers, graph.BarrierBatches, graph.SkippedBarriers);
+        ImGui::Text("Transient images: %u", graph.TransientImages);
+        ImGui::Text("Transient memory: %.2f MB (%.2f MB aliased)", graph.TransientMemory / (1024.0 * 1024.0), graph.AliasedMemory / (1024.0 * 1024.0));
+        ImGui::End();
+    }
+
+    // Allocator usage and budgets per subsystem
+    GetEngine()->GetMemoryRegistry().DrawDebugInfo();
+
+    // CPU and GPU zones of the last frames
+    GetGlobalProfiler()->DrawDebugInfo();
 }
@@ -3,6 +3,7 @@
 #include "Engine/GameApplication.h"
 #include "RHI/ResourceTypes.h"
 
+#include <memory_resource>
 #include <vector>
 
 #include "Renderer/RenderTypes.h"
@@ -10,7 +11,7 @@
 class SANDBOX_API SandboxGameApplication : public QE::GameApplication
 {
 public:
-    SandboxGameApplication() = default;
+    SandboxGameApplication();
     virtual ~SandboxGameApplication() = default;
 
     virtual void Init() override;
@@ -26,4 +27,14 @@ private:
     int selectedMesh = 0;
     QE::Model m_Model;
     QE::TextureHandle m_Texture;
+    int m_StressGridSize = 0; // draws the model on a grid of this size squared to stress the draw list
+    bool m_StressSeparatePackets = false; // one draw packet per copy instead of one instanced draw
+    std::pmr::vector<glm::mat4> m_StressTransforms; // on the engine's game heap
+    // Draw list record time summed over the run, reported on shutdown for benchmark runs
+    double m_TotalRecordTimeMs = 0.0;
+    std::uint32_t m_RecordedFrames = 0;
+    // GPU frame time summed over the frames read back so far, same purpose
+    double m_TotalGpuTimeMs = 0.0;
+    std::uint32_t m_GpuFrames = 0;
+    std::uint32_t m_LastGpuFrame = UINT32_MAX;
 };